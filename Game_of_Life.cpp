@@ -7,13 +7,23 @@
  * @date March, 2020
  */
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 // Uses cxxopts from https://github.com/jarro2783/cxxopts under the MIT license
 #include "cxxopts/cxxopts.hxx"
 
+#include "checkpoint_writer.h"
 #include "grid.h"
+#include "live_viewer.h"
+#include "renderer.h"
+#include "rule.h"
+#include "stats.h"
 #include "world.h"
 #include "zoo.h"
 
@@ -24,11 +34,24 @@ int main(int argc, char *argv[]) {
 
     // Declare the valid command line arguments and their types and default values.
     options.add_options()
-            ("f,file", "Load an ascii file from the provided path.",  cxxopts::value<std::string>())
-            ("o,output", "Save an ascii file to the provided path.",  cxxopts::value<std::string>())
+            ("f,file", "Load a file from the provided path, ascii unless the path ends in .rle, .bgol or .gols.",  cxxopts::value<std::string>())
+            ("o,output", "Save a file to the provided path, ascii unless the path ends in .rle, .bgol or .gols.",  cxxopts::value<std::string>())
             ("s,steps","The number of steps to simulate the world.", cxxopts::value<int>()->default_value("10"))
             ("e,every","Print world to the console every N steps. 0 disables printing.", cxxopts::value<int>()->default_value("0"))
             ("t,toroidal", "Simulate the Game of Life on a torus.", cxxopts::value<bool>()->default_value("false"))
+            ("threads", "The number of threads used to step the world.", cxxopts::value<int>()->default_value("1"))
+            ("sparse", "Only recompute tiles of the world near a change from the previous step.", cxxopts::value<bool>()->default_value("false"))
+            ("b,backend", "Kernel used to step the world: scalar, packed, vector (SIMD) or gpu (OpenCL).", cxxopts::value<std::string>()->default_value("scalar"))
+            ("live", "Watch the world in the terminal while it steps flat out, redrawn --fps times a second. Keys pan, zoom, pause and quit.", cxxopts::value<bool>()->default_value("false"))
+            ("fps", "Frames per second drawn by --live.", cxxopts::value<int>()->default_value("30"))
+            ("scale", "Print one character per NxN block of cells, for worlds larger than the console.", cxxopts::value<int>()->default_value("1"))
+            ("viewport", "Only print the x,y,width,height window of the world.", cxxopts::value<std::vector<int>>())
+            ("checkpoint-every", "Save a checkpoint every N steps in the background. 0 disables checkpoints.", cxxopts::value<int>()->default_value("0"))
+            ("checkpoint-path", "Path checkpoints are saved to, {} is replaced by the generation.", cxxopts::value<std::string>()->default_value("checkpoint_{}.gol"))
+            ("r,rule", "Life-like rule to step with, in B/S notation. Defaults to the rule named by an .rle file, otherwise B3/S23.", cxxopts::value<std::string>()->default_value("B3/S23"))
+            ("cycles", "Skip to the end once the world repeats with a period of up to N steps. 0 disables.", cxxopts::value<int>()->default_value("0"))
+            ("stats", "Print a summary of the time spent in each phase, cells/s and allocations at the end.", cxxopts::value<bool>()->default_value("false"))
+            ("stats-every", "Print the stats for each N steps to stderr as a json line. 0 disables.", cxxopts::value<int>()->default_value("0"))
             ("h,help", "Print usage.");
 
     // Actually parse the command line arguments
@@ -44,14 +67,51 @@ int main(int argc, char *argv[]) {
     const int  steps    = result["steps"].as<int>();
     const int  every    = result["every"].as<int>();
     const bool toroidal = result["toroidal"].as<bool>();
+    const std::string backend = result["backend"].as<std::string>();
+    const int  threads  = result["threads"].as<int>();
+    const bool sparse   = result["sparse"].as<bool>();
+    const int  checkpointEvery = result["checkpoint-every"].as<int>();
+    const std::string checkpointPath = result["checkpoint-path"].as<std::string>();
+    const int  cycles   = result["cycles"].as<int>();
+    const bool stats    = result["stats"].as<bool>();
+    const int  statsEvery = result["stats-every"].as<int>();
+    const bool live     = result["live"].as<bool>();
+    const int  fps      = result["fps"].as<int>();
 
-    // Start with an empty grid
+    if (backend != "scalar" && backend != "packed" && backend != "vector" && backend != "gpu") {
+        std::cerr << "Unknown backend: " << backend << std::endl;
+        std::exit(-1);
+    }
+
+    if ((stats || statsEvery > 0) && !Stats::enabled()) {
+        std::cerr << "Stats were compiled out with GOL_NO_STATS, every reading will be zero." << std::endl;
+    }
+
+    // One renderer is reused for every frame so printing does not allocate per step
+    Renderer renderer;
+    try {
+        renderer.set_scale(result["scale"].as<int>());
+        if (result.count("viewport")) {
+            const std::vector<int> viewport = result["viewport"].as<std::vector<int>>();
+            if (viewport.size() != 4) {
+                throw std::invalid_argument("The viewport must be given as x,y,width,height.");
+            }
+            renderer.set_viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        }
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::exit(-1);
+    }
+
+    // Start with an empty grid, under the rule an .rle file names unless --rule is given
     Grid grid;
+    Rule rule = ConwayRule();
 
-    // Attempt to read in and parse the input file as an ascii .gol file if a path was given
+    // Attempt to read in and parse the input file as an ascii .gol or .rle file if a path was given
     if (result.count("file")) {
         try {
-            grid = Zoo::load_ascii(result["file"].as<std::string>());
+            grid = Zoo::load(result["file"].as<std::string>(), &rule);
         }
         catch (const std::exception &ex) {
             std::cerr << ex.what() << std::endl;
@@ -61,32 +121,159 @@ int main(int argc, char *argv[]) {
 
     // Construct a world from the parsed grid
     World world(grid);
+    world.set_threads(threads);
+    world.set_tile_tracking(sparse);
+    try {
+        if (backend == "packed") {
+            world.set_backend(PACKED);
+        } else if (backend == "vector") {
+            world.set_backend(VECTOR);
+        } else if (backend == "gpu") {
+            world.set_backend(GPU);
+        }
+        world.set_rule(result.count("rule") ? Rule::parse(result["rule"].as<std::string>()) : rule);
+        world.set_cycle_detection(cycles);
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::exit(-1);
+    }
+
+    // The live view takes over the console from here, until the run ends or q is pressed
+    std::unique_ptr<LiveViewer> viewer;
+    if (live) {
+        try {
+            viewer.reset(new LiveViewer(std::cout, fps));
+            viewer->set_scale(result["scale"].as<int>());
+            if (result.count("viewport")) {
+                const std::vector<int> viewport = result["viewport"].as<std::vector<int>>();
+                viewer->set_position(viewport[0], viewport[1]);
+            }
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+    }
 
     // Print the initial state of the grid
-    std::cout << "Initial state..." << std::endl
-              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
-              << world.get_state() << std::endl;
+    if (!viewer) {
+        std::cout << "Initial state..." << std::endl
+                  << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl;
+        renderer.print(std::cout, world.get_state());
+        std::cout << std::endl;
+    }
+
+    // Checkpoints are written on a background thread while the world keeps stepping
+    CheckpointWriter checkpoints;
 
-    // Perform the requested number of update steps
-    for (int step = 0; step < steps; step++) {
-        world.step(toroidal);
+    // Json lines report each interval since the previous line
+    Stats::Summary lastStats = Stats::get_summary();
 
-        // Print the state of the grid every N steps
-        if ((every > 0) && (step % every == 0)) {
-            std::cout << "Step " << (step + 1) << " of " << steps << std::endl
-                      << world.get_state() << std::endl;
+    // Perform the requested number of update steps, advancing straight to the next step that prints or checkpoints
+    int done = 0;
+    while (done < steps) {
+        int next = steps;
+        if (every > 0) {
+            next = std::min(next, ((done + every - 1) / every) * every + 1);
+        }
+        if (checkpointEvery > 0) {
+            next = std::min(next, (done / checkpointEvery + 1) * checkpointEvery);
+        }
+        if (statsEvery > 0) {
+            next = std::min(next, (done / statsEvery + 1) * statsEvery);
+        }
+        if (viewer && world.get_period() == 0) {
+            // Step one generation at a time so the view can sample between them, until a cycle lets advance skip ahead
+            next = std::min(next, done + 1);
+        }
+        world.advance(next - done, toroidal);
+        done = next;
+
+        if ((checkpointEvery > 0) && (done % checkpointEvery == 0)) {
+            std::string path = checkpointPath;
+            size_t marker = path.find("{}");
+            if (marker != std::string::npos) {
+                path.replace(marker, 2, std::to_string(world.get_generation()));
+            }
+            try {
+                checkpoints.submit(path, world.snapshot(), world.get_rule());
+            }
+            catch (const std::exception &ex) {
+                if (viewer) {
+                    viewer->stop();
+                }
+                std::cerr << ex.what() << std::endl;
+                std::exit(-1);
+            }
+        }
+
+        // Hand the live view a sample when it is due one, and hold still while it is paused
+        if (viewer) {
+            if (viewer->wants_frame()) {
+                viewer->offer(world.get_state(), world.get_generation());
+            }
+            while (viewer->is_paused() && !viewer->quit_requested()) {
+                if (viewer->wants_frame()) {
+                    viewer->offer(world.get_state(), world.get_generation());
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            if (viewer->quit_requested()) {
+                break;
+            }
+        }
+
+        // Print the state of the grid every N steps, unless the live view has the console
+        if (!viewer && (every > 0) && ((done - 1) % every == 0)) {
+            std::cout << "Step " << done << " of " << steps << '\n';
+            renderer.print(std::cout, world.get_state());
+            std::cout << std::endl;
+        }
+
+        if ((statsEvery > 0) && (done % statsEvery == 0)) {
+            Stats::Summary now = Stats::get_summary();
+            std::cerr << Stats::to_json(now - lastStats, world.get_generation()) << std::endl;
+            lastStats = now;
         }
     }
 
+    // Show the final state, and keep it up to be panned and zoomed until q is pressed
+    if (viewer) {
+        viewer->offer(world.get_state(), world.get_generation());
+        while (viewer->is_interactive() && !viewer->quit_requested()) {
+            if (viewer->wants_frame()) {
+                viewer->offer(world.get_state(), world.get_generation());
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        viewer->stop();
+    }
+
+    if (world.get_period() > 0) {
+        std::cout << "Settled into a cycle of period " << world.get_period()
+                  << " at generation " << world.get_period_start() << std::endl;
+    }
+
+    // Make sure every checkpoint reached the disk
+    try {
+        checkpoints.wait();
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::exit(-1);
+    }
+
     // Print the final state of the grid
     std::cout << "Final state..." << std::endl
-              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
-              << world.get_state() << std::endl;
+              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl;
+    renderer.print(std::cout, world.get_state());
+    std::cout << std::endl;
 
     // Attempt to save to the output directory if a path was given
     if (result.count("output")) {
         try {
-            Zoo::save_ascii(result["output"].as<std::string>(), world.get_state());
+            Zoo::save(result["output"].as<std::string>(), world.get_state(), world.get_rule());
         }
         catch (const std::exception &ex) {
             std::cerr << ex.what() << std::endl;
@@ -94,6 +281,12 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    // Print where the time went over the whole run
+    if (stats) {
+        std::cout << "Stats..." << std::endl;
+        Stats::print(std::cout, Stats::get_summary());
+    }
+
     // Destructors handle all the memory deallocation
     return 0;
 }
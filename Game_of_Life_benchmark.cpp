@@ -0,0 +1,624 @@
+/**
+ * Benchmarks for the hot paths of the Game of Life: stepping worlds on each backend (CPU and GPU), Zoo file I/O,
+ * Grid crop/merge/rotate, views, making worlds and rendering frames.
+ *
+ * Most benchmarks run on square boards from 64x64 up to 16384x16384, seeded with one of three standard
+ * patterns, and reports cells/second (items_per_second) and bytes/second so backends can be compared.
+ *
+ * Uses Google Benchmark from https://github.com/google/benchmark under the Apache 2.0 license.
+ * Run with --help to list the filtering and reporting options, e.g.
+ * ./Game_of_Life_benchmark --benchmark_filter=BM_Step
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "grid.h"
+#include "grid_allocator.h"
+#include "grid_view.h"
+#include "renderer.h"
+#include "world.h"
+#include "world_batch.h"
+#include "zoo.h"
+
+//counts every global operator new in the process, unlike Allocations which only sees grid buffers.
+//every form of new and delete is replaced, so each pair allocates and frees through the same functions.
+static std::atomic<unsigned long> heapAllocations(0);
+
+//helper function behind every replaced operator new, returning null on failure
+static void* counted_allocate(size_t bytes, size_t alignment) {
+    heapAllocations++;
+    void *memory = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        memory = std::malloc(bytes ? bytes : 1);
+    } else if (posix_memalign(&memory, alignment, bytes ? bytes : 1) != 0) {
+        memory = nullptr;
+    }
+    return memory;
+}
+
+//helper function behind the throwing forms of operator new
+static void* counted_allocate_or_throw(size_t bytes, size_t alignment) {
+    void *memory = counted_allocate(bytes, alignment);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(size_t bytes) {
+    return counted_allocate_or_throw(bytes, 0);
+}
+
+void* operator new[](size_t bytes) {
+    return counted_allocate_or_throw(bytes, 0);
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment) {
+    return counted_allocate_or_throw(bytes, (size_t)alignment);
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment) {
+    return counted_allocate_or_throw(bytes, (size_t)alignment);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t &) noexcept {
+    return counted_allocate(bytes, 0);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t &) noexcept {
+    return counted_allocate(bytes, 0);
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return counted_allocate(bytes, (size_t)alignment);
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return counted_allocate(bytes, (size_t)alignment);
+}
+
+//malloc and posix_memalign memory are both released by free
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+/**
+ * The standard seeds every benchmark is run on.
+ *      - GLIDER_FIELD: gliders tiled every 8 cells, mostly empty but everywhere active.
+ *      - R_PENTOMINO_SOUP: r-pentominos scattered at random, sparse and chaotic.
+ *      - RANDOM_FILL: every cell alive with probability 1/2, dense.
+ */
+enum Seed {
+    GLIDER_FIELD,
+    R_PENTOMINO_SOUP,
+    RANDOM_FILL
+};
+
+//helper function building a square seeded grid
+static Grid make_seed(int size, Seed seed) {
+    Grid grid(size);
+    std::mt19937 random(size);
+
+    if (seed == GLIDER_FIELD) {
+        Grid glider = Zoo::glider();
+        for (int y = 0; y + 3 <= size; y += 8) {
+            for (int x = 0; x + 3 <= size; x += 8) {
+                grid.merge(glider, x, y, true);
+            }
+        }
+    } else if (seed == R_PENTOMINO_SOUP) {
+        Grid pentomino = Zoo::r_pentomino();
+        for (int i = 0; i < (size * size) / 1024 + 1; i++) {
+            grid.merge(pentomino, random() % (size - 2), random() % (size - 2), true);
+        }
+    } else {
+        for (int y = 0; y < size; y++) {
+            Cell *row = grid.row(y);
+            for (int x = 0; x < size; x++) {
+                row[x] = (random() & 1) ? ALIVE : DEAD;
+            }
+        }
+    }
+
+    return grid;
+}
+
+//helper function reporting cell and byte throughput for a benchmark touching cells per iteration
+static void report(benchmark::State &state, long long cells, long long bytes) {
+    state.SetItemsProcessed(state.iterations() * cells);
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+//helper function applying the standard size x seed arguments
+static void seeds_and_sizes(benchmark::internal::Benchmark *benchmark) {
+    for (int seed : {GLIDER_FIELD, R_PENTOMINO_SOUP, RANDOM_FILL}) {
+        for (int size = 64; size <= 16384; size *= 4) {
+            benchmark->Args({size, seed});
+        }
+    }
+    benchmark->ArgNames({"size", "seed"})->Unit(benchmark::kMillisecond);
+}
+
+//helper function applying the standard size x seed x toroidal arguments
+static void stepping(benchmark::internal::Benchmark *benchmark) {
+    for (int toroidal : {0, 1}) {
+        for (int seed : {GLIDER_FIELD, R_PENTOMINO_SOUP, RANDOM_FILL}) {
+            for (int size = 64; size <= 16384; size *= 4) {
+                benchmark->Args({size, seed, toroidal});
+            }
+        }
+    }
+    benchmark->ArgNames({"size", "seed", "toroidal"})->Unit(benchmark::kMillisecond);
+}
+
+/**
+ * World::step on the scalar backend, which invokes World::count_neighbours for every cell.
+ */
+static void BM_Step_Scalar(benchmark::State &state) {
+    int size = state.range(0);
+    World world(make_seed(size, (Seed)state.range(1)));
+    bool toroidal = state.range(2) != 0;
+
+    for (auto _ : state) {
+        world.step(toroidal);
+    }
+    report(state, (long long)size * size, (long long)size * size * sizeof(Cell));
+}
+BENCHMARK(BM_Step_Scalar)->Apply(stepping);
+
+/**
+ * World::step on the SIMD byte-per-cell backend, using the best instruction set the CPU has.
+ */
+static void BM_Step_Vector(benchmark::State &state) {
+    int size = state.range(0);
+    World world(make_seed(size, (Seed)state.range(1)));
+    world.set_backend(VECTOR);
+    bool toroidal = state.range(2) != 0;
+
+    for (auto _ : state) {
+        world.step(toroidal);
+    }
+    state.SetLabel(instruction_set_name(detect_instruction_set()));
+    report(state, (long long)size * size, (long long)size * size * sizeof(Cell));
+}
+BENCHMARK(BM_Step_Vector)->Apply(stepping);
+
+/**
+ * World::step on the bit-packed backend.
+ */
+static void BM_Step_Packed(benchmark::State &state) {
+    int size = state.range(0);
+    World world(make_seed(size, (Seed)state.range(1)));
+    world.set_backend(PACKED);
+    bool toroidal = state.range(2) != 0;
+
+    for (auto _ : state) {
+        world.step(toroidal);
+    }
+    report(state, (long long)size * size, (long long)size * size / 8);
+}
+BENCHMARK(BM_Step_Packed)->Apply(stepping);
+
+/**
+ * World::step on the bit-packed backend with tile tracking, which only pays for active tiles.
+ */
+static void BM_Step_Packed_Tiled(benchmark::State &state) {
+    int size = state.range(0);
+    World world(make_seed(size, (Seed)state.range(1)));
+    world.set_backend(PACKED);
+    world.set_tile_tracking(true);
+    bool toroidal = state.range(2) != 0;
+
+    for (auto _ : state) {
+        world.step(toroidal);
+    }
+    report(state, (long long)size * size, (long long)size * size / 8);
+}
+BENCHMARK(BM_Step_Packed_Tiled)->Apply(stepping);
+
+/**
+ * World::step on every CPU backend, threaded and with tile tracking, counting every heap allocation made
+ * by the steps through the replaced global operator new. Fails if stepping allocates at all.
+ */
+static void BM_Step_Allocations(benchmark::State &state) {
+    int size = state.range(0);
+    World world(make_seed(size, (Seed)state.range(1)));
+    world.set_backend((Backend)state.range(2));
+    world.set_threads(4);
+    world.set_tile_tracking(true);
+    //the first steps may size the tile flags
+    world.step(false);
+    world.step(false);
+
+    unsigned long allocations = heapAllocations;
+    for (auto _ : state) {
+        world.step(false);
+    }
+    unsigned long made = heapAllocations - allocations;
+    state.counters["heap_allocations"] = (double)made;
+    if (made != 0) {
+        state.SkipWithError("stepping made heap allocations");
+    }
+    report(state, (long long)size * size, (long long)size * size);
+}
+BENCHMARK(BM_Step_Allocations)->ArgsProduct({{64, 1024}, {GLIDER_FIELD, R_PENTOMINO_SOUP, RANDOM_FILL}, {SCALAR, VECTOR, PACKED}})
+        ->ArgNames({"size", "seed", "backend"})->Unit(benchmark::kMillisecond);
+
+/**
+ * World::step on the bit-packed backend with tile tracking and the default journal recording every step,
+ * to compare with BM_Step_Packed_Tiled for the cost of keeping history.
+ */
+static void BM_Step_Packed_Journal(benchmark::State &state) {
+    int size = state.range(0);
+    World world(make_seed(size, (Seed)state.range(1)));
+    world.set_backend(PACKED);
+    world.set_tile_tracking(true);
+    world.set_journal(1024);
+    bool toroidal = state.range(2) != 0;
+
+    for (auto _ : state) {
+        world.step(toroidal);
+    }
+    state.counters["journal_bytes"] = (double)world.get_journal_bytes();
+    report(state, (long long)size * size, (long long)size * size / 8);
+}
+BENCHMARK(BM_Step_Packed_Journal)->Apply(stepping);
+
+/**
+ * World::step on the GPU backend, with the state kept on the device between steps.
+ * Skipped when the benchmarks were built without GOL_OPENCL or there is no GPU.
+ */
+static void BM_Step_Gpu(benchmark::State &state) {
+    if (!gpu_available()) {
+        state.SkipWithError("No GPU is available.");
+        return;
+    }
+    int size = state.range(0);
+    World world(make_seed(size, (Seed)state.range(1)));
+    world.set_backend(GPU);
+    bool toroidal = state.range(2) != 0;
+
+    for (auto _ : state) {
+        world.step(toroidal);
+    }
+    state.SetLabel(gpu_device_name());
+    report(state, (long long)size * size, (long long)size * size / 8);
+}
+BENCHMARK(BM_Step_Gpu)->Apply(stepping);
+
+/**
+ * WorldBatch::step of many small random soups at once, as run for parameter sweeps.
+ * Finished soups are frozen, so each iteration starts a fresh batch and advances it 100 generations.
+ */
+static void BM_Batch_Advance(benchmark::State &state) {
+    int size = state.range(0);
+    int count = state.range(1);
+    std::vector<Grid> seeds;
+    std::mt19937 random(size);
+    for (int i = 0; i < count; i++) {
+        Grid seed(size);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                seed(x, y) = (random() & 1) ? ALIVE : DEAD;
+            }
+        }
+        seeds.push_back(seed);
+    }
+
+    for (auto _ : state) {
+        WorldBatch batch(seeds);
+        batch.advance(100);
+        benchmark::DoNotOptimize(batch.get_running());
+    }
+    report(state, (long long)size * size * count * 100, (long long)size * size * count * 100 / 8);
+}
+BENCHMARK(BM_Batch_Advance)->ArgsProduct({{16, 32, 64}, {64, 1024, 8192}})
+    ->ArgNames({"size", "count"})->Unit(benchmark::kMillisecond);
+
+/**
+ * Zoo::save_ascii followed by Zoo::load_ascii of the same file.
+ */
+static void BM_Ascii_Round_Trip(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+    std::string path = "benchmark_" + std::to_string(size) + ".gol";
+
+    for (auto _ : state) {
+        try {
+            Zoo::save_ascii(path, grid);
+            benchmark::DoNotOptimize(Zoo::load_ascii(path));
+        }
+        catch (const std::exception &ex) {
+            state.SkipWithError(ex.what());
+            break;
+        }
+    }
+    std::remove(path.c_str());
+    report(state, (long long)size * size, (long long)size * (size + 1));
+}
+BENCHMARK(BM_Ascii_Round_Trip)->Apply(seeds_and_sizes);
+
+/**
+ * Zoo::save_binary of a byte-per-cell Grid.
+ */
+static void BM_Save_Binary(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+    std::string path = "benchmark_" + std::to_string(size) + ".bgol";
+
+    for (auto _ : state) {
+        try {
+            Zoo::save_binary(path, grid);
+        }
+        catch (const std::exception &ex) {
+            state.SkipWithError(ex.what());
+            break;
+        }
+    }
+    std::remove(path.c_str());
+    report(state, (long long)size * size, (long long)size * size / 8);
+}
+BENCHMARK(BM_Save_Binary)->Apply(seeds_and_sizes);
+
+/**
+ * Zoo::load_binary into a byte-per-cell Grid.
+ */
+static void BM_Load_Binary(benchmark::State &state) {
+    int size = state.range(0);
+    std::string path = "benchmark_" + std::to_string(size) + ".bgol";
+    Zoo::save_binary(path, BitGrid(make_seed(size, (Seed)state.range(1))));
+
+    for (auto _ : state) {
+        try {
+            benchmark::DoNotOptimize(Zoo::load_binary(path));
+        }
+        catch (const std::exception &ex) {
+            state.SkipWithError(ex.what());
+            break;
+        }
+    }
+    std::remove(path.c_str());
+    report(state, (long long)size * size, (long long)size * size / 8);
+}
+BENCHMARK(BM_Load_Binary)->Apply(seeds_and_sizes);
+
+/**
+ * Zoo::save_binary and Zoo::load_binary of a byte-per-cell Grid, encoding and decoding bands of rows on every core.
+ */
+static void BM_Binary_Round_Trip_Parallel(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+    std::string path = "benchmark_" + std::to_string(size) + ".bgol";
+    ExecutionPolicy policy = ExecutionPolicy::parallel();
+
+    for (auto _ : state) {
+        try {
+            Zoo::save_binary(path, grid, policy);
+            benchmark::DoNotOptimize(Zoo::load_binary(path, policy));
+        }
+        catch (const std::exception &ex) {
+            state.SkipWithError(ex.what());
+            break;
+        }
+    }
+    std::remove(path.c_str());
+    report(state, (long long)size * size, (long long)size * size / 4);
+}
+BENCHMARK(BM_Binary_Round_Trip_Parallel)->Apply(seeds_and_sizes);
+
+/**
+ * Zoo::load_binary_mapped into a BitGrid, zero-copy for every size benchmarked as they are multiples of 64.
+ */
+static void BM_Load_Binary_Mapped(benchmark::State &state) {
+    int size = state.range(0);
+    std::string path = "benchmark_" + std::to_string(size) + ".bgol";
+    Zoo::save_binary(path, BitGrid(make_seed(size, (Seed)state.range(1))));
+
+    for (auto _ : state) {
+        try {
+            BitGrid grid = Zoo::load_binary_mapped(path);
+            benchmark::DoNotOptimize(grid.get_alive_cells());
+        }
+        catch (const std::exception &ex) {
+            state.SkipWithError(ex.what());
+            break;
+        }
+    }
+    std::remove(path.c_str());
+    report(state, (long long)size * size, (long long)size * size / 8);
+}
+BENCHMARK(BM_Load_Binary_Mapped)->Apply(seeds_and_sizes);
+
+/**
+ * Zoo::save_snapshot followed by Zoo::load_snapshot of the same file, reporting bytes of the dense bitstream.
+ */
+static void BM_Snapshot_Round_Trip(benchmark::State &state) {
+    int size = state.range(0);
+    BitGrid grid(make_seed(size, (Seed)state.range(1)));
+    std::string path = "benchmark_" + std::to_string(size) + ".gols";
+
+    for (auto _ : state) {
+        try {
+            Zoo::save_snapshot(path, grid);
+            benchmark::DoNotOptimize(Zoo::load_snapshot(path));
+        }
+        catch (const std::exception &ex) {
+            state.SkipWithError(ex.what());
+            break;
+        }
+    }
+    std::remove(path.c_str());
+    report(state, (long long)size * size, (long long)size * size / 8);
+}
+BENCHMARK(BM_Snapshot_Round_Trip)->Apply(seeds_and_sizes);
+
+/**
+ * Grid::crop of the centre quarter of the board.
+ */
+static void BM_Crop(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grid.crop(size / 4, size / 4, 3 * size / 4, 3 * size / 4));
+    }
+    report(state, (long long)size * size / 4, (long long)size * size / 4);
+}
+BENCHMARK(BM_Crop)->Apply(seeds_and_sizes);
+
+/**
+ * Grid::get_alive_cells of the board, counted in bands on every core.
+ */
+static void BM_Alive_Cells_Parallel(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+    ExecutionPolicy policy = ExecutionPolicy::parallel();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grid.get_alive_cells(policy));
+    }
+    report(state, (long long)size * size, (long long)size * size);
+}
+BENCHMARK(BM_Alive_Cells_Parallel)->Apply(seeds_and_sizes);
+
+/**
+ * Making, resizing and dropping a world from a seed grid, as a service handling many boards does.
+ */
+static void BM_World_Churn(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+    unsigned long allocations = Allocations::get_count();
+    unsigned long reused = Allocations::get_reused();
+
+    for (auto _ : state) {
+        World world(grid);
+        world.resize(size + 8, size);
+        benchmark::DoNotOptimize(world.get_alive_cells());
+    }
+    //the fraction of buffers taken that the pool served without the system
+    state.counters["reused"] = (double)(Allocations::get_reused() - reused)
+            / std::max(1UL, Allocations::get_count() - allocations);
+    report(state, (long long)size * size, (long long)size * size);
+}
+BENCHMARK(BM_World_Churn)->Apply(seeds_and_sizes);
+
+/**
+ * Grid::merge of a half size grid into the board, overwriting and alive only.
+ */
+static void BM_Merge(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+    Grid other = make_seed(size / 2, RANDOM_FILL);
+
+    for (auto _ : state) {
+        grid.merge(other, size / 4, size / 4, false);
+        grid.merge(other, 0, 0, true);
+        benchmark::ClobberMemory();
+    }
+    report(state, (long long)size * size / 2, (long long)size * size / 2);
+}
+BENCHMARK(BM_Merge)->Apply(seeds_and_sizes);
+
+/**
+ * Grid::rotate by a quarter turn.
+ */
+static void BM_Rotate(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grid.rotate(1));
+    }
+    report(state, (long long)size * size, (long long)size * size);
+}
+BENCHMARK(BM_Rotate)->Apply(seeds_and_sizes);
+
+/**
+ * Grid::merge of a quarter turned view of a half size grid, which reads through the view without copying it.
+ */
+static void BM_Merge_Rotated_View(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+    Grid other = make_seed(size / 2, RANDOM_FILL);
+
+    for (auto _ : state) {
+        grid.merge(GridView(other).rotate(1), size / 4, size / 4, false);
+        benchmark::ClobberMemory();
+    }
+    report(state, (long long)size * size / 4, (long long)size * size / 4);
+}
+BENCHMARK(BM_Merge_Rotated_View)->Apply(seeds_and_sizes);
+
+/**
+ * Renderer::render of a full frame into the renderer's reused buffer.
+ */
+static void BM_Render(benchmark::State &state) {
+    int size = state.range(0);
+    Grid grid = make_seed(size, (Seed)state.range(1));
+    Renderer renderer;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(renderer.render(grid).data());
+    }
+    report(state, (long long)size * size, (long long)(size + 3) * (size + 2));
+}
+BENCHMARK(BM_Render)->Apply(seeds_and_sizes);
+
+BENCHMARK_MAIN();
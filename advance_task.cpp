@@ -0,0 +1,310 @@
+/**
+ * Implements a resumable, cancellable advance of a world, stepped in chunks either by the caller or on a thread of its own.
+ *      - The steps are taken by World::advance a chunk of generations at a time, so cycle detection, tile tracking and the
+ *        journal work as they do for one long advance. Once a cycle is found the rest is skipped in a single chunk.
+ *      - Between chunks the task can be cancelled, reports its progress, and hands out snapshots.
+ *      - AdvanceTask::run_chunk takes one chunk on the calling thread and returns, like resuming a coroutine, so an event
+ *        loop can interleave the steps with its other work and stay responsive. AdvanceTask::start runs every chunk
+ *        on a thread of the task's own instead, see also World::advance_async.
+ *      - The result is a std::shared_future of the generation reached. It is ready once the task has finished, been
+ *        cancelled, or failed, in which case it holds the exception thrown by the world.
+ *      - A snapshot is a shared read-only copy of the state, see World::snapshot. Asking for one while a chunk runs
+ *        returns a future that is filled between chunks, so reads never stop or race the stepping. Every request made
+ *        before it is filled shares the one copy, however many readers there are.
+ *
+ * @example
+ *
+ *      // Step a world on its own thread, serve its state, and stop early if asked
+ *      World world(Zoo::load("soup.rle"));
+ *      std::unique_ptr<AdvanceTask> task = world.advance_async(1000000, true);
+ *      std::shared_ptr<const Grid> state = task->request_snapshot().get();
+ *      task->cancel();
+ *      long long reached = task->wait();
+ *
+ *      // Or step it from an event loop, one chunk per turn
+ *      AdvanceTask task(world, 1000000);
+ *      while (task.run_chunk()) {
+ *          serve_pending_requests();
+ *      }
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "advance_task.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "world.h"
+
+/**
+ * AdvanceTask::AdvanceTask(world, steps, toroidal, chunk, progress)
+ *
+ * Construct a task to advance a world, which takes no steps until AdvanceTask::run_chunk or AdvanceTask::start is called.
+ *
+ * @param world
+ *      The world to advance, which must outlive the task.
+ *
+ * @param steps
+ *      The number of steps to advance the world.
+ *
+ * @param toroidal
+ *      Optional parameter. If true the world is stepped as a torus. Defaults to false.
+ *
+ * @param chunk
+ *      Optional parameter. The number of generations stepped between chances to cancel, report and snapshot. Defaults to 64.
+ *
+ * @param progress
+ *      Optional parameter. Called after every chunk, on the thread that stepped it. It may cancel the task or ask for
+ *      a snapshot, but must not destroy the task.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if steps is negative or chunk is less than 1.
+ */
+AdvanceTask::AdvanceTask(World &world, int steps, bool toroidal, int chunk, std::function<void(const AdvanceProgress&)> progress)
+		: world(world), steps(steps), toroidal(toroidal), chunk(chunk), progress(std::move(progress)), cancelled(false) {
+	if (steps < 0 || chunk < 1) {
+		throw std::invalid_argument("Invalid number of steps or chunk size.\n");
+	}
+	this->reached = {world.get_generation(), 0, steps, world.get_population()};
+	this->future = this->result.get_future().share();
+}
+
+/**
+ * AdvanceTask::~AdvanceTask()
+ *
+ * Cancel the task, and wait for the chunk being stepped, if there is one, to finish.
+ */
+AdvanceTask::~AdvanceTask() {
+	this->cancel();
+	if (this->worker.joinable()) {
+		this->worker.join();
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (!this->finished) {
+		this->finish(nullptr);
+	}
+}
+
+/**
+ * AdvanceTask::run_chunk()
+ *
+ * Step the next chunk of generations on the calling thread.
+ *
+ * @example
+ *
+ *      // Step to completion, doing other work between chunks
+ *      AdvanceTask task(world, 10000);
+ *      while (task.run_chunk()) {
+ *          poll_network();
+ *      }
+ *
+ * @return
+ *      True if there are chunks left to step, false once the task is done.
+ *
+ * @throws
+ *      Throws std::logic_error or sub-class if a chunk is already being stepped, e.g. by the thread from AdvanceTask::start.
+ *      Errors from the world are not thrown here, they are held by the future.
+ */
+bool AdvanceTask::run_chunk() {
+	int count;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->finished) {
+			return false;
+		}
+		if (this->running) {
+			throw std::logic_error("A chunk of the advance is already being stepped.\n");
+		}
+		if (this->cancelled || this->reached.done >= this->steps) {
+			this->finish(nullptr);
+			return false;
+		}
+		count = (int)std::min<long long>(this->chunk, this->steps - this->reached.done);
+		if (this->world.get_period() > 0) {
+			//a cycle skips the rest in O(1), so there is nothing to gain from chunking it
+			count = this->steps - (int)this->reached.done;
+		}
+		this->running = true;
+	}
+
+	std::exception_ptr error;
+	try {
+		this->world.advance(count, this->toroidal);
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+
+	AdvanceProgress now;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->running = false;
+		if (error) {
+			this->finish(error);
+			return false;
+		}
+		this->reached = {this->world.get_generation(), this->reached.done + count, this->steps, this->world.get_population()};
+		now = this->reached;
+		if (this->snapshotPending) {
+			this->take_snapshot();
+		}
+	}
+
+	if (this->progress) {
+		this->progress(now);
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (this->cancelled || this->reached.done >= this->steps) {
+		this->finish(nullptr);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * AdvanceTask::start()
+ *
+ * Step every chunk on a thread of the task's own and return straight away.
+ *
+ * @throws
+ *      Throws std::logic_error or sub-class if the task was already started.
+ */
+void AdvanceTask::start() {
+	if (this->worker.joinable()) {
+		throw std::logic_error("The advance was already started.\n");
+	}
+	this->worker = std::thread([this] {
+		while (this->run_chunk()) {
+		}
+	});
+}
+
+/**
+ * AdvanceTask::cancel()
+ *
+ * Stop stepping after the current chunk. The future then holds the generation reached.
+ */
+void AdvanceTask::cancel() {
+	this->cancelled = true;
+}
+
+/**
+ * AdvanceTask::is_cancelled()
+ *
+ * @return
+ *      True if AdvanceTask::cancel was called.
+ */
+bool AdvanceTask::is_cancelled() const {
+	return this->cancelled;
+}
+
+/**
+ * AdvanceTask::is_done()
+ *
+ * @return
+ *      True once the task has stopped stepping, for good, and the world may be used directly again.
+ */
+bool AdvanceTask::is_done() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->finished;
+}
+
+/**
+ * AdvanceTask::get_progress()
+ *
+ * @return
+ *      How far the task had got at the end of its last chunk.
+ */
+AdvanceProgress AdvanceTask::get_progress() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->reached;
+}
+
+/**
+ * AdvanceTask::get_future()
+ *
+ * @return
+ *      A future of the generation the world reached, ready once the task is done.
+ */
+std::shared_future<long long> AdvanceTask::get_future() const {
+	return this->future;
+}
+
+/**
+ * AdvanceTask::wait()
+ *
+ * Block until the task is done. Only useful once it has been started, or while another thread runs its chunks.
+ *
+ * @return
+ *      The generation the world reached.
+ *
+ * @throws
+ *      The exception thrown by the world, if stepping failed.
+ */
+long long AdvanceTask::wait() const {
+	return this->future.get();
+}
+
+/**
+ * AdvanceTask::request_snapshot()
+ *
+ * Ask for a read-only copy of the state. Between chunks, or once done, it is taken straight away,
+ * otherwise when the running chunk finishes.
+ *
+ * @example
+ *
+ *      // Serve the state of a running world
+ *      std::shared_ptr<const Grid> state = task->request_snapshot().get();
+ *      std::cout << state->get_alive_cells() << std::endl;
+ *
+ * @return
+ *      A future of the snapshot.
+ */
+std::shared_future<std::shared_ptr<const Grid>> AdvanceTask::request_snapshot() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (!this->snapshotPending) {
+		this->snapshotPromise = std::promise<std::shared_ptr<const Grid>>();
+		this->snapshotFuture = this->snapshotPromise.get_future().share();
+		this->snapshotPending = true;
+	}
+	std::shared_future<std::shared_ptr<const Grid>> snapshot = this->snapshotFuture;
+	if (!this->running) {
+		this->take_snapshot();
+	}
+	return snapshot;
+}
+
+/**
+ * AdvanceTask::finish(error)
+ *
+ * Private helper which marks the task done and fills its future, with the generation reached or the error.
+ * Must be called with the mutex held.
+ */
+void AdvanceTask::finish(std::exception_ptr error) {
+	this->finished = true;
+	if (error) {
+		this->result.set_exception(error);
+	} else {
+		this->result.set_value(this->world.get_generation());
+	}
+	if (this->snapshotPending) {
+		this->take_snapshot();
+	}
+}
+
+/**
+ * AdvanceTask::take_snapshot()
+ *
+ * Private helper which fills the pending snapshot. Must be called with the mutex held and no chunk running.
+ */
+void AdvanceTask::take_snapshot() {
+	try {
+		this->snapshotPromise.set_value(this->world.snapshot());
+	}
+	catch (...) {
+		this->snapshotPromise.set_exception(std::current_exception());
+	}
+	this->snapshotPending = false;
+}
@@ -0,0 +1,84 @@
+/**
+ * Declares a resumable, cancellable advance of a world, stepped in chunks either by the caller or on a thread of its own.
+ * Rich documentation for the api and behaviour the AdvanceTask class can be found in advance_task.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "grid.h"
+
+class World;
+
+/**
+ * How far an AdvanceTask has got, as reported after each chunk.
+ */
+struct AdvanceProgress {
+	long long generation;
+	//steps taken of the steps asked for
+	long long done;
+	long long steps;
+	long long population;
+};
+
+/**
+ * Declare the structure of the AdvanceTask class.
+ *
+ * A task owns the stepping of its world until it is done: the world must not be used, other than through
+ * the task, until AdvanceTask::is_done is true. The state can be read meanwhile with AdvanceTask::request_snapshot.
+ */
+class AdvanceTask {
+public:
+	AdvanceTask(World &world, int steps, bool toroidal = false, int chunk = 64,
+			std::function<void(const AdvanceProgress&)> progress = nullptr);
+	~AdvanceTask();
+
+	AdvanceTask(const AdvanceTask &) = delete;
+	AdvanceTask& operator=(const AdvanceTask &) = delete;
+
+	bool run_chunk();
+	void start();
+
+	void cancel();
+	bool is_cancelled() const;
+	bool is_done() const;
+
+	AdvanceProgress get_progress() const;
+	std::shared_future<long long> get_future() const;
+	long long wait() const;
+
+	std::shared_future<std::shared_ptr<const Grid>> request_snapshot();
+
+private:
+	World &world;
+	int steps;
+	bool toroidal;
+	int chunk;
+	std::function<void(const AdvanceProgress&)> progress;
+
+	//guards everything below, and the world whenever no chunk is running
+	mutable std::mutex mutex;
+	AdvanceProgress reached;
+	bool running = false;
+	bool finished = false;
+	std::promise<long long> result;
+	std::shared_future<long long> future;
+	//a snapshot asked for and not yet taken, shared by every caller asking before it is
+	bool snapshotPending = false;
+	std::promise<std::shared_ptr<const Grid>> snapshotPromise;
+	std::shared_future<std::shared_ptr<const Grid>> snapshotFuture;
+
+	std::atomic<bool> cancelled;
+	std::thread worker;
+
+	void finish(std::exception_ptr error);
+	void take_snapshot();
+};
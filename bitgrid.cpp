@@ -0,0 +1,699 @@
+/**
+ * Implements a class representing a bit-packed 2d grid of cells.
+ *      - A BitGrid offers the same api as Grid, but each cell costs one bit instead of one byte.
+ *      - Each row is stored as a run of 64 bit words, bit (x % 64) of word (x / 64) is the cell at x.
+ *      - Bits past the width of the grid in the last word of a row are always 0, so whole words can be
+ *        counted, copied and written without masking.
+ *      - BitGrids can be converted to and from Grids.
+ *      - BitGrids can wrap storage they do not own, such as a memory-mapped .bgol file, without copying it.
+ *        Copying such a grid makes an ordinary, owning copy.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+
+#include "bitgrid.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+//bits in one storage word
+static const int WORD_BITS = 64;
+
+//helper function returning a mask of the lowest n bits (n in [0, 64])
+static uint64_t low_mask(int n) {
+	return (n >= WORD_BITS) ? ~(uint64_t)0 : ((((uint64_t)1) << n) - 1);
+}
+
+//helper function reading n (<= 64) bits of a packed row starting at bit x
+static uint64_t read_bits(const uint64_t *row, int x, int n) {
+	int word = x / WORD_BITS;
+	int shift = x % WORD_BITS;
+	uint64_t value = row[word] >> shift;
+	if (shift != 0 && shift + n > WORD_BITS) {
+		value |= row[word + 1] << (WORD_BITS - shift);
+	}
+	return value & low_mask(n);
+}
+
+//helper function overwriting n (<= 64) bits of a packed row starting at bit x
+static void write_bits(uint64_t *row, int x, int n, uint64_t value) {
+	int word = x / WORD_BITS;
+	int shift = x % WORD_BITS;
+	uint64_t mask = low_mask(n);
+	value &= mask;
+	row[word] = (row[word] & ~(mask << shift)) | (value << shift);
+	if (shift != 0 && shift + n > WORD_BITS) {
+		int spill = WORD_BITS - shift;
+		row[word + 1] = (row[word + 1] & ~(mask >> spill)) | (value >> spill);
+	}
+}
+
+/**
+ * BitGrid::Reference::Reference(word, mask)
+ *
+ * Construct a reference to the cell held in the bit selected by mask within word.
+ */
+BitGrid::Reference::Reference(uint64_t &word, uint64_t mask) : word(word), mask(mask) {}
+
+/**
+ * BitGrid::Reference::operator Cell()
+ *
+ * Read the referenced cell.
+ */
+BitGrid::Reference::operator Cell() const {
+	return (this->word & this->mask) ? ALIVE : DEAD;
+}
+
+/**
+ * BitGrid::Reference::operator=(value)
+ *
+ * Overwrite the referenced cell.
+ */
+BitGrid::Reference& BitGrid::Reference::operator=(Cell value) {
+	if (value == ALIVE) {
+		this->word |= this->mask;
+	} else {
+		this->word &= ~this->mask;
+	}
+	return *this;
+}
+
+/**
+ * BitGrid::Reference::operator=(other)
+ *
+ * Copy the value of another referenced cell into the referenced cell.
+ */
+BitGrid::Reference& BitGrid::Reference::operator=(const Reference &other) {
+	return (*this = (Cell)other);
+}
+
+
+/**
+ * BitGrid::BitGrid()
+ *
+ * Construct an empty bit-packed grid of size 0x0.
+ */
+BitGrid::BitGrid() : BitGrid(0) {}
+
+
+/**
+ * BitGrid::BitGrid(square_size)
+ *
+ * Construct a bit-packed grid with the desired size filled with dead cells.
+ *
+ * @param square_size
+ *      The edge size to use for the width and height of the grid.
+ */
+BitGrid::BitGrid(int square_size) : BitGrid(square_size, square_size) {}
+
+
+/**
+ * BitGrid::BitGrid(width, height)
+ *
+ * Construct a bit-packed grid with the desired size filled with dead cells.
+ *
+ * @example
+ *
+ *      // Make a 100000x100000 grid in ~1.25GB instead of ~10GB
+ *      BitGrid grid(100000, 100000);
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ */
+BitGrid::BitGrid(int width, int height) {
+	this->width = width;
+	this->height = height;
+	//round each row up to a whole number of words
+	this->wordsPerRow = (width + WORD_BITS - 1) / WORD_BITS;
+	this->words = std::vector<uint64_t, GridAllocator<uint64_t>>(this->wordsPerRow * height, 0);
+	this->data = this->words.data();
+}
+
+
+/**
+ * BitGrid::BitGrid(width, height, words, owner)
+ *
+ * Construct a bit-packed grid over existing storage without copying it.
+ * The storage must hold get_words_per_row() words for each row, with the padding bits 0,
+ * and stays alive for as long as owner (or any copy of it) does.
+ *
+ * @example
+ *
+ *      // Wrap a file mapped into memory, unmapping it once the grid is gone
+ *      std::shared_ptr<void> owner(base, [size](void *p) { munmap(p, size); });
+ *      BitGrid grid(width, height, (uint64_t*)((char*)base + 8), owner);
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @param words
+ *      The first word of the first row.
+ *
+ * @param owner
+ *      A handle keeping the storage alive.
+ */
+BitGrid::BitGrid(int width, int height, uint64_t *words, std::shared_ptr<void> owner) {
+	this->width = width;
+	this->height = height;
+	this->wordsPerRow = (width + WORD_BITS - 1) / WORD_BITS;
+	this->data = words;
+	this->owner = std::move(owner);
+}
+
+
+/**
+ * BitGrid::BitGrid(other)
+ *
+ * Copy a bit-packed grid. The copy always owns its words, even if other wraps external storage.
+ */
+BitGrid::BitGrid(const BitGrid &other) : width(other.width), height(other.height), wordsPerRow(other.wordsPerRow),
+		words(other.data, other.data + (size_t)other.wordsPerRow * other.height) {
+	this->data = this->words.data();
+}
+
+
+/**
+ * BitGrid::BitGrid(other)
+ *
+ * Move a bit-packed grid, taking over its words or its external storage without copying.
+ */
+BitGrid::BitGrid(BitGrid &&other) : width(other.width), height(other.height), wordsPerRow(other.wordsPerRow),
+		words(std::move(other.words)), data(other.data), owner(std::move(other.owner)) {
+	if (!this->owner) {
+		this->data = this->words.data();
+	}
+	other.width = other.height = other.wordsPerRow = 0;
+	other.words.clear();
+	other.data = other.words.data();
+}
+
+
+/**
+ * BitGrid::operator=(other)
+ *
+ * Copy assign a bit-packed grid. The result always owns its words.
+ */
+BitGrid& BitGrid::operator=(const BitGrid &other) {
+	if (this != &other) {
+		*this = BitGrid(other);
+	}
+	return *this;
+}
+
+
+/**
+ * BitGrid::operator=(other)
+ *
+ * Move assign a bit-packed grid, taking over its words or its external storage without copying.
+ */
+BitGrid& BitGrid::operator=(BitGrid &&other) {
+	if (this != &other) {
+		this->width = other.width;
+		this->height = other.height;
+		this->wordsPerRow = other.wordsPerRow;
+		this->words = std::move(other.words);
+		this->owner = std::move(other.owner);
+		this->data = this->owner ? other.data : this->words.data();
+
+		other.width = other.height = other.wordsPerRow = 0;
+		other.words.clear();
+		other.data = other.words.data();
+	}
+	return *this;
+}
+
+
+/**
+ * BitGrid::is_external()
+ *
+ * @return
+ *      True if the grid wraps storage it does not own, such as a memory-mapped file.
+ */
+bool BitGrid::is_external() const {
+	return (bool)this->owner;
+}
+
+
+/**
+ * BitGrid::BitGrid(grid)
+ *
+ * Construct a bit-packed copy of a byte-per-cell Grid.
+ *
+ * @example
+ *
+ *      // Pack a glider
+ *      BitGrid packed(Zoo::glider());
+ *
+ * @param grid
+ *      The grid to pack.
+ */
+BitGrid::BitGrid(const Grid &grid) : BitGrid(GridView(grid)) {}
+
+
+/**
+ * BitGrid::BitGrid(grid)
+ *
+ * Construct a bit-packed grid holding the same cells as a view of a byte-per-cell grid,
+ * e.g. to save or step a cropped or rotated region of a board without copying it out first.
+ *
+ * @param grid
+ *      The view to pack.
+ */
+BitGrid::BitGrid(const GridView &grid) : BitGrid(grid.get_width(), grid.get_height()) {
+	for (int y = 0; y < this->height; y++) {
+		uint64_t *target = this->row(y);
+		if (!grid.is_contiguous()) {
+			for (int x = 0; x < this->width; x++) {
+				if (grid(x, y) == ALIVE) {
+					target[x / WORD_BITS] |= ((uint64_t)1) << (x % WORD_BITS);
+				}
+			}
+			continue;
+		}
+		const Cell *source = grid.row(y);
+		for (int x = 0; x < this->width; x++) {
+			if (source[x] == ALIVE) {
+				target[x / WORD_BITS] |= ((uint64_t)1) << (x % WORD_BITS);
+			}
+		}
+	}
+}
+
+
+/**
+ * BitGrid::get_width()
+ *
+ * Gets the current width of the grid.
+ *
+ * @return
+ *      The width of the grid.
+ */
+int BitGrid::get_width() const {
+	return this->width;
+}
+
+
+/**
+ * BitGrid::get_height()
+ *
+ * Gets the current height of the grid.
+ *
+ * @return
+ *      The height of the grid.
+ */
+int BitGrid::get_height() const {
+	return this->height;
+}
+
+
+/**
+ * BitGrid::get_total_cells()
+ *
+ * Gets the total number of cells in the grid.
+ *
+ * @return
+ *      The number of total cells.
+ */
+int BitGrid::get_total_cells() const {
+	return (this->get_width() * this->get_height());
+}
+
+
+/**
+ * BitGrid::get_alive_cells()
+ *
+ * Counts how many cells in the grid are alive.
+ * Padding bits are always 0, so this is a plain popcount over every word.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+int BitGrid::get_alive_cells() const {
+	int counter = 0;
+	size_t numWords = (size_t)this->wordsPerRow * this->height;
+	for (size_t i = 0; i < numWords; i++) {
+		counter += __builtin_popcountll(this->data[i]);
+	}
+	return counter;
+}
+
+
+/**
+ * BitGrid::get_dead_cells()
+ *
+ * Counts how many cells in the grid are dead.
+ *
+ * @return
+ *      The number of dead cells.
+ */
+int BitGrid::get_dead_cells() const {
+	return this->get_total_cells() - this->get_alive_cells();
+}
+
+
+/**
+ * BitGrid::resize(square_size)
+ *
+ * Resize the current grid to a new width and height that are equal, preserving the kept region.
+ *
+ * @param square_size
+ *      The new edge size for both the width and height of the grid.
+ */
+void BitGrid::resize(int square_size) {
+	resize(square_size, square_size);
+}
+
+
+/**
+ * BitGrid::resize(width, height)
+ *
+ * Resize the current grid to a new width and height. The content of the grid
+ * is preserved within the kept region and padded with Cell::DEAD if new cells are added.
+ *
+ * @param width
+ *      The new width for the grid.
+ *
+ * @param height
+ *      The new height for the grid.
+ */
+void BitGrid::resize(int width, int height) {
+	BitGrid resized(width, height);
+	resized.merge(this->crop(0, 0, std::min(width, this->width), std::min(height, this->height)), 0, 0);
+	*this = std::move(resized);
+}
+
+
+/**
+ * BitGrid::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The value of the desired cell.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
+ */
+Cell BitGrid::get(unsigned int x, unsigned int y) const {
+	return (*this)(x, y);
+}
+
+
+/**
+ * BitGrid::set(x, y, value)
+ *
+ * Overwrites the value at the desired coordinate.
+ *
+ * @param x
+ *      The x coordinate of the cell to update.
+ *
+ * @param y
+ *      The y coordinate of the cell to update.
+ *
+ * @param value
+ *      The value to be written to the selected cell.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
+ */
+void BitGrid::set(unsigned int x, unsigned int y, Cell value) {
+	(*this)(x, y) = value;
+}
+
+
+/**
+ * BitGrid::operator()(x, y)
+ *
+ * Gets a modifiable reference to the packed cell at the desired coordinate.
+ *
+ * @example
+ *
+ *      // Directly assign to a cell at coordinate (1, 2)
+ *      grid(1, 2) = Cell::ALIVE;
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
+ */
+BitGrid::Reference BitGrid::operator()(unsigned int x, unsigned int y) {
+	if (x >= (unsigned int)this->get_width() || y >= (unsigned int)this->get_height()) {
+		throw std::invalid_argument("Invalid grid location.\n");
+	}
+
+	return Reference(this->row(y)[x / WORD_BITS], ((uint64_t)1) << (x % WORD_BITS));
+}
+
+
+/**
+ * BitGrid::operator()(x, y)
+ *
+ * Reads the value of the cell at the desired coordinate.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
+ */
+Cell BitGrid::operator()(unsigned int x, unsigned int y) const {
+	if (x >= (unsigned int)this->get_width() || y >= (unsigned int)this->get_height()) {
+		throw std::invalid_argument("Invalid grid location.\n");
+	}
+
+	return ((this->row(y)[x / WORD_BITS] >> (x % WORD_BITS)) & 1) ? ALIVE : DEAD;
+}
+
+
+/**
+ * BitGrid::get_words_per_row()
+ *
+ * Gets the number of 64 bit words used to store each row.
+ *
+ * @return
+ *      The row pitch of the grid in words.
+ */
+int BitGrid::get_words_per_row() const {
+	return this->wordsPerRow;
+}
+
+
+/**
+ * BitGrid::row(y)
+ *
+ * Gets a pointer to the first word of a packed row.
+ * Writers must keep the padding bits past the width of the grid 0.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A modifiable pointer to BitGrid::get_words_per_row() words.
+ *
+ * @throws
+ *      std::exception or sub-class if y is not a valid row within the grid.
+ */
+uint64_t* BitGrid::row(unsigned int y) {
+	if (y >= (unsigned int)this->get_height()) {
+		throw std::invalid_argument("Invalid grid row.\n");
+	}
+
+	return this->data + ((size_t)y * this->wordsPerRow);
+}
+
+
+/**
+ * BitGrid::row(y)
+ *
+ * Gets a read-only pointer to the first word of a packed row.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A read-only pointer to BitGrid::get_words_per_row() words.
+ *
+ * @throws
+ *      std::exception or sub-class if y is not a valid row within the grid.
+ */
+const uint64_t* BitGrid::row(unsigned int y) const {
+	if (y >= (unsigned int)this->get_height()) {
+		throw std::invalid_argument("Invalid grid row.\n");
+	}
+
+	return this->data + ((size_t)y * this->wordsPerRow);
+}
+
+
+/**
+ * BitGrid::crop(x0, y0, x1, y1)
+ *
+ * Extract a sub-grid spanning the range [x0, x1) by [y0, y1), copying 64 cells at a time.
+ *
+ * @return
+ *      A new grid of the cropped size containing the values extracted from the original grid.
+ *
+ * @throws
+ *      std::exception or sub-class if x0,y0 or x1,y1 are not valid coordinates within the grid
+ *      or if the crop window has a negative size.
+ */
+BitGrid BitGrid::crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const {
+	if (x0 > (unsigned int)this->get_width() || y0 > (unsigned int)this->get_height()
+			|| x1 > (unsigned int)this->get_width() || y1 > (unsigned int)this->get_height()) {
+		throw std::invalid_argument("Coordinates outside of grid bounds.\n");
+	}
+
+	if (x0 > x1) {
+		throw std::invalid_argument("x0 cannot be greater than x1.\n");
+	}
+
+	if (y0 > y1) {
+		throw std::invalid_argument("y0 cannot be greater than y1.\n");
+	}
+
+	BitGrid croppedGrid(x1 - x0, y1 - y0);
+
+	for (unsigned int y = y0; y < y1; y++) {
+		const uint64_t *source = this->row(y);
+		uint64_t *target = croppedGrid.row(y - y0);
+		//pull each destination word out of the (possibly unaligned) source span
+		for (int w = 0; w < croppedGrid.wordsPerRow; w++) {
+			int n = std::min(WORD_BITS, croppedGrid.width - w * WORD_BITS);
+			target[w] = read_bits(source, x0 + w * WORD_BITS, n);
+		}
+	}
+
+	return croppedGrid;
+}
+
+
+/**
+ * BitGrid::merge(other, x0, y0, alive_only = false)
+ *
+ * Overlay the other grid on the current grid at the desired location, 64 cells at a time.
+ * If alive_only = true then alive cells are or-ed in and dead cells in other leave the current value alone.
+ *
+ * @throws
+ *      std::exception or sub-class if the other grid being placed does not fit within the bounds of the current grid.
+ */
+void BitGrid::merge(const BitGrid &other, int x0, int y0, bool alive_only) {
+	if (x0 < 0 || y0 < 0) {
+		throw std::invalid_argument("x0 and y0 must be greater than 0.\n");
+	}
+
+	if (x0 + other.get_width() > this->get_width() || y0 + other.get_height() > this->get_height()) {
+		throw std::invalid_argument("Other grid being placed does not fit within the bounds of the current grid.\n");
+	}
+
+	for (int y = 0; y < other.height; y++) {
+		const uint64_t *source = other.row(y);
+		uint64_t *target = this->row(y + y0);
+		for (int w = 0; w < other.wordsPerRow; w++) {
+			int n = std::min(WORD_BITS, other.width - w * WORD_BITS);
+			int x = x0 + w * WORD_BITS;
+			uint64_t value = source[w];
+			if (alive_only == true) {
+				//does not overwrite alive cells in old grid
+				value |= read_bits(target, x, n);
+			}
+			write_bits(target, x, n, value);
+		}
+	}
+}
+
+
+/**
+ * BitGrid::rotate(rotation)
+ *
+ * Create a copy of the grid that is rotated clockwise by a multiple of 90 degrees.
+ *
+ * @param rotation
+ *      An positive or negative integer to rotate by in 90 intervals.
+ *
+ * @return
+ *      Returns a copy of the grid that has been rotated.
+ */
+BitGrid BitGrid::rotate(int rotation) const {
+	int turns = ((rotation % 4) + 4) % 4;
+
+	if (turns == 0) {
+		return *this;
+	}
+
+	BitGrid rotatedGrid = (turns % 2 == 0) ? BitGrid(width, height) : BitGrid(height, width);
+
+	for (int y = 0; y < height; y++) {
+		const uint64_t *source = this->row(y);
+		for (int x = 0; x < width; x++) {
+			if (((source[x / WORD_BITS] >> (x % WORD_BITS)) & 1) == 0) {
+				continue;
+			}
+			//map each alive source cell to its place in the rotated grid
+			if (turns == 1) {
+				rotatedGrid.set(height - 1 - y, x, ALIVE);
+			} else if (turns == 2) {
+				rotatedGrid.set(width - 1 - x, height - 1 - y, ALIVE);
+			} else {
+				rotatedGrid.set(y, width - 1 - x, ALIVE);
+			}
+		}
+	}
+
+	return rotatedGrid;
+}
+
+
+/**
+ * BitGrid::to_grid()
+ *
+ * Unpack the grid into a byte-per-cell Grid.
+ *
+ * @return
+ *      A Grid holding the same cells.
+ */
+Grid BitGrid::to_grid() const {
+	Grid grid(this->width, this->height);
+	for (int y = 0; y < this->height; y++) {
+		const uint64_t *source = this->row(y);
+		Cell *target = grid.row(y);
+		for (int x = 0; x < this->width; x++) {
+			target[x] = ((source[x / WORD_BITS] >> (x % WORD_BITS)) & 1) ? ALIVE : DEAD;
+		}
+	}
+	return grid;
+}
+
+
+/**
+ * operator<<(output_stream, grid)
+ *
+ * Serializes a bit-packed grid to an ascii output stream using the same bordered format as Grid.
+ *
+ * @return
+ *      Returns a reference to the output stream to enable operator chaining.
+ */
+std::ostream& operator<<(std::ostream& output_stream, const BitGrid &grid) {
+	std::string border = "+" + std::string(grid.get_width(), '-') + "+\n";
+	std::string line(grid.get_width() + 2, ' ');
+	line.front() = '|';
+	line.back() = '|';
+
+	output_stream << border;
+	for (int y = 0; y < grid.get_height(); y++) {
+		const uint64_t *source = grid.row(y);
+		for (int x = 0; x < grid.get_width(); x++) {
+			line[x + 1] = ((source[x / WORD_BITS] >> (x % WORD_BITS)) & 1) ? '#' : ' ';
+		}
+		output_stream << line << '\n';
+	}
+	output_stream << border;
+	return output_stream;
+}
@@ -0,0 +1,98 @@
+/**
+ * Declares a class representing a bit-packed 2d grid of cells.
+ * Rich documentation for the api and behaviour the BitGrid class can be found in bitgrid.cpp.
+ *
+ * A BitGrid mirrors the Grid api but stores one bit per cell, packed into 64 bit words per row.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <iostream>
+
+#include "grid.h"
+#include "grid_view.h"
+#include "grid_allocator.h"
+
+/**
+ * Declare the structure of the BitGrid class for representing a bit-packed 2d grid of cells.
+ *
+ * Each row starts on a fresh word, bit (x % 64) of word (x / 64) holds the cell at x.
+ * Bits past the width of the grid in the last word of a row are always kept 0.
+ *
+ * The words are normally owned by the grid, but a grid can also wrap storage owned elsewhere,
+ * such as a memory-mapped file, kept alive through a shared owner handle.
+ */
+class BitGrid {
+public:
+	/**
+	 * A modifiable reference to a single packed cell, returned by BitGrid::operator()(x, y).
+	 */
+	class Reference {
+	public:
+		Reference(uint64_t &word, uint64_t mask);
+
+		operator Cell() const;
+		Reference& operator=(Cell value);
+		Reference& operator=(const Reference &other);
+
+	private:
+		uint64_t &word;
+		uint64_t mask;
+	};
+
+	BitGrid();
+	explicit BitGrid(int square_size);
+	BitGrid(int width, int height);
+	explicit BitGrid(const Grid &grid);
+	explicit BitGrid(const GridView &grid);
+	BitGrid(int width, int height, uint64_t *words, std::shared_ptr<void> owner);
+
+	BitGrid(const BitGrid &other);
+	BitGrid(BitGrid &&other);
+	BitGrid& operator=(const BitGrid &other);
+	BitGrid& operator=(BitGrid &&other);
+
+	bool is_external() const;
+
+	int get_width() const;
+	int get_height() const;
+
+	int get_total_cells() const;
+	int get_alive_cells() const;
+	int get_dead_cells() const;
+
+	void resize(int square_size);
+	void resize(int width, int height);
+
+	Cell get(unsigned int x, unsigned int y) const;
+	void set(unsigned int x, unsigned int y, Cell value);
+
+	Reference operator()(unsigned int x, unsigned int y);
+	Cell operator()(unsigned int x, unsigned int y) const;
+
+	int get_words_per_row() const;
+	uint64_t* row(unsigned int y);
+	const uint64_t* row(unsigned int y) const;
+
+	BitGrid crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const;
+	void merge(const BitGrid &other, int x0, int y0, bool alive_only = false);
+
+	BitGrid rotate(int rotation) const;
+
+	Grid to_grid() const;
+
+	friend std::ostream& operator<<(std::ostream& output_stream, const BitGrid &grid);
+
+private:
+	int width, height;
+	int wordsPerRow;
+	std::vector<uint64_t, GridAllocator<uint64_t>> words;
+	//first word of row 0, either words.data() or external storage kept alive by owner
+	uint64_t *data;
+	std::shared_ptr<void> owner;
+};
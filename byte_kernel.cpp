@@ -0,0 +1,242 @@
+/**
+ * Implements a vectorised kernel for stepping byte-per-cell rows of a Grid under any Life-like rule.
+ *      - The best instruction set the CPU supports (SSE2, AVX2 or AVX-512BW) is found once with CPUID and
+ *        each implementation is compiled with a target attribute, so no special compiler flags are needed.
+ *      - Cells are Cell::DEAD (0x20) or Cell::ALIVE (0x23), so the low bit of every byte is the cell as 0 or 1.
+ *      - For each run of cells the rows above, at and below are loaded one cell to the left, centred and one
+ *        to the right, and the eight neighbours summed with byte adds into a count of 0 to 8 per cell.
+ *      - The rule is applied with a byte shuffle used as a 16 entry lookup table of the birth and survival
+ *        counts (or one compare per allowed count on SSE2), then blended on whether the cell is alive.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "byte_kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BYTE_KERNEL_X86 1
+#endif
+
+/**
+ * detect_instruction_set()
+ *
+ * Find the fastest instruction set the byte kernel can use on this CPU. The answer is cached after the first call.
+ *
+ * @return
+ *      Returns the instruction set, InstructionSet::NO_VECTOR on CPUs without any of them.
+ */
+InstructionSet detect_instruction_set() {
+#ifdef BYTE_KERNEL_X86
+	static const InstructionSet detected = [] {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512bw")) {
+			return AVX512;
+		} else if (__builtin_cpu_supports("avx2")) {
+			return AVX2;
+		} else if (__builtin_cpu_supports("sse2")) {
+			return SSE2;
+		}
+		return NO_VECTOR;
+	}();
+	return detected;
+#else
+	return NO_VECTOR;
+#endif
+}
+
+/**
+ * instruction_set_name(instruction_set)
+ *
+ * @return
+ *      Returns a printable name for the instruction set, e.g. "avx2".
+ */
+const char* instruction_set_name(InstructionSet instruction_set) {
+	switch (instruction_set) {
+		case SSE2: return "sse2";
+		case AVX2: return "avx2";
+		case AVX512: return "avx512";
+		default: return "none";
+	}
+}
+
+#ifdef BYTE_KERNEL_X86
+
+//helper function building the 16 entry byte table, 0xFF for the neighbour counts in mask
+static void count_table(uint16_t mask, char table[16]) {
+	for (int n = 0; n < 16; n++) {
+		table[n] = (n <= 8 && ((mask >> n) & 1)) ? (char)0xFF : 0;
+	}
+}
+
+//helper functions loading the cells from x as 0 or 1 per byte, a null row is dead
+__attribute__((target("sse2")))
+static inline __m128i load_sse2(const Cell *row, int x) {
+	return row ? _mm_and_si128(_mm_loadu_si128((const __m128i*)(row + x)), _mm_set1_epi8(1)) : _mm_setzero_si128();
+}
+
+__attribute__((target("avx2")))
+static inline __m256i load_avx2(const Cell *row, int x) {
+	return row ? _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(row + x)), _mm256_set1_epi8(1)) : _mm256_setzero_si256();
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static inline __m512i load_avx512(const Cell *row, int x) {
+	return row ? _mm512_and_si512(_mm512_loadu_si512((const void*)(row + x)), _mm512_set1_epi8(1)) : _mm512_setzero_si512();
+}
+
+__attribute__((target("sse2")))
+static int step_sse2(const Rule &rule, const Cell *above, const Cell *middle, const Cell *below, Cell *target,
+		int x0, int x1, long long &births, long long &deaths) {
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i dead = _mm_set1_epi8(DEAD);
+	const __m128i flip = _mm_set1_epi8(ALIVE ^ DEAD);
+
+	int x = x0;
+	for (; x + 16 <= x1; x += 16) {
+		__m128i centre = load_sse2(middle, x);
+		__m128i count = _mm_add_epi8(_mm_add_epi8(load_sse2(above, x - 1), load_sse2(above, x)), load_sse2(above, x + 1));
+		count = _mm_add_epi8(count, _mm_add_epi8(load_sse2(middle, x - 1), load_sse2(middle, x + 1)));
+		count = _mm_add_epi8(count, _mm_add_epi8(_mm_add_epi8(load_sse2(below, x - 1), load_sse2(below, x)), load_sse2(below, x + 1)));
+
+		//no byte shuffle before SSSE3, so test each count the rule uses
+		__m128i alive = _mm_cmpeq_epi8(centre, one);
+		__m128i result = zero;
+		for (int n = 0; n <= 8; n++) {
+			bool born = (rule.birth >> n) & 1, survives = (rule.survival >> n) & 1;
+			if (born || survives) {
+				__m128i equal = _mm_cmpeq_epi8(count, _mm_set1_epi8((char)n));
+				__m128i keep = born ? (survives ? equal : _mm_andnot_si128(alive, equal)) : _mm_and_si128(alive, equal);
+				result = _mm_or_si128(result, keep);
+			}
+		}
+
+		_mm_storeu_si128((__m128i*)(target + x), _mm_or_si128(dead, _mm_and_si128(result, flip)));
+		births += __builtin_popcount(_mm_movemask_epi8(_mm_andnot_si128(alive, result)));
+		deaths += __builtin_popcount(_mm_movemask_epi8(_mm_andnot_si128(result, alive)));
+	}
+	return x;
+}
+
+__attribute__((target("avx2")))
+static int step_avx2(const Rule &rule, const Cell *above, const Cell *middle, const Cell *below, Cell *target,
+		int x0, int x1, long long &births, long long &deaths) {
+	const __m256i one = _mm256_set1_epi8(1);
+	const __m256i dead = _mm256_set1_epi8(DEAD);
+	const __m256i flip = _mm256_set1_epi8(ALIVE ^ DEAD);
+
+	char birthTable[16], survivalTable[16];
+	count_table(rule.birth, birthTable);
+	count_table(rule.survival, survivalTable);
+	//the shuffle looks up within each 128 bit lane, so both lanes hold the table
+	const __m256i birth = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)birthTable));
+	const __m256i survival = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)survivalTable));
+
+	int x = x0;
+	for (; x + 32 <= x1; x += 32) {
+		__m256i centre = load_avx2(middle, x);
+		__m256i count = _mm256_add_epi8(_mm256_add_epi8(load_avx2(above, x - 1), load_avx2(above, x)), load_avx2(above, x + 1));
+		count = _mm256_add_epi8(count, _mm256_add_epi8(load_avx2(middle, x - 1), load_avx2(middle, x + 1)));
+		count = _mm256_add_epi8(count, _mm256_add_epi8(_mm256_add_epi8(load_avx2(below, x - 1), load_avx2(below, x)), load_avx2(below, x + 1)));
+
+		__m256i alive = _mm256_cmpeq_epi8(centre, one);
+		__m256i result = _mm256_blendv_epi8(_mm256_shuffle_epi8(birth, count), _mm256_shuffle_epi8(survival, count), alive);
+
+		_mm256_storeu_si256((__m256i*)(target + x), _mm256_or_si256(dead, _mm256_and_si256(result, flip)));
+		births += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_andnot_si256(alive, result)));
+		deaths += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_andnot_si256(result, alive)));
+	}
+	return x;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static int step_avx512(const Rule &rule, const Cell *above, const Cell *middle, const Cell *below, Cell *target,
+		int x0, int x1, long long &births, long long &deaths) {
+	const __m512i one = _mm512_set1_epi8(1);
+	const __m512i dead = _mm512_set1_epi8(DEAD);
+	const __m512i aliveCells = _mm512_set1_epi8(ALIVE);
+
+	//the shuffle looks up within each 128 bit lane, so all four lanes hold the table
+	alignas(64) char birthTable[64], survivalTable[64];
+	for (int lane = 0; lane < 4; lane++) {
+		count_table(rule.birth, birthTable + 16 * lane);
+		count_table(rule.survival, survivalTable + 16 * lane);
+	}
+	const __m512i birth = _mm512_load_si512((const void*)birthTable);
+	const __m512i survival = _mm512_load_si512((const void*)survivalTable);
+
+	int x = x0;
+	for (; x + 64 <= x1; x += 64) {
+		__m512i centre = load_avx512(middle, x);
+		__m512i count = _mm512_add_epi8(_mm512_add_epi8(load_avx512(above, x - 1), load_avx512(above, x)), load_avx512(above, x + 1));
+		count = _mm512_add_epi8(count, _mm512_add_epi8(load_avx512(middle, x - 1), load_avx512(middle, x + 1)));
+		count = _mm512_add_epi8(count, _mm512_add_epi8(_mm512_add_epi8(load_avx512(below, x - 1), load_avx512(below, x)), load_avx512(below, x + 1)));
+
+		__mmask64 alive = _mm512_test_epi8_mask(centre, one);
+		__mmask64 born = _mm512_test_epi8_mask(_mm512_shuffle_epi8(birth, count), one);
+		__mmask64 survives = _mm512_test_epi8_mask(_mm512_shuffle_epi8(survival, count), one);
+		__mmask64 result = (born & ~alive) | (survives & alive);
+
+		_mm512_storeu_si512((void*)(target + x), _mm512_mask_blend_epi8(result, dead, aliveCells));
+		births += __builtin_popcountll(result & ~alive);
+		deaths += __builtin_popcountll(alive & ~result);
+	}
+	return x;
+}
+
+#endif
+
+/**
+ * step_byte_span(instruction_set, rule, above, middle, below, target, x0, x1, births, deaths)
+ *
+ * Step a run of cells of one byte-per-cell row, a whole vector at a time, writing the next state into target.
+ * Cells from x0 up to the returned x are stepped; the rest of [x0, x1), less than one vector, is left to the caller.
+ *
+ * The kernel reads the cells at x - 1 and x + 1, so the cells at x0 - 1 and x1 of each row must be readable:
+ * either keep 1 <= x0 and x1 <= width - 1 and handle the edge columns separately, or give the grid a halo
+ * with Grid::set_halo. A null above or below row is read as entirely dead.
+ *
+ * @example
+ *
+ *      // Step the interior of row y, then the edges and any tail cell by cell
+ *      int done = step_byte_span(detect_instruction_set(), rule, grid.row(y - 1), grid.row(y), grid.row(y + 1),
+ *              next.row(y), 1, width - 1, births, deaths);
+ *
+ * @param instruction_set
+ *      The implementation to use, usually detect_instruction_set(). InstructionSet::NO_VECTOR steps nothing.
+ *
+ * @param births
+ *      Incremented by the number of stepped cells that came to life.
+ *
+ * @param deaths
+ *      Incremented by the number of stepped cells that died.
+ *
+ * @return
+ *      Returns the x coordinate of the first cell not stepped.
+ */
+int step_byte_span(InstructionSet instruction_set, const Rule &rule,
+		const Cell *above, const Cell *middle, const Cell *below, Cell *target,
+		int x0, int x1, long long &births, long long &deaths) {
+#ifdef BYTE_KERNEL_X86
+	switch (instruction_set) {
+		case AVX512: {
+			//finish with narrower vectors where a full 64 cells do not fit
+			int x = step_avx512(rule, above, middle, below, target, x0, x1, births, deaths);
+			x = step_avx2(rule, above, middle, below, target, x, x1, births, deaths);
+			return step_sse2(rule, above, middle, below, target, x, x1, births, deaths);
+		}
+		case AVX2: {
+			int x = step_avx2(rule, above, middle, below, target, x0, x1, births, deaths);
+			return step_sse2(rule, above, middle, below, target, x, x1, births, deaths);
+		}
+		case SSE2:
+			return step_sse2(rule, above, middle, below, target, x0, x1, births, deaths);
+		default:
+			break;
+	}
+#endif
+	(void)instruction_set; (void)rule; (void)above; (void)middle; (void)below; (void)target;
+	(void)x1; (void)births; (void)deaths;
+	return x0;
+}
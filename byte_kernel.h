@@ -0,0 +1,32 @@
+/**
+ * Declares the vectorised kernel that steps byte-per-cell rows, and the instruction set detection it dispatches on.
+ * Rich documentation for the api and behaviour of the kernel can be found in byte_kernel.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include "grid.h"
+#include "rule.h"
+
+/**
+ * The vector instruction sets the byte kernel has implementations for, from slowest to fastest.
+ *      - InstructionSet::NO_VECTOR has no vector kernel, every cell is stepped by the scalar path.
+ *      - InstructionSet::SSE2 steps 16 cells per instruction.
+ *      - InstructionSet::AVX2 steps 32 cells per instruction.
+ *      - InstructionSet::AVX512 steps 64 cells per instruction (AVX-512BW).
+ */
+enum InstructionSet {
+    NO_VECTOR,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+InstructionSet detect_instruction_set();
+const char* instruction_set_name(InstructionSet instruction_set);
+
+int step_byte_span(InstructionSet instruction_set, const Rule &rule,
+		const Cell *above, const Cell *middle, const Cell *below, Cell *target,
+		int x0, int x1, long long &births, long long &deaths);
@@ -0,0 +1,181 @@
+/**
+ * Implements a class that writes world checkpoints to disk on a background thread.
+ *      - A snapshot is an immutable shared Grid, so the simulation can keep stepping while it is written.
+ *      - Files are written with Zoo::save, so the format follows the extension of each path.
+ *      - The queue is bounded: when (depth) snapshots are already waiting, submit blocks (back-pressure)
+ *        rather than letting a slow disk build up an unbounded backlog of grids in memory.
+ *      - A failed write is reported by throwing from the next call to submit or wait.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "checkpoint_writer.h"
+
+#include <stdexcept>
+
+#include "zoo.h"
+
+/**
+ * CheckpointWriter::CheckpointWriter(depth)
+ *
+ * Construct a writer and start its background thread.
+ *
+ * @example
+ *
+ *      // Allow up to 4 checkpoints to queue up behind the one being written
+ *      CheckpointWriter writer(4);
+ *
+ * @param depth
+ *      The number of snapshots allowed to wait in the queue. Defaults to 2.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if the depth is less than 1.
+ */
+CheckpointWriter::CheckpointWriter(int depth) : depth(depth) {
+	if (depth < 1) {
+		throw std::invalid_argument("Invalid checkpoint queue depth.\n");
+	}
+	this->writer = std::thread(&CheckpointWriter::work, this);
+}
+
+/**
+ * CheckpointWriter::~CheckpointWriter()
+ *
+ * Finish writing every queued snapshot, then stop and join the writer thread.
+ * Errors that have not been reported yet are dropped, call wait() first to see them.
+ */
+CheckpointWriter::~CheckpointWriter() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->notEmpty.notify_all();
+	this->writer.join();
+}
+
+/**
+ * CheckpointWriter::get_depth()
+ *
+ * @return
+ *      The number of snapshots allowed to wait in the queue.
+ */
+int CheckpointWriter::get_depth() const {
+	return this->depth;
+}
+
+/**
+ * CheckpointWriter::get_pending()
+ *
+ * @return
+ *      The number of snapshots queued or being written.
+ */
+int CheckpointWriter::get_pending() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return (int)this->queue.size() + (this->busy ? 1 : 0);
+}
+
+/**
+ * CheckpointWriter::submit(path, snapshot, rule)
+ *
+ * Queue a snapshot to be written to a path. Returns as soon as the snapshot is queued,
+ * blocking only while the queue is full.
+ *
+ * @example
+ *
+ *      // Checkpoint every 1000 generations without waiting for the disk
+ *      CheckpointWriter writer;
+ *      for (int step = 1; step <= steps; step++) {
+ *          world.step();
+ *          if (step % 1000 == 0) {
+ *              writer.submit("checkpoint_" + std::to_string(step) + ".bgol", world.snapshot());
+ *          }
+ *      }
+ *      writer.wait();
+ *
+ * @param path
+ *      The std::string path to write the snapshot to.
+ *
+ * @param snapshot
+ *      The state to write, which must not be modified until it has been written.
+ *
+ * @param rule
+ *      Optional parameter. The rule the state is stepped under, kept by the formats that hold one (.rle). Defaults to Conway's.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if the snapshot is null.
+ *      Rethrows the error of an earlier write that failed.
+ */
+void CheckpointWriter::submit(std::string path, std::shared_ptr<const Grid> snapshot, const Rule &rule) {
+	if (!snapshot) {
+		throw std::invalid_argument("Invalid checkpoint snapshot.\n");
+	}
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->rethrow(lock);
+	//back-pressure, hold the simulation until the writer has room
+	this->notFull.wait(lock, [this]() { return (int)this->queue.size() < this->depth || this->error; });
+	this->rethrow(lock);
+
+	this->queue.push_back({std::move(path), std::move(snapshot), rule});
+	lock.unlock();
+	this->notEmpty.notify_one();
+}
+
+/**
+ * CheckpointWriter::wait()
+ *
+ * Block until every submitted snapshot has been written.
+ *
+ * @throws
+ *      Rethrows the error of a write that failed.
+ */
+void CheckpointWriter::wait() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->idle.wait(lock, [this]() { return (this->queue.empty() && !this->busy) || this->error; });
+	this->rethrow(lock);
+}
+
+//helper function throwing the stored error once, the lock must be held
+void CheckpointWriter::rethrow(std::unique_lock<std::mutex> &lock) {
+	if (this->error) {
+		std::exception_ptr failed = this->error;
+		this->error = nullptr;
+		lock.unlock();
+		std::rethrow_exception(failed);
+	}
+}
+
+//the writer thread, writing queued snapshots in order until stopped and drained
+void CheckpointWriter::work() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true) {
+		this->notEmpty.wait(lock, [this]() { return !this->queue.empty() || this->stopping; });
+		if (this->queue.empty()) {
+			return;
+		}
+
+		Job job = std::move(this->queue.front());
+		this->queue.pop_front();
+		this->busy = true;
+		lock.unlock();
+		this->notFull.notify_one();
+
+		std::exception_ptr failed;
+		try {
+			Zoo::save(job.path, *job.snapshot, job.rule);
+		}
+		catch (...) {
+			failed = std::current_exception();
+		}
+		//release the snapshot before reporting so its owner may reuse it
+		job.snapshot.reset();
+
+		lock.lock();
+		this->busy = false;
+		if (failed && !this->error) {
+			this->error = failed;
+		}
+		this->idle.notify_all();
+		this->notFull.notify_all();
+	}
+}
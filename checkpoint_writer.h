@@ -0,0 +1,65 @@
+/**
+ * Declares a class that writes world checkpoints to disk on a background thread.
+ * Rich documentation for the api and behaviour the CheckpointWriter class can be found in checkpoint_writer.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "grid.h"
+#include "rule.h"
+
+/**
+ * Declare the structure of the CheckpointWriter class.
+ *
+ * Snapshots are queued with CheckpointWriter::submit and written in order by a single writer thread.
+ * At most (depth) snapshots wait in the queue, after which submit blocks until the writer catches up.
+ */
+class CheckpointWriter {
+public:
+	explicit CheckpointWriter(int depth = 2);
+	~CheckpointWriter();
+
+	CheckpointWriter(const CheckpointWriter &) = delete;
+	CheckpointWriter& operator=(const CheckpointWriter &) = delete;
+
+	int get_depth() const;
+	int get_pending() const;
+
+	void submit(std::string path, std::shared_ptr<const Grid> snapshot, const Rule &rule = ConwayRule());
+	void wait();
+
+private:
+	struct Job {
+		std::string path;
+		std::shared_ptr<const Grid> snapshot;
+		Rule rule;
+	};
+
+	int depth;
+
+	//guards everything below
+	mutable std::mutex mutex;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+	std::condition_variable idle;
+	std::deque<Job> queue;
+	bool busy = false;
+	bool stopping = false;
+	//first failure of the writer, rethrown to the next caller of submit or wait
+	std::exception_ptr error;
+
+	std::thread writer;
+
+	void work();
+	void rethrow(std::unique_lock<std::mutex> &lock);
+};
@@ -0,0 +1,679 @@
+/**
+ * Implements a class simulating one world split across the ranks of an MPI job, for boards too big for one node.
+ *      - The board is cut into a 2d grid of blocks, one per rank, choosing the split whose blocks have the
+ *        shortest edges, as the edges are what is sent every step. Resizing the world re-picks the split.
+ *      - Each step posts non-blocking sends of the block's edges and receives of its halo, steps the inside
+ *        of the block while they are in flight, then waits and steps the ring of edge cells last.
+ *      - A toroidal world uses a periodic Cartesian communicator, so the ranks on opposite edges of the
+ *        board are neighbours and the wrap needs no special case. A bounded world's outer halo stays dead.
+ *      - Blocks are stepped with the byte-per-cell kernel, with SIMD instructions when the CPU has them.
+ *      - Loading, saving and gathering go through one root rank, one block at a time, so only the root
+ *        ever holds the whole board.
+ *
+ * @example
+ *
+ *      // Step a 65536x65536 torus across every rank, then save it from rank 0
+ *      MPI_Init(&argc, &argv);
+ *      {
+ *          DistributedWorld world(MPI_COMM_WORLD, 65536, 65536, true);
+ *          world.load("soup.bgol");
+ *          world.advance(1000);
+ *          world.save("soup_1000.bgol");
+ *      }
+ *      MPI_Finalize();
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "distributed_world.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#include "byte_kernel.h"
+#include "stats.h"
+#include "zoo.h"
+
+//the 8 directions to the neighbouring blocks, opposite directions are at d and 7 - d
+static const int DIRECTION_X[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+static const int DIRECTION_Y[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+
+//tag of the blocks sent by scatter and gather, clear of the direction tags used by the halo exchange
+static const int BLOCK_TAG = 8;
+
+//helper function giving the cells [start, end) of the index'th of parts near equal splits of size cells
+static void block_range(int size, int parts, int index, int &start, int &end) {
+	start = (int)((long long)size * index / parts);
+	end = (int)((long long)size * (index + 1) / parts);
+}
+
+//helper function giving the cells [start, end) of a block edge, or of the halo beyond it, facing one direction
+static void edge_range(int direction, int size, bool halo, int &start, int &end) {
+	if (direction == 0) {
+		start = 0;
+		end = size;
+	} else if (direction < 0) {
+		start = halo ? -1 : 0;
+		end = start + 1;
+	} else {
+		start = halo ? size : size - 1;
+		end = start + 1;
+	}
+}
+
+//helper function copying a rectangle of cells of a grid, halo included, to or from a packed buffer
+static void copy_rectangle(Grid &grid, int direction, bool halo, Cell *buffer, bool pack) {
+	int x0, x1, y0, y1;
+	edge_range(DIRECTION_X[direction], grid.get_width(), halo, x0, x1);
+	edge_range(DIRECTION_Y[direction], grid.get_height(), halo, y0, y1);
+	Cell *origin = grid.row(0);
+	long stride = grid.get_stride();
+	for (int y = y0; y < y1; y++) {
+		Cell *cells = origin + y * stride + x0;
+		if (pack) {
+			std::copy(cells, cells + (x1 - x0), buffer);
+		} else {
+			std::copy(buffer, buffer + (x1 - x0), cells);
+		}
+		buffer += x1 - x0;
+	}
+}
+
+/**
+ * DistributedWorld::DistributedWorld(comm, width, height, toroidal)
+ *
+ * Construct a world of the given size split across every rank of a communicator, every cell dead.
+ * Collective, every rank must construct it with the same arguments. The world must be destroyed before MPI_Finalize.
+ *
+ * @example
+ *
+ *      // Split a 4096x4096 bounded world across every rank
+ *      DistributedWorld world(MPI_COMM_WORLD, 4096, 4096);
+ *
+ * @param comm
+ *      The communicator holding the ranks to split the world across. It is duplicated, so the world's
+ *      messages never mix with the caller's, and each rank keeps its number in it.
+ *
+ * @param width
+ *      The width of the world.
+ *
+ * @param height
+ *      The height of the world.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the world is a torus, where the left edge wraps to the right edge
+ *      and the top to the bottom. Defaults to false.
+ *
+ * @throws
+ *      std::exception or sub-class if the world is too small to give every rank at least one cell.
+ */
+DistributedWorld::DistributedWorld(MPI_Comm comm, int width, int height, bool toroidal)
+		: comm(MPI_COMM_NULL), width(-1), height(-1), toroidal(toroidal), rank(0), ranks(0), blockX(0), blockY(0) {
+	MPI_Comm_dup(comm, &this->parent);
+	MPI_Comm_rank(this->parent, &this->rank);
+	MPI_Comm_size(this->parent, &this->ranks);
+	this->dims[0] = 0;
+	this->dims[1] = 0;
+	try {
+		this->layout(width, height);
+	} catch (...) {
+		MPI_Comm_free(&this->parent);
+		throw;
+	}
+}
+
+/**
+ * DistributedWorld::~DistributedWorld()
+ *
+ * Frees the world's communicators. Collective.
+ */
+DistributedWorld::~DistributedWorld() {
+	if (this->comm != MPI_COMM_NULL) {
+		MPI_Comm_free(&this->comm);
+	}
+	MPI_Comm_free(&this->parent);
+}
+
+/**
+ * DistributedWorld::layout(new_width, new_height)
+ *
+ * Private helper which splits a board of the given size across the ranks and sizes this rank's block.
+ * The split with the shortest block edges is picked, as those are the halo sent every step, and the
+ * Cartesian communicator is rebuilt whenever the split changes.
+ * A new block is all dead, halo included, and the halo beyond the edge of a bounded world stays dead for
+ * good as the halo exchange never writes it.
+ *
+ * @throws
+ *      std::exception or sub-class if the board is too small to give every rank at least one cell.
+ */
+void DistributedWorld::layout(int new_width, int new_height) {
+	if (new_width == this->width && new_height == this->height) {
+		return;
+	}
+
+	int columns = 0, rows = 0;
+	long long bestEdge = 0;
+	for (int x = 1; x <= this->ranks; x++) {
+		int y = this->ranks / x;
+		if (x * y != this->ranks || x > new_width || y > new_height) {
+			continue;
+		}
+		long long edge = (new_width + x - 1) / x + (new_height + y - 1) / y;
+		if (columns == 0 || edge < bestEdge) {
+			columns = x;
+			rows = y;
+			bestEdge = edge;
+		}
+	}
+	if (columns == 0) {
+		throw std::invalid_argument("The world is too small to split across every rank.\n");
+	}
+
+	if (columns != this->dims[0] || rows != this->dims[1]) {
+		if (this->comm != MPI_COMM_NULL) {
+			MPI_Comm_free(&this->comm);
+		}
+		//ranks keep their numbers from the parent communicator, so a root given by the caller stays the same rank
+		this->dims[0] = columns;
+		this->dims[1] = rows;
+		int periods[2] = {this->toroidal, this->toroidal};
+		MPI_Cart_create(this->parent, 2, this->dims, periods, 0, &this->comm);
+		MPI_Cart_coords(this->comm, this->rank, 2, this->coords);
+
+		for (int d = 0; d < 8; d++) {
+			int neighbour[2] = {this->coords[0] + DIRECTION_X[d], this->coords[1] + DIRECTION_Y[d]};
+			bool outside = false;
+			for (int axis = 0; axis < 2; axis++) {
+				if (this->toroidal) {
+					neighbour[axis] = (neighbour[axis] + this->dims[axis]) % this->dims[axis];
+				} else {
+					outside = outside || neighbour[axis] < 0 || neighbour[axis] >= this->dims[axis];
+				}
+			}
+			if (outside) {
+				this->neighbours[d] = MPI_PROC_NULL;
+			} else {
+				MPI_Cart_rank(this->comm, neighbour, &this->neighbours[d]);
+			}
+		}
+	}
+
+	int x1, y1;
+	block_range(new_width, this->dims[0], this->coords[0], this->blockX, x1);
+	block_range(new_height, this->dims[1], this->coords[1], this->blockY, y1);
+	this->width = new_width;
+	this->height = new_height;
+
+	this->currentState = Grid(x1 - this->blockX, y1 - this->blockY);
+	this->nextState = Grid(x1 - this->blockX, y1 - this->blockY);
+	this->currentState.set_halo(1);
+	this->nextState.set_halo(1);
+	this->currentState.refresh_halo(false);
+	this->nextState.refresh_halo(false);
+
+	for (int d = 0; d < 8; d++) {
+		int size = (DIRECTION_X[d] != 0 ? 1 : x1 - this->blockX) * (DIRECTION_Y[d] != 0 ? 1 : y1 - this->blockY);
+		this->sendBuffers[d].assign(size, DEAD);
+		this->receiveBuffers[d].assign(size, DEAD);
+	}
+	this->localPopulation = 0;
+}
+
+/**
+ * DistributedWorld::get_width()
+ *
+ * @return
+ *      The width of the whole world.
+ */
+int DistributedWorld::get_width() const {
+	return this->width;
+}
+
+/**
+ * DistributedWorld::get_height()
+ *
+ * @return
+ *      The height of the whole world.
+ */
+int DistributedWorld::get_height() const {
+	return this->height;
+}
+
+/**
+ * DistributedWorld::get_toroidal()
+ *
+ * @return
+ *      True if the world wraps at its edges.
+ */
+bool DistributedWorld::get_toroidal() const {
+	return this->toroidal;
+}
+
+/**
+ * DistributedWorld::get_rank()
+ *
+ * @return
+ *      This rank's number, the same as in the communicator given to the constructor.
+ */
+int DistributedWorld::get_rank() const {
+	return this->rank;
+}
+
+/**
+ * DistributedWorld::get_ranks()
+ *
+ * @return
+ *      The number of ranks the world is split across.
+ */
+int DistributedWorld::get_ranks() const {
+	return this->ranks;
+}
+
+/**
+ * DistributedWorld::get_block_x()
+ *
+ * @return
+ *      The x coordinate on the board of the left column of this rank's block.
+ */
+int DistributedWorld::get_block_x() const {
+	return this->blockX;
+}
+
+/**
+ * DistributedWorld::get_block_y()
+ *
+ * @return
+ *      The y coordinate on the board of the top row of this rank's block.
+ */
+int DistributedWorld::get_block_y() const {
+	return this->blockY;
+}
+
+/**
+ * DistributedWorld::get_block()
+ *
+ * Gets this rank's block of the board. Cell (x, y) of the block is cell
+ * (DistributedWorld::get_block_x() + x, DistributedWorld::get_block_y() + y) of the board. Not collective.
+ *
+ * @return
+ *      A read-only reference to this rank's block.
+ */
+const Grid& DistributedWorld::get_block() const {
+	return this->currentState;
+}
+
+/**
+ * DistributedWorld::get_population()
+ *
+ * Counts the alive cells of the whole world. Collective, each rank keeps its own count up to date
+ * from its births and deaths so this is a single reduction.
+ *
+ * @return
+ *      The number of alive cells in the world, on every rank.
+ */
+long long DistributedWorld::get_population() const {
+	long long population = 0;
+	MPI_Allreduce(&this->localPopulation, &population, 1, MPI_LONG_LONG, MPI_SUM, this->comm);
+	return population;
+}
+
+/**
+ * DistributedWorld::get_generation()
+ *
+ * @return
+ *      The number of steps taken since the world was constructed or last set.
+ */
+long long DistributedWorld::get_generation() const {
+	return this->generation;
+}
+
+/**
+ * DistributedWorld::get_rule()
+ *
+ * @return
+ *      The rule the world steps with, Conway's B3/S23 by default.
+ */
+Rule DistributedWorld::get_rule() const {
+	return this->rule;
+}
+
+/**
+ * DistributedWorld::set_rule(rule)
+ *
+ * Sets the Life-like rule the world steps with. Every rank must set the same rule.
+ *
+ * @param rule
+ *      The rule to step with.
+ */
+void DistributedWorld::set_rule(const Rule &rule) {
+	this->rule = rule;
+}
+
+/**
+ * DistributedWorld::scatter(state, root)
+ *
+ * Sets the whole world from a grid held by the root rank, resizing the world to the grid's size and
+ * sending each rank its block. A resize can change how the board is split across the ranks. The generation goes back to 0. Collective.
+ *
+ * @example
+ *
+ *      // Put a glider in the top left of the world
+ *      Grid board(world.get_rank() == 0 ? world.get_width() : 0, world.get_rank() == 0 ? world.get_height() : 0);
+ *      if (world.get_rank() == 0) {
+ *          board.merge(Zoo::glider(), 0, 0);
+ *      }
+ *      world.scatter(board);
+ *
+ * @param state
+ *      The state to set the world to. Only read on the root rank, the other ranks can pass an empty grid.
+ *
+ * @param root
+ *      Optional parameter. The rank holding the state. Defaults to 0.
+ *
+ * @throws
+ *      std::exception or sub-class, on every rank, if root is not a rank of the world or the state is
+ *      too small to give every rank at least one cell.
+ */
+void DistributedWorld::scatter(const Grid &state, int root) {
+	if (root < 0 || root >= this->ranks) {
+		throw std::invalid_argument("Root is not a rank of the world.\n");
+	}
+	int size[2] = {state.get_width(), state.get_height()};
+	MPI_Bcast(size, 2, MPI_INT, root, this->comm);
+	this->layout(size[0], size[1]);
+
+	int blockWidth = this->currentState.get_width();
+	int blockHeight = this->currentState.get_height();
+	if (this->rank == root) {
+		//one block at a time, so the root never holds more than one packed block beside the state
+		std::vector<Cell> packed;
+		for (int r = 0; r < this->ranks; r++) {
+			int position[2], x0, x1, y0, y1;
+			MPI_Cart_coords(this->comm, r, 2, position);
+			block_range(this->width, this->dims[0], position[0], x0, x1);
+			block_range(this->height, this->dims[1], position[1], y0, y1);
+			if (r == root) {
+				for (int y = y0; y < y1; y++) {
+					std::copy(state.row(y) + x0, state.row(y) + x1, this->currentState.row(y - y0));
+				}
+				continue;
+			}
+			packed.resize((size_t)(x1 - x0) * (y1 - y0));
+			for (int y = y0; y < y1; y++) {
+				std::copy(state.row(y) + x0, state.row(y) + x1, packed.begin() + (size_t)(y - y0) * (x1 - x0));
+			}
+			MPI_Send(packed.data(), (int)packed.size(), MPI_BYTE, r, BLOCK_TAG, this->comm);
+		}
+	} else {
+		std::vector<Cell> packed((size_t)blockWidth * blockHeight);
+		MPI_Recv(packed.data(), (int)packed.size(), MPI_BYTE, root, BLOCK_TAG, this->comm, MPI_STATUS_IGNORE);
+		for (int y = 0; y < blockHeight; y++) {
+			std::copy(packed.begin() + (size_t)y * blockWidth, packed.begin() + (size_t)(y + 1) * blockWidth,
+					this->currentState.row(y));
+		}
+	}
+
+	this->localPopulation = this->currentState.get_alive_cells();
+	this->generation = 0;
+}
+
+/**
+ * DistributedWorld::gather(root)
+ *
+ * Collects every rank's block into one grid on the root rank. Collective.
+ * The root must have room for the whole board, the other ranks need none.
+ *
+ * @param root
+ *      Optional parameter. The rank to gather onto. Defaults to 0.
+ *
+ * @return
+ *      The whole world on the root rank, an empty grid on every other rank.
+ *
+ * @throws
+ *      std::exception or sub-class, on every rank, if root is not a rank of the world.
+ */
+Grid DistributedWorld::gather(int root) const {
+	if (root < 0 || root >= this->ranks) {
+		throw std::invalid_argument("Root is not a rank of the world.\n");
+	}
+
+	int blockWidth = this->currentState.get_width();
+	int blockHeight = this->currentState.get_height();
+	if (this->rank != root) {
+		std::vector<Cell> packed((size_t)blockWidth * blockHeight);
+		for (int y = 0; y < blockHeight; y++) {
+			std::copy(this->currentState.row(y), this->currentState.row(y) + blockWidth,
+					packed.begin() + (size_t)y * blockWidth);
+		}
+		MPI_Send(packed.data(), (int)packed.size(), MPI_BYTE, root, BLOCK_TAG, this->comm);
+		return Grid(0);
+	}
+
+	Grid board(this->width, this->height);
+	std::vector<Cell> packed;
+	for (int r = 0; r < this->ranks; r++) {
+		int position[2], x0, x1, y0, y1;
+		MPI_Cart_coords(this->comm, r, 2, position);
+		block_range(this->width, this->dims[0], position[0], x0, x1);
+		block_range(this->height, this->dims[1], position[1], y0, y1);
+		if (r == root) {
+			board.merge(this->currentState, x0, y0);
+			continue;
+		}
+		packed.resize((size_t)(x1 - x0) * (y1 - y0));
+		MPI_Recv(packed.data(), (int)packed.size(), MPI_BYTE, r, BLOCK_TAG, this->comm, MPI_STATUS_IGNORE);
+		for (int y = y0; y < y1; y++) {
+			std::copy(packed.begin() + (size_t)(y - y0) * (x1 - x0), packed.begin() + (size_t)(y - y0 + 1) * (x1 - x0),
+					board.row(y) + x0);
+		}
+	}
+	return board;
+}
+
+/**
+ * DistributedWorld::load(path, root)
+ *
+ * Loads the world from any of the Zoo formats (see Zoo::load) on the root rank and scatters it,
+ * resizing the world to the file's size. The generation goes back to 0. Collective.
+ *
+ * @param path
+ *      The path to the file, only read on the root rank.
+ *
+ * @param root
+ *      Optional parameter. The rank to load on. Defaults to 0.
+ *
+ * @throws
+ *      std::exception or sub-class, on every rank, if the file cannot be loaded or is too small to split.
+ *      The root rethrows the error from Zoo::load, the other ranks throw a std::runtime_error.
+ */
+void DistributedWorld::load(const std::string &path, int root) {
+	if (root < 0 || root >= this->ranks) {
+		throw std::invalid_argument("Root is not a rank of the world.\n");
+	}
+
+	//a failure on the root is shared so no rank is left waiting in scatter
+	Grid state(0);
+	std::exception_ptr error;
+	int loaded = 1;
+	if (this->rank == root) {
+		try {
+			state = Zoo::load(path);
+		} catch (...) {
+			error = std::current_exception();
+			loaded = 0;
+		}
+	}
+	MPI_Bcast(&loaded, 1, MPI_INT, root, this->comm);
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	if (loaded == 0) {
+		throw std::runtime_error("Failed to load the world on the root rank.\n");
+	}
+	this->scatter(state, root);
+}
+
+/**
+ * DistributedWorld::save(path, root)
+ *
+ * Gathers the world onto the root rank and saves it there in the Zoo format picked by the file's
+ * extension (see Zoo::save), labelled with the world's rule if the format holds one. Collective.
+ *
+ * @param path
+ *      The path to the file, only written on the root rank.
+ *
+ * @param root
+ *      Optional parameter. The rank to save on. Defaults to 0.
+ *
+ * @throws
+ *      std::exception or sub-class, on every rank, if the file cannot be saved.
+ *      The root rethrows the error from Zoo::save, the other ranks throw a std::runtime_error.
+ */
+void DistributedWorld::save(const std::string &path, int root) const {
+	Grid board = this->gather(root);
+
+	std::exception_ptr error;
+	int saved = 1;
+	if (this->rank == root) {
+		try {
+			Zoo::save(path, board, this->rule);
+		} catch (...) {
+			error = std::current_exception();
+			saved = 0;
+		}
+	}
+	MPI_Bcast(&saved, 1, MPI_INT, root, this->comm);
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	if (saved == 0) {
+		throw std::runtime_error("Failed to save the world on the root rank.\n");
+	}
+}
+
+/**
+ * DistributedWorld::post_halo_exchange()
+ *
+ * Private helper which starts receiving the halo from, and sending the block's edges to, the 8 neighbouring ranks.
+ * Each message is tagged with the direction it travels in, so two directions to the same rank on a narrow
+ * torus cannot be confused. Neighbours off the edge of a bounded world are MPI_PROC_NULL, which completes at once.
+ */
+void DistributedWorld::post_halo_exchange() {
+	for (int d = 0; d < 8; d++) {
+		MPI_Irecv(this->receiveBuffers[d].data(), (int)this->receiveBuffers[d].size(), MPI_BYTE,
+				this->neighbours[d], 7 - d, this->comm, &this->requests[d]);
+	}
+	for (int d = 0; d < 8; d++) {
+		copy_rectangle(this->currentState, d, false, this->sendBuffers[d].data(), true);
+		MPI_Isend(this->sendBuffers[d].data(), (int)this->sendBuffers[d].size(), MPI_BYTE,
+				this->neighbours[d], d, this->comm, &this->requests[8 + d]);
+	}
+}
+
+/**
+ * DistributedWorld::finish_halo_exchange()
+ *
+ * Private helper which waits for the messages posted by DistributedWorld::post_halo_exchange and
+ * copies the received edges into the block's halo.
+ */
+void DistributedWorld::finish_halo_exchange() {
+	MPI_Waitall(16, this->requests, MPI_STATUSES_IGNORE);
+	for (int d = 0; d < 8; d++) {
+		if (this->neighbours[d] != MPI_PROC_NULL) {
+			copy_rectangle(this->currentState, d, true, this->receiveBuffers[d].data(), false);
+		}
+	}
+}
+
+/**
+ * DistributedWorld::step_cells(rule, x0, x1, y0, y1, births, deaths)
+ *
+ * Private helper which applies the rule to the block's cells [x0, x1) by [y0, y1), reading the current state
+ * and writing the next. Every neighbour read must already be in the block or its halo.
+ */
+template<typename RuleType>
+void DistributedWorld::step_cells(const RuleType &rule, int x0, int x1, int y0, int y1, long long &births, long long &deaths) {
+	if (x0 >= x1) {
+		return;
+	}
+	InstructionSet instructionSet = detect_instruction_set();
+	int stride = this->currentState.get_stride();
+
+	for (int y = y0; y < y1; y++) {
+		const Cell *above = this->currentState.row(y) - stride;
+		const Cell *middle = this->currentState.row(y);
+		const Cell *below = middle + stride;
+		Cell *target = this->nextState.row(y);
+		int x = step_byte_span(instructionSet, Rule(rule), above, middle, below, target, x0, x1, births, deaths);
+		for (; x < x1; x++) {
+			int neighbours = (above[x-1] == ALIVE) + (above[x] == ALIVE) + (above[x+1] == ALIVE)
+				+ (middle[x-1] == ALIVE) + (middle[x+1] == ALIVE)
+				+ (below[x-1] == ALIVE) + (below[x] == ALIVE) + (below[x+1] == ALIVE);
+			bool wasAlive = middle[x] == ALIVE;
+			bool alive = rule.next(neighbours, wasAlive);
+			target[x] = alive ? ALIVE : DEAD;
+			births += (alive && !wasAlive);
+			deaths += (wasAlive && !alive);
+		}
+	}
+}
+
+/**
+ * DistributedWorld::step()
+ *
+ * Take one step of the whole world. Collective.
+ *
+ * The edges are sent to the neighbouring ranks first. The inside of the block, which reads no halo, is
+ * stepped while they are in flight, and only the ring of edge cells waits for the halo to arrive.
+ * The results are identical to stepping the whole board with World::step(toroidal).
+ */
+void DistributedWorld::step() {
+	int blockWidth = this->currentState.get_width();
+	int blockHeight = this->currentState.get_height();
+	long long births = 0, deaths = 0;
+
+	this->post_halo_exchange();
+	with_rule(this->rule, [&](const auto &rule) {
+		{
+			Stats::Timer timer(Stats::STEP);
+			this->step_cells(rule, 1, blockWidth - 1, 1, blockHeight - 1, births, deaths);
+		}
+		{
+			Stats::Timer timer(Stats::HALO);
+			this->finish_halo_exchange();
+		}
+
+		//the ring of edge cells, taking care not to step a row or column twice in a block 1 cell thick
+		Stats::Timer timer(Stats::STEP);
+		this->step_cells(rule, 0, blockWidth, 0, 1, births, deaths);
+		if (blockHeight > 1) {
+			this->step_cells(rule, 0, blockWidth, blockHeight - 1, blockHeight, births, deaths);
+		}
+		this->step_cells(rule, 0, 1, 1, blockHeight - 1, births, deaths);
+		if (blockWidth > 1) {
+			this->step_cells(rule, blockWidth - 1, blockWidth, 1, blockHeight - 1, births, deaths);
+		}
+	});
+
+	//the halo the next state carries is refilled by the next exchange, or is the dead edge of a bounded world
+	std::swap(this->currentState, this->nextState);
+	this->localPopulation += births - deaths;
+	this->generation++;
+	Stats::count_cells((unsigned long long)blockWidth * blockHeight);
+}
+
+/**
+ * DistributedWorld::advance(steps)
+ *
+ * Advance multiple steps of the whole world. Collective.
+ * Should be implemented by invoking DistributedWorld::step().
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ */
+void DistributedWorld::advance(int steps) {
+	for (int i = 0; i < steps; i++) {
+		this->step();
+	}
+}
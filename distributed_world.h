@@ -0,0 +1,92 @@
+/**
+ * Declares a class simulating one world split across the ranks of an MPI job, for boards too big for one node.
+ * Rich documentation for the api and behaviour the DistributedWorld class can be found in distributed_world.cpp.
+ *
+ * Needs an MPI implementation, compile with mpicxx and launch with mpirun.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <mpi.h>
+
+#include <string>
+#include <vector>
+
+#include "grid.h"
+#include "rule.h"
+
+/**
+ * Declare the structure of the DistributedWorld class.
+ *
+ * The ranks are laid out on a 2d Cartesian communicator, periodic when the world is toroidal, and each
+ * rank owns one rectangular block of the board. A block is a Grid with a one cell halo which is filled
+ * from the 8 neighbouring ranks before each step.
+ *
+ * Every member function other than the getters of the local block is collective: all ranks of the
+ * communicator must call it, in the same order, with the same arguments.
+ */
+class DistributedWorld {
+public:
+	DistributedWorld(MPI_Comm comm, int width, int height, bool toroidal = false);
+	~DistributedWorld();
+
+	DistributedWorld(const DistributedWorld &) = delete;
+	DistributedWorld& operator=(const DistributedWorld &) = delete;
+
+	int get_width() const;
+	int get_height() const;
+	bool get_toroidal() const;
+
+	int get_rank() const;
+	int get_ranks() const;
+	int get_block_x() const;
+	int get_block_y() const;
+	const Grid& get_block() const;
+
+	long long get_population() const;
+	long long get_generation() const;
+
+	Rule get_rule() const;
+	void set_rule(const Rule &rule);
+
+	void scatter(const Grid &state, int root = 0);
+	Grid gather(int root = 0) const;
+	void load(const std::string &path, int root = 0);
+	void save(const std::string &path, int root = 0) const;
+
+	void step();
+	void advance(int steps);
+
+private:
+	//a duplicate of the caller's communicator, and the Cartesian one made from it for the current split
+	MPI_Comm parent;
+	MPI_Comm comm;
+	int width, height;
+	bool toroidal;
+	int rank, ranks;
+	//ranks along x and y, and this rank's position among them
+	int dims[2];
+	int coords[2];
+	//the top left cell of this rank's block on the board
+	int blockX, blockY;
+	Grid currentState;
+	Grid nextState;
+	Rule rule = ConwayRule();
+	long long localPopulation = 0;
+	long long generation = 0;
+
+	//the rank in each of the 8 directions, MPI_PROC_NULL off the edge of a bounded world
+	int neighbours[8];
+	//edges packed for sending and halos received, one per direction, reused by every step
+	std::vector<Cell> sendBuffers[8];
+	std::vector<Cell> receiveBuffers[8];
+	MPI_Request requests[16];
+
+	void layout(int new_width, int new_height);
+	void post_halo_exchange();
+	void finish_halo_exchange();
+	template<typename RuleType>
+	void step_cells(const RuleType &rule, int x0, int x1, int y0, int y1, long long &births, long long &deaths);
+};
@@ -0,0 +1,202 @@
+/**
+ * Implements an execution policy for whole-grid operations that are not the step kernel.
+ *      - ExecutionPolicy::sequential runs every operation on the calling thread, exactly as before.
+ *      - ExecutionPolicy::parallel splits the rows into one band per thread and runs the bands on a ThreadPool.
+ *        Pools are made once per thread count and shared by every policy asking for that count.
+ *      - Bands never share an output: counts are summed per band and added up afterwards, and encoders can ask
+ *        for band boundaries on a multiple of rows so each band writes whole bytes of a preallocated buffer.
+ *      - Small grids are not split, as handing a few thousand cells to another thread costs more than counting them.
+ *      - Operations given a parallel policy must not be called from inside a band of the same pool, as ThreadPool::run
+ *        is not reentrant.
+ *
+ * This stands in for the std::execution policies, which libstdc++ only implements on top of TBB.
+ *
+ * @example
+ *
+ *      // Load and count a huge board on every core
+ *      ExecutionPolicy policy = ExecutionPolicy::parallel();
+ *      Grid grid = Zoo::load_binary("path/to/huge.bgol", policy);
+ *      std::cout << grid.get_alive_cells(policy) << std::endl;
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "execution_policy.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * ExecutionPolicy::sequential()
+ *
+ * @return
+ *      A policy that runs everything on the calling thread.
+ */
+ExecutionPolicy ExecutionPolicy::sequential() {
+	return ExecutionPolicy();
+}
+
+/**
+ * ExecutionPolicy::parallel(threads)
+ *
+ * Make a policy that splits work across a pool of threads, including the caller.
+ *
+ * @example
+ *
+ *      // Save a board using 16 threads
+ *      Zoo::save_binary("path/to/board.bgol", board, ExecutionPolicy::parallel(16));
+ *
+ * @param threads
+ *      Optional parameter. The number of threads, 0 for one per hardware thread. Defaults to 0.
+ *
+ * @return
+ *      The policy, which is sequential if only one thread is asked for or available.
+ */
+ExecutionPolicy ExecutionPolicy::parallel(int threads) {
+	static std::mutex poolsMutex;
+	static std::map<int, std::shared_ptr<ThreadPool>> pools;
+
+	if (threads <= 0) {
+		threads = (int)std::thread::hardware_concurrency();
+	}
+	ExecutionPolicy policy;
+	if (threads <= 1) {
+		return policy;
+	}
+
+	std::lock_guard<std::mutex> lock(poolsMutex);
+	std::shared_ptr<ThreadPool> &pool = pools[threads];
+	if (!pool) {
+		pool = std::make_shared<ThreadPool>(threads);
+	}
+	policy.pool = pool;
+	return policy;
+}
+
+/**
+ * ExecutionPolicy::get_threads()
+ *
+ * @return
+ *      The number of threads work is split across, including the caller.
+ */
+int ExecutionPolicy::get_threads() const {
+	return this->pool ? this->pool->get_threads() : 1;
+}
+
+/**
+ * ExecutionPolicy::is_parallel()
+ *
+ * @return
+ *      True if work may be split across more than one thread.
+ */
+bool ExecutionPolicy::is_parallel() const {
+	return this->pool != nullptr;
+}
+
+/**
+ * ExecutionPolicy::for_bands(rows, cells_per_row, row_multiple, band)
+ *
+ * Split [0, rows) into bands and call band(y0, y1) for each band [y0, y1), in parallel if the policy is.
+ *
+ * @example
+ *
+ *      // Clear a grid in bands of 8 rows at a time
+ *      policy.for_bands(grid.get_height(), grid.get_width(), 8, [&](int y0, int y1) {
+ *          for (int y = y0; y < y1; y++) {
+ *              std::fill(grid.row(y), grid.row(y) + grid.get_width(), DEAD);
+ *          }
+ *      });
+ *
+ * @param rows
+ *      The number of rows.
+ *
+ * @param cells_per_row
+ *      The work in each row, used to keep small jobs on the calling thread.
+ *
+ * @param row_multiple
+ *      Every band but the last starts and ends on a multiple of this many rows.
+ *
+ * @param band
+ *      The function to call for each band. Bands may run in any order and on any thread.
+ */
+void ExecutionPolicy::for_bands(int rows, long long cells_per_row, int row_multiple, const std::function<void(int, int)> &band) const {
+	int bands = this->count_bands(rows, cells_per_row, row_multiple);
+	if (bands <= 1) {
+		if (rows > 0) {
+			band(0, rows);
+		}
+		return;
+	}
+
+	//round each band up to the row multiple, so only the last band can end part way through one
+	int units = (rows + row_multiple - 1) / row_multiple;
+	int rowsPerBand = ((units + bands - 1) / bands) * row_multiple;
+	this->pool->run(bands, [&](int i) {
+		int y0 = i * rowsPerBand;
+		int y1 = std::min(rows, y0 + rowsPerBand);
+		if (y0 < y1) {
+			band(y0, y1);
+		}
+	});
+}
+
+/**
+ * ExecutionPolicy::sum_bands(rows, cells_per_row, band)
+ *
+ * Split [0, rows) into bands as with ExecutionPolicy::for_bands and add up what band(y0, y1) returns for each.
+ *
+ * @example
+ *
+ *      // Count the alive cells of a grid
+ *      long long alive = policy.sum_bands(grid.get_height(), grid.get_width(), [&](int y0, int y1) {
+ *          long long count = 0;
+ *          for (int y = y0; y < y1; y++) {
+ *              count += std::count(grid.row(y), grid.row(y) + grid.get_width(), ALIVE);
+ *          }
+ *          return count;
+ *      });
+ *
+ * @return
+ *      The sum over every band.
+ */
+long long ExecutionPolicy::sum_bands(int rows, long long cells_per_row, const std::function<long long(int, int)> &band) const {
+	int bands = this->count_bands(rows, cells_per_row, 1);
+	if (bands <= 1) {
+		return (rows > 0) ? band(0, rows) : 0;
+	}
+
+	//each band writes only its own slot, so nothing is shared until the slots are added up
+	std::vector<long long> sums(bands, 0);
+	int rowsPerBand = (rows + bands - 1) / bands;
+	this->pool->run(bands, [&](int i) {
+		int y0 = i * rowsPerBand;
+		int y1 = std::min(rows, y0 + rowsPerBand);
+		if (y0 < y1) {
+			sums[i] = band(y0, y1);
+		}
+	});
+
+	long long sum = 0;
+	for (long long part : sums) {
+		sum += part;
+	}
+	return sum;
+}
+
+/**
+ * ExecutionPolicy::count_bands(rows, cells_per_row, row_multiple)
+ *
+ * Private helper which picks how many bands to split rows into: at most one per thread and per row multiple,
+ * and few enough that each band has at least MIN_BAND_CELLS of work.
+ */
+int ExecutionPolicy::count_bands(int rows, long long cells_per_row, int row_multiple) const {
+	if (!this->pool || rows <= 0) {
+		return 1;
+	}
+	long long units = (rows + row_multiple - 1) / row_multiple;
+	long long worthwhile = std::max<long long>(1, (long long)rows * std::max<long long>(cells_per_row, 1) / MIN_BAND_CELLS);
+	return (int)std::min<long long>({(long long)this->get_threads(), units, worthwhile});
+}
@@ -0,0 +1,40 @@
+/**
+ * Declares an execution policy choosing whether whole-grid operations such as counting, cropping, merging and
+ * binary encoding run serially or split into bands of rows across a thread pool.
+ * Rich documentation for the api and behaviour the ExecutionPolicy class can be found in execution_policy.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "thread_pool.h"
+
+/**
+ * Declare the structure of the ExecutionPolicy class.
+ *
+ * A policy is cheap to copy: parallel policies share one pool per thread count for the whole process.
+ */
+class ExecutionPolicy {
+public:
+	static ExecutionPolicy sequential();
+	static ExecutionPolicy parallel(int threads = 0);
+
+	int get_threads() const;
+	bool is_parallel() const;
+
+	void for_bands(int rows, long long cells_per_row, int row_multiple, const std::function<void(int, int)> &band) const;
+	long long sum_bands(int rows, long long cells_per_row, const std::function<long long(int, int)> &band) const;
+
+private:
+	//below this many cells a band is not worth handing to another thread
+	static const long long MIN_BAND_CELLS = 1 << 16;
+
+	std::shared_ptr<ThreadPool> pool;
+
+	ExecutionPolicy() = default;
+	int count_bands(int rows, long long cells_per_row, int row_multiple) const;
+};
@@ -0,0 +1,507 @@
+/**
+ * Implements the bit-packed grid kept in GPU memory that Backend::GPU steps, and the OpenCL kernel that steps it.
+ *      - The kernel is OpenCL C built for the device at runtime, so any OpenCL 1.2 GPU with 64 bit atomics
+ *        (cl_khr_int64_base_atomics) can run it and no device compiler is needed at build time.
+ *      - One work item computes one 64 cell word, with the same full-adder neighbour sums as the PACKED
+ *        kernel in world.cpp, so the two give identical results.
+ *      - Each work group counts its births and deaths in local memory and adds them to two global counters,
+ *        which are the only data read back after a step. The cells stay on the device until downloaded.
+ *      - The device, queue and built kernel are set up on first use and shared by every GpuGrid.
+ *
+ * Without GOL_OPENCL defined none of this is built: gpu_available() is false and making a GpuGrid
+ * with cells throws.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "gpu_kernel.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef GOL_OPENCL
+
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//the OpenCL C source of the kernel, one work item per word of the grid
+static const char *KERNEL_SOURCE = R"(
+#pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
+
+//the cells to the left of, at and to the right of every bit of word w of row y, all dead for a row beyond a bounded edge
+void shift_row(__global const ulong *grid, int y, int w, int words, int width, int toroidal,
+		ulong *left, ulong *centre, ulong *right) {
+	if (y < 0) {
+		*left = 0;
+		*centre = 0;
+		*right = 0;
+		return;
+	}
+	__global const ulong *row = grid + (size_t)y * words;
+	ulong word = row[w];
+	ulong leftIn = (w > 0) ? (row[w - 1] >> 63) : (toroidal ? ((row[words - 1] >> ((width - 1) % 64)) & 1) : 0);
+	ulong rightIn = (w < words - 1) ? (row[w + 1] << 63) : (toroidal ? ((row[0] & 1) << ((width - 1) % 64)) : 0);
+	*left = (word << 1) | leftIn;
+	*centre = word;
+	*right = (word >> 1) | rightIn;
+}
+
+void full_add(ulong a, ulong b, ulong c, ulong *sum, ulong *carry) {
+	ulong partial = a ^ b;
+	*sum = partial ^ c;
+	*carry = (a & b) | (partial & c);
+}
+
+__kernel void step_packed(__global const ulong *current, __global ulong *next, int width, int height, int words,
+		int toroidal, uint birth, uint survival, __global ulong *counts) {
+	int w = get_global_id(0);
+	int y = get_global_id(1);
+	int first = get_local_id(0) == 0 && get_local_id(1) == 0;
+
+	__local uint groupBirths, groupDeaths;
+	if (first) {
+		groupBirths = 0;
+		groupDeaths = 0;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	int above = (y > 0) ? y - 1 : (toroidal ? height - 1 : -1);
+	int below = (y < height - 1) ? y + 1 : (toroidal ? 0 : -1);
+	ulong aboveLeft, aboveCentre, aboveRight, middleLeft, middle, middleRight, belowLeft, belowCentre, belowRight;
+	shift_row(current, above, w, words, width, toroidal, &aboveLeft, &aboveCentre, &aboveRight);
+	shift_row(current, y, w, words, width, toroidal, &middleLeft, &middle, &middleRight);
+	shift_row(current, below, w, words, width, toroidal, &belowLeft, &belowCentre, &belowRight);
+
+	//sum the 8 neighbours of every bit into a 4 bit count, count[k] holding bit k, as count_word does
+	ulong above0, above1, below0, below1, carry1, twos, carry2, count[4];
+	full_add(aboveLeft, aboveCentre, aboveRight, &above0, &above1);
+	full_add(belowLeft, belowCentre, belowRight, &below0, &below1);
+	ulong side0 = middleLeft ^ middleRight;
+	ulong side1 = middleLeft & middleRight;
+	full_add(above0, below0, side0, &count[0], &carry1);
+	full_add(above1, below1, side1, &twos, &carry2);
+	count[1] = twos ^ carry1;
+	ulong fours = twos & carry1;
+	count[2] = carry2 ^ fours;
+	count[3] = carry2 & fours;
+
+	//select the cells whose count the rule allows, every work item takes the same branches
+	ulong result = 0;
+	for (int n = 0; n <= 8; n++) {
+		if (((birth | survival) >> n) & 1) {
+			ulong equal = ~(ulong)0;
+			for (int k = 0; k < 4; k++) {
+				equal &= ((n >> k) & 1) ? count[k] : ~count[k];
+			}
+			ulong keep = (((birth >> n) & 1) ? ~middle : 0) | (((survival >> n) & 1) ? middle : 0);
+			result |= equal & keep;
+		}
+	}
+	if (w == words - 1 && width % 64 != 0) {
+		//keep the padding bits dead
+		result &= (((ulong)1) << (width % 64)) - 1;
+	}
+	next[(size_t)y * words + w] = result;
+
+	atomic_add(&groupBirths, (uint)popcount(result & ~middle));
+	atomic_add(&groupDeaths, (uint)popcount(middle & ~result));
+	barrier(CLK_LOCAL_MEM_FENCE);
+	if (first) {
+		atom_add(&counts[0], (ulong)groupBirths);
+		atom_add(&counts[1], (ulong)groupDeaths);
+	}
+}
+)";
+
+//the device, its queue and the built kernel, shared by every GpuGrid and kept for the life of the process
+struct GpuContext {
+	cl_context context;
+	cl_command_queue queue;
+	cl_kernel kernel;
+	//the births and deaths of the last step
+	cl_mem counts;
+	std::string name;
+	//a kernel's arguments are shared state, so steps from different threads take turns
+	std::mutex mutex;
+};
+
+//helper function turning a failed OpenCL call into an exception
+static void check(cl_int status, const char *call) {
+	if (status != CL_SUCCESS) {
+		throw std::runtime_error(std::string("OpenCL call ") + call + " failed with error " + std::to_string(status) + ".\n");
+	}
+}
+
+//helper function looking for a GPU with 64 bit atomics and building the kernel for it, null when there is none
+static GpuContext* find_gpu() {
+	cl_uint platformCount = 0;
+	if (clGetPlatformIDs(0, nullptr, &platformCount) != CL_SUCCESS || platformCount == 0) {
+		return nullptr;
+	}
+	std::vector<cl_platform_id> platforms(platformCount);
+	clGetPlatformIDs(platformCount, platforms.data(), nullptr);
+
+	for (cl_platform_id platform : platforms) {
+		cl_device_id device;
+		if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, nullptr) != CL_SUCCESS) {
+			continue;
+		}
+		size_t length = 0;
+		clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, 0, nullptr, &length);
+		std::string extensions(length, '\0');
+		clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, length, &extensions[0], nullptr);
+		if (extensions.find("cl_khr_int64_base_atomics") == std::string::npos) {
+			continue;
+		}
+
+		cl_int status;
+		std::unique_ptr<GpuContext> gpu(new GpuContext());
+		gpu->context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &status);
+		check(status, "clCreateContext");
+		gpu->queue = clCreateCommandQueue(gpu->context, device, 0, &status);
+		check(status, "clCreateCommandQueue");
+		cl_program program = clCreateProgramWithSource(gpu->context, 1, &KERNEL_SOURCE, nullptr, &status);
+		check(status, "clCreateProgramWithSource");
+		if (clBuildProgram(program, 1, &device, "", nullptr, nullptr) != CL_SUCCESS) {
+			clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &length);
+			std::string log(length, '\0');
+			clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, length, &log[0], nullptr);
+			throw std::runtime_error("Failed to build the GPU kernel:\n" + log);
+		}
+		gpu->kernel = clCreateKernel(program, "step_packed", &status);
+		check(status, "clCreateKernel");
+		gpu->counts = clCreateBuffer(gpu->context, CL_MEM_READ_WRITE, 2 * sizeof(cl_ulong), nullptr, &status);
+		check(status, "clCreateBuffer");
+
+		clGetDeviceInfo(device, CL_DEVICE_NAME, 0, nullptr, &length);
+		gpu->name.assign(length, '\0');
+		clGetDeviceInfo(device, CL_DEVICE_NAME, length, &gpu->name[0], nullptr);
+		//the length counts the terminating null
+		gpu->name.resize(length > 0 ? length - 1 : 0);
+		return gpu.release();
+	}
+	return nullptr;
+}
+
+//helper function giving the GPU, set up on first use
+static GpuContext* gpu_context() {
+	static GpuContext *gpu = find_gpu();
+	return gpu;
+}
+
+//helper function giving the GPU, or throwing when there is none
+static GpuContext& require_gpu() {
+	GpuContext *gpu = gpu_context();
+	if (gpu == nullptr) {
+		throw std::runtime_error("No OpenCL GPU with 64 bit atomics was found.\n");
+	}
+	return *gpu;
+}
+
+//helper function allocating a device buffer with every cell dead
+static cl_mem device_allocate(size_t bytes) {
+	GpuContext &gpu = require_gpu();
+	cl_int status;
+	cl_mem buffer = clCreateBuffer(gpu.context, CL_MEM_READ_WRITE, bytes, nullptr, &status);
+	check(status, "clCreateBuffer");
+	cl_ulong dead = 0;
+	check(clEnqueueFillBuffer(gpu.queue, buffer, &dead, sizeof(dead), 0, bytes, 0, nullptr, nullptr), "clEnqueueFillBuffer");
+	return buffer;
+}
+
+static void device_release(cl_mem buffer) {
+	clReleaseMemObject(buffer);
+}
+
+static void device_copy(cl_mem source, cl_mem target, size_t bytes) {
+	check(clEnqueueCopyBuffer(require_gpu().queue, source, target, 0, 0, bytes, 0, nullptr, nullptr), "clEnqueueCopyBuffer");
+}
+
+static void device_upload(const uint64_t *words, cl_mem target, size_t bytes) {
+	check(clEnqueueWriteBuffer(require_gpu().queue, target, CL_TRUE, 0, bytes, words, 0, nullptr, nullptr), "clEnqueueWriteBuffer");
+}
+
+static void device_download(cl_mem source, uint64_t *words, size_t bytes) {
+	check(clEnqueueReadBuffer(require_gpu().queue, source, CL_TRUE, 0, bytes, words, 0, nullptr, nullptr), "clEnqueueReadBuffer");
+}
+
+//helper function running the kernel over every word, then reading back the step's births and deaths
+static void device_step(cl_mem current, cl_mem next, int width, int height, int words, bool toroidal,
+		const Rule &rule, long long &births, long long &deaths) {
+	GpuContext &gpu = require_gpu();
+	std::lock_guard<std::mutex> lock(gpu.mutex);
+
+	cl_int wrap = toroidal;
+	cl_uint birth = rule.birth, survival = rule.survival;
+	check(clSetKernelArg(gpu.kernel, 0, sizeof(cl_mem), &current), "clSetKernelArg");
+	check(clSetKernelArg(gpu.kernel, 1, sizeof(cl_mem), &next), "clSetKernelArg");
+	check(clSetKernelArg(gpu.kernel, 2, sizeof(cl_int), &width), "clSetKernelArg");
+	check(clSetKernelArg(gpu.kernel, 3, sizeof(cl_int), &height), "clSetKernelArg");
+	check(clSetKernelArg(gpu.kernel, 4, sizeof(cl_int), &words), "clSetKernelArg");
+	check(clSetKernelArg(gpu.kernel, 5, sizeof(cl_int), &wrap), "clSetKernelArg");
+	check(clSetKernelArg(gpu.kernel, 6, sizeof(cl_uint), &birth), "clSetKernelArg");
+	check(clSetKernelArg(gpu.kernel, 7, sizeof(cl_uint), &survival), "clSetKernelArg");
+	check(clSetKernelArg(gpu.kernel, 8, sizeof(cl_mem), &gpu.counts), "clSetKernelArg");
+
+	cl_ulong counts[2] = {0, 0};
+	check(clEnqueueFillBuffer(gpu.queue, gpu.counts, &counts[0], sizeof(cl_ulong), 0, sizeof(counts), 0, nullptr, nullptr),
+			"clEnqueueFillBuffer");
+	size_t global[2] = {(size_t)words, (size_t)height};
+	check(clEnqueueNDRangeKernel(gpu.queue, gpu.kernel, 2, nullptr, global, nullptr, 0, nullptr, nullptr),
+			"clEnqueueNDRangeKernel");
+	//the in-order queue finishes the step before the counts are read, 16 bytes are all that come back
+	check(clEnqueueReadBuffer(gpu.queue, gpu.counts, CL_TRUE, 0, sizeof(counts), counts, 0, nullptr, nullptr),
+			"clEnqueueReadBuffer");
+	births += counts[0];
+	deaths += counts[1];
+}
+
+#else
+
+static const char *NO_GPU = "Built without GPU support, define GOL_OPENCL and link OpenCL to use Backend::GPU.\n";
+
+//without OpenCL there is never a device buffer to act on, so only allocating can be reached
+static cl_mem device_allocate(size_t) {
+	throw std::runtime_error(NO_GPU);
+}
+
+static void device_release(cl_mem) {}
+
+static void device_copy(cl_mem, cl_mem, size_t) {
+	throw std::runtime_error(NO_GPU);
+}
+
+static void device_upload(const uint64_t *, cl_mem, size_t) {
+	throw std::runtime_error(NO_GPU);
+}
+
+static void device_download(cl_mem, uint64_t *, size_t) {
+	throw std::runtime_error(NO_GPU);
+}
+
+static void device_step(cl_mem, cl_mem, int, int, int, bool, const Rule &, long long &, long long &) {
+	throw std::runtime_error(NO_GPU);
+}
+
+#endif
+
+/**
+ * gpu_available()
+ *
+ * @return
+ *      True if the GPU backend was built and an OpenCL GPU with 64 bit atomics was found.
+ *      The first call sets up the device and builds the kernel.
+ */
+bool gpu_available() {
+#ifdef GOL_OPENCL
+	return gpu_context() != nullptr;
+#else
+	return false;
+#endif
+}
+
+/**
+ * gpu_device_name()
+ *
+ * @return
+ *      The name of the GPU, or "none" if there is none.
+ */
+const char* gpu_device_name() {
+#ifdef GOL_OPENCL
+	return gpu_available() ? gpu_context()->name.c_str() : "none";
+#else
+	return "none";
+#endif
+}
+
+/**
+ * GpuGrid::GpuGrid()
+ *
+ * Construct an empty grid of size 0x0, which needs no GPU.
+ */
+GpuGrid::GpuGrid() : width(0), height(0), wordsPerRow(0), buffer(nullptr) {}
+
+/**
+ * GpuGrid::GpuGrid(width, height)
+ *
+ * Construct a grid in device memory with every cell dead.
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @throws
+ *      std::exception or sub-class if the grid has cells and there is no GPU.
+ */
+GpuGrid::GpuGrid(int width, int height) : width(width), height(height), wordsPerRow((width + 63) / 64), buffer(nullptr) {
+	if (width > 0 && height > 0) {
+		this->buffer = device_allocate((size_t)this->wordsPerRow * height * sizeof(uint64_t));
+	}
+}
+
+/**
+ * GpuGrid::GpuGrid(grid)
+ *
+ * Construct a grid in device memory holding a copy of a packed grid's cells.
+ *
+ * @param grid
+ *      The cells to upload.
+ *
+ * @throws
+ *      std::exception or sub-class if the grid has cells and there is no GPU.
+ */
+GpuGrid::GpuGrid(const BitGrid &grid) : GpuGrid(grid.get_width(), grid.get_height()) {
+	if (this->buffer != nullptr) {
+		device_upload(grid.row(0), this->buffer, (size_t)this->wordsPerRow * this->height * sizeof(uint64_t));
+	}
+}
+
+/**
+ * GpuGrid::~GpuGrid()
+ *
+ * Frees the grid's device memory.
+ */
+GpuGrid::~GpuGrid() {
+	if (this->buffer != nullptr) {
+		device_release(this->buffer);
+	}
+}
+
+/**
+ * GpuGrid::GpuGrid(other)
+ *
+ * Construct a copy of another grid, copying the cells on the device without a trip through the host.
+ */
+GpuGrid::GpuGrid(const GpuGrid &other) : GpuGrid(other.width, other.height) {
+	if (this->buffer != nullptr) {
+		device_copy(other.buffer, this->buffer, (size_t)this->wordsPerRow * this->height * sizeof(uint64_t));
+	}
+}
+
+/**
+ * GpuGrid::GpuGrid(other)
+ *
+ * Construct a grid taking over another grid's device memory, leaving the other grid empty.
+ */
+GpuGrid::GpuGrid(GpuGrid &&other) : width(other.width), height(other.height), wordsPerRow(other.wordsPerRow),
+		buffer(other.buffer) {
+	other.width = 0;
+	other.height = 0;
+	other.wordsPerRow = 0;
+	other.buffer = nullptr;
+}
+
+/**
+ * GpuGrid::operator=(other)
+ *
+ * Replace this grid with a copy of another grid.
+ */
+GpuGrid& GpuGrid::operator=(const GpuGrid &other) {
+	if (this != &other) {
+		*this = GpuGrid(other);
+	}
+	return *this;
+}
+
+/**
+ * GpuGrid::operator=(other)
+ *
+ * Replace this grid by swapping in another grid's device memory, so swapping two grids never copies cells.
+ */
+GpuGrid& GpuGrid::operator=(GpuGrid &&other) {
+	std::swap(this->width, other.width);
+	std::swap(this->height, other.height);
+	std::swap(this->wordsPerRow, other.wordsPerRow);
+	std::swap(this->buffer, other.buffer);
+	return *this;
+}
+
+/**
+ * GpuGrid::get_width()
+ *
+ * @return
+ *      The width of the grid.
+ */
+int GpuGrid::get_width() const {
+	return this->width;
+}
+
+/**
+ * GpuGrid::get_height()
+ *
+ * @return
+ *      The height of the grid.
+ */
+int GpuGrid::get_height() const {
+	return this->height;
+}
+
+/**
+ * GpuGrid::get_words_per_row()
+ *
+ * @return
+ *      The number of 64 cell words in each row.
+ */
+int GpuGrid::get_words_per_row() const {
+	return this->wordsPerRow;
+}
+
+/**
+ * GpuGrid::download(grid)
+ *
+ * Copy the cells back from the device into a packed grid of the same size.
+ *
+ * @param grid
+ *      The packed grid to overwrite.
+ *
+ * @throws
+ *      std::exception or sub-class if the packed grid is a different size.
+ */
+void GpuGrid::download(BitGrid &grid) const {
+	if (grid.get_width() != this->width || grid.get_height() != this->height) {
+		throw std::invalid_argument("Packed grid is a different size to the GPU grid.\n");
+	}
+	if (this->buffer != nullptr) {
+		device_download(this->buffer, grid.row(0), (size_t)this->wordsPerRow * this->height * sizeof(uint64_t));
+	}
+}
+
+/**
+ * GpuGrid::step(rule, toroidal, next, births, deaths)
+ *
+ * Apply a Life-like rule to every cell on the device, writing the next generation into another grid.
+ * Only the counts of cells born and died come back to the host.
+ *
+ * @param rule
+ *      The rule to step with.
+ *
+ * @param toroidal
+ *      If true then the grid wraps at its edges, otherwise it is dead beyond them.
+ *
+ * @param next
+ *      The grid to write the next generation to, the same size as this one.
+ *
+ * @param births
+ *      Has the number of cells born added to it.
+ *
+ * @param deaths
+ *      Has the number of cells died added to it.
+ *
+ * @throws
+ *      std::exception or sub-class if next is a different size, or a call to the GPU fails.
+ */
+void GpuGrid::step(const Rule &rule, bool toroidal, GpuGrid &next, long long &births, long long &deaths) const {
+	if (next.width != this->width || next.height != this->height) {
+		throw std::invalid_argument("Next GPU grid is a different size.\n");
+	}
+	if (this->buffer != nullptr) {
+		device_step(this->buffer, next.buffer, this->width, this->height, this->wordsPerRow, toroidal, rule, births, deaths);
+	}
+}
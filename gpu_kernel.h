@@ -0,0 +1,50 @@
+/**
+ * Declares the bit-packed grid kept in GPU memory that Backend::GPU steps, and the OpenCL kernel that steps it.
+ * Rich documentation for the api and behaviour of the GPU backend can be found in gpu_kernel.cpp.
+ *
+ * Define GOL_OPENCL and link OpenCL (-lOpenCL) to build the GPU backend, otherwise gpu_available() is false.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include "bitgrid.h"
+#include "rule.h"
+
+//the OpenCL buffer handle, declared as cl.h does so that only gpu_kernel.cpp needs the OpenCL headers
+typedef struct _cl_mem *cl_mem;
+
+bool gpu_available();
+const char* gpu_device_name();
+
+/**
+ * Declare the structure of the GpuGrid class.
+ *
+ * A GpuGrid holds cells in device memory in the BitGrid layout: rows of 64 cell words, padding bits dead.
+ * Like BitGrid it is a value, copying one copies its cells on the device.
+ */
+class GpuGrid {
+public:
+	GpuGrid();
+	GpuGrid(int width, int height);
+	explicit GpuGrid(const BitGrid &grid);
+	~GpuGrid();
+
+	GpuGrid(const GpuGrid &other);
+	GpuGrid(GpuGrid &&other);
+	GpuGrid& operator=(const GpuGrid &other);
+	GpuGrid& operator=(GpuGrid &&other);
+
+	int get_width() const;
+	int get_height() const;
+	int get_words_per_row() const;
+
+	void download(BitGrid &grid) const;
+	void step(const Rule &rule, bool toroidal, GpuGrid &next, long long &births, long long &deaths) const;
+
+private:
+	int width, height, wordsPerRow;
+	//null for a grid with no cells
+	cl_mem buffer;
+};
@@ -13,6 +13,11 @@
  */
 
 #include "grid.h"
+#include "grid_view.h"
+#include "renderer.h"
+
+#include <algorithm>
+#include <stdexcept>
 
 /**
  * Grid::Grid()
@@ -74,8 +79,9 @@ Grid::Grid(int square_size) : Grid(square_size,square_size) {}
 Grid::Grid(int width, int height) {
 	this->width = width;
 	this->height = height;
-	//storing grid as a 2d vector of Cells
-	this->grid = std::vector<std::vector<Cell>>(width,std::vector<Cell>(height, DEAD));
+	this->halo = 0;
+	//storing grid as one contiguous row-major block of Cells
+	this->grid = std::vector<Cell, GridAllocator<Cell>>(width * height, DEAD);
 }
 
 
@@ -187,18 +193,42 @@ int Grid::get_total_cells() const {
  *      The number of alive cells.
  */
 int Grid::get_alive_cells() const {
-	int counter = 0;
-	//loop through cells count alive
-	for (int x = 0; x < this->get_width(); x++) {
-		for (int y = 0; y < this->get_height(); y++) {
-			if (this->grid[x][y] == ALIVE) {
-				counter++;
-			}
-		}
+	if (this->halo == 0) {
+		//walk the contiguous buffer counting alive cells
+		return (int)std::count(this->grid.begin(), this->grid.end(), ALIVE);
 	}
-	return counter;
+	return this->get_alive_cells(ExecutionPolicy::sequential());
  }
 
+/**
+ * Grid::get_alive_cells(policy)
+ *
+ * Counts how many cells in the grid are alive, with each band of rows counted separately under the policy
+ * and the counts added up afterwards. The count is the same for every policy.
+ *
+ * @example
+ *
+ *      // Count the alive cells of a huge board on every core
+ *      std::cout << board.get_alive_cells(ExecutionPolicy::parallel()) << std::endl;
+ *
+ * @param policy
+ *      Whether to count serially or in parallel.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+int Grid::get_alive_cells(const ExecutionPolicy &policy) const {
+	//skip the halo, which can hold copies of cells from the opposite edges
+	return (int)policy.sum_bands(this->get_height(), this->get_width(), [this](int y0, int y1) {
+		long long alive = 0;
+		for (int y = y0; y < y1; y++) {
+			const Cell *cells = this->row(y);
+			alive += std::count(cells, cells + this->get_width(), ALIVE);
+		}
+		return alive;
+	});
+}
+
 
 /**
  * Grid::get_dead_cells()
@@ -224,17 +254,27 @@ int Grid::get_alive_cells() const {
  *      The number of dead cells.
  */
  int Grid::get_dead_cells() const {
- 	int counter = 0;
-	//loop through cells counts dead
- 	for (int x = 0; x < this->get_width(); x++) {
- 		for (int y = 0; y < this->get_height(); y++) {
- 			if (this->grid[x][y] == DEAD) {
- 				counter++;
- 			}
- 		}
- 	}
-
-	return counter;
+	if (this->halo == 0) {
+		//walk the contiguous buffer counting dead cells
+		return (int)std::count(this->grid.begin(), this->grid.end(), DEAD);
+	}
+
+	return this->get_total_cells() - this->get_alive_cells();
+}
+
+/**
+ * Grid::get_dead_cells(policy)
+ *
+ * Counts how many cells in the grid are dead, counting the alive cells under the policy.
+ *
+ * @param policy
+ *      Whether to count serially or in parallel.
+ *
+ * @return
+ *      The number of dead cells.
+ */
+int Grid::get_dead_cells(const ExecutionPolicy &policy) const {
+	return this->get_total_cells() - this->get_alive_cells(policy);
 }
 
 
@@ -281,24 +321,24 @@ void Grid::resize(int square_size) {
  *      The new height for the grid.
  */
 void Grid::resize(int width, int height) {
-	//creates temp grid of size parameter and sets all cells to dead.
-	std::vector<std::vector<Cell>> gridTemp(width, std::vector<Cell>(height, DEAD));
+	//creates a temp buffer of the new size, with the same halo, and sets all cells to dead.
+	int stride = width + 2 * this->halo;
+	std::vector<Cell, GridAllocator<Cell>> gridTemp(stride * (height + 2 * this->halo), DEAD);
 
 	//figure out where to stop copying from old grid.
 	int stopWidth = std::min(width, this->get_width());
 	int stopHeight = std::min(height, this->get_height());
 
-	this->width = width;
-	this->height = height;
-
-	for (int x = 0; x < stopWidth; x++) {
-		for (int y = 0; y < stopHeight; y++) {
-			//copies original grid to new grid.
-			gridTemp[x][y] = this->grid[x][y];
-		}
+	for (int y = 0; y < stopHeight; y++) {
+		//copies each kept row segment of the original grid to the new buffer, past its halo.
+		const Cell *source = this->row(y);
+		std::copy(source, source + stopWidth, gridTemp.data() + (y + this->halo) * stride + this->halo);
 	}
 
-	this->grid = gridTemp;
+	this->width = width;
+	this->height = height;
+	//the old buffer goes back to the GridPool for the next temporary of its size
+	this->grid.swap(gridTemp);
 }
 
 
@@ -318,7 +358,198 @@ void Grid::resize(int width, int height) {
  * @return
  *      The 1d offset from the start of the data array where the desired cell is located.
  */
-// NOTE: Not applicable
+unsigned int Grid::get_index(unsigned int x, unsigned int y) const {
+	//cells are stored row-major, so a row is a contiguous run of (stride) cells, offset past the halo
+	return ((y + this->halo) * this->get_stride()) + x + this->halo;
+}
+
+
+/**
+ * Grid::get_stride()
+ *
+ * Gets the distance, in cells, between the start of one row and the start of the next
+ * in the underlying storage. Use together with Grid::row(y) to walk the grid without
+ * any per-cell function calls.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The row pitch of the grid in cells.
+ */
+int Grid::get_stride() const {
+	return this->width + 2 * this->halo;
+}
+
+
+/**
+ * Grid::get_halo()
+ *
+ * Gets the number of cells of padding stored around each edge of the grid, 0 unless set with Grid::set_halo.
+ * The function should be callable from a constant context.
+ *
+ * @return
+ *      The width of the halo in cells.
+ */
+int Grid::get_halo() const {
+	return this->halo;
+}
+
+
+/**
+ * Grid::set_halo(halo)
+ *
+ * Stores halo cells of padding around each edge of the grid, keeping the values of the grid's own cells.
+ * The halo starts out dead and is not part of the grid: the width, height and cell counts are unchanged,
+ * and Grid::get(x, y) and friends still only accept coordinates within the grid.
+ *
+ * A kernel with a halo can read the neighbours of any cell by offsetting a pointer from Grid::row(y),
+ * using Grid::get_stride() to move between rows, without checking for the edges of the grid.
+ *
+ * @example
+ *
+ *      // Make a grid with a one cell halo
+ *      Grid grid(4, 4);
+ *      grid.set_halo(1);
+ *
+ *      // The cell left of (0, 0) can now be read safely
+ *      Cell left = grid.row(0)[-1];
+ *
+ * @param halo
+ *      The width of the halo in cells.
+ *
+ * @throws
+ *      std::exception or sub-class if halo is negative.
+ */
+void Grid::set_halo(int halo) {
+	if (halo < 0) {
+		throw std::invalid_argument("Halo cannot be negative.\n");
+	}
+	if (halo == this->halo) {
+		return;
+	}
+
+	std::vector<Cell, GridAllocator<Cell>> gridTemp((this->width + 2 * halo) * (this->height + 2 * halo), DEAD);
+	for (int y = 0; y < this->get_height(); y++) {
+		//copies each row past the new halo
+		const Cell *source = this->row(y);
+		std::copy(source, source + this->get_width(), gridTemp.data() + ((y + halo) * (this->width + 2 * halo)) + halo);
+	}
+
+	this->halo = halo;
+	this->grid.swap(gridTemp);
+}
+
+
+/**
+ * Grid::refresh_halo(toroidal)
+ *
+ * Fills the halo from the grid's cells, so that it reads as the grid's surroundings.
+ * Writing to the grid after a refresh leaves the halo stale until the next refresh.
+ *
+ * If toroidal = false then the halo is set dead, as the grid is considered dead outside its bounds.
+ *
+ * If toroidal = true then the halo holds the cells from the opposite edges, corners included,
+ * so a read off the left edge sees the right edge and a read off the top sees the bottom.
+ *
+ * @param toroidal
+ *      If true then the halo wraps to the opposite sides of the grid, otherwise it is dead.
+ *
+ * @throws
+ *      std::exception or sub-class if toroidal = true and the grid is smaller than its halo,
+ *      as there are not enough cells to wrap. An empty grid has nothing to wrap and is left as is.
+ */
+void Grid::refresh_halo(bool toroidal) {
+	int width = this->get_width();
+	int height = this->get_height();
+	int halo = this->halo;
+	int stride = this->get_stride();
+	if (halo == 0 || width == 0 || height == 0) {
+		return;
+	}
+
+	if (toroidal == false) {
+		//top and bottom bands, then the left and right ends of each row
+		std::fill(this->grid.begin(), this->grid.begin() + halo * stride, DEAD);
+		std::fill(this->grid.end() - halo * stride, this->grid.end(), DEAD);
+		for (int y = 0; y < height; y++) {
+			Cell *cells = this->row(y);
+			std::fill(cells - halo, cells, DEAD);
+			std::fill(cells + width, cells + width + halo, DEAD);
+		}
+		return;
+	}
+
+	if (width < halo || height < halo) {
+		throw std::invalid_argument("Grid is too small to wrap its halo.\n");
+	}
+
+	//wrap the left and right ends of each row first, so the rows copied into the top and bottom carry the corners
+	for (int y = 0; y < height; y++) {
+		Cell *cells = this->row(y);
+		std::copy(cells + width - halo, cells + width, cells - halo);
+		std::copy(cells, cells + halo, cells + width);
+	}
+	Cell *top = this->grid.data();
+	std::copy(top + height * stride, top + (height + halo) * stride, top);
+	std::copy(top + halo * stride, top + 2 * halo * stride, top + (height + halo) * stride);
+}
+
+
+/**
+ * Grid::row(y)
+ *
+ * Gets a pointer to the first cell of a row. The row is contiguous in memory and holds
+ * Grid::get_width() cells, so kernels can stream a whole row without invoking
+ * Grid::get(x, y) for each cell.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid grid(4, 4);
+ *
+ *      // Bring the second row to life in one pass
+ *      Cell *cells = grid.row(1);
+ *      std::fill(cells, cells + grid.get_width(), Cell::ALIVE);
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A modifiable pointer to the first cell of the row.
+ *
+ * @throws
+ *      std::exception or sub-class if y is not a valid row within the grid.
+ */
+Cell* Grid::row(unsigned int y) {
+	if (y >= (unsigned int)this->get_height()) {
+		throw std::invalid_argument("Invalid grid row.\n");
+	}
+
+	return this->grid.data() + this->get_index(0, y);
+}
+
+
+/**
+ * Grid::row(y)
+ *
+ * Gets a read-only pointer to the first cell of a row.
+ * The function should be callable from a constant context.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A read-only pointer to the first cell of the row.
+ *
+ * @throws
+ *      std::exception or sub-class if y is not a valid row within the grid.
+ */
+const Cell* Grid::row(unsigned int y) const {
+	if (y >= (unsigned int)this->get_height()) {
+		throw std::invalid_argument("Invalid grid row.\n");
+	}
+
+	return this->grid.data() + this->get_index(0, y);
+}
 
 
 /**
@@ -351,11 +582,11 @@ void Grid::resize(int width, int height) {
  */
 const Cell Grid::get(unsigned int x, unsigned int y) const {
 	//catches invalid coordinates
-	if (x >= this->grid.size() || y >= this->grid[0].size()) {
+	if (x >= (unsigned int)this->get_width() || y >= (unsigned int)this->get_height()) {
 		throw std::invalid_argument("Invalid grid location.\n");
 	}
 
-	return this->grid[x][y];
+	return (*this)(x, y);
 }
 
 
@@ -386,11 +617,11 @@ const Cell Grid::get(unsigned int x, unsigned int y) const {
  *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
  */
 void Grid::set(unsigned int x, unsigned int y, Cell value) {
-	if (x >= this->grid.size() || y >= this->grid[0].size()) {
+	if (x >= (unsigned int)this->get_width() || y >= (unsigned int)this->get_height()) {
 		throw std::invalid_argument("Invalid grid location.\n");
 	}
 
-	this->grid[x][y] = value;
+	(*this)(x, y) = value;
 }
 
 
@@ -430,11 +661,11 @@ void Grid::set(unsigned int x, unsigned int y, Cell value) {
  *      std::runtime_error or sub-class if x,y is not a valid coordinate within the grid.
  */
 Cell& Grid::operator()(unsigned int x, unsigned int y) {
-	if (x >= this->grid.size() || y >= this->grid[0].size()) {
+	if (x >= (unsigned int)this->get_width() || y >= (unsigned int)this->get_height()) {
 		throw std::invalid_argument("Invalid grid location.\n");
 	}
 
-	return this->grid[x][y];
+	return this->grid[this->get_index(x, y)];
 }
 
 
@@ -469,11 +700,11 @@ Cell& Grid::operator()(unsigned int x, unsigned int y) {
  *      std::exception or sub-class if x,y is not a valid coordinate within the grid.
  */
 const Cell& Grid::operator()(unsigned int x, unsigned int y) const {
-	if (x >= this->grid.size() || y >= this->grid[0].size()) {
+	if (x >= (unsigned int)this->get_width() || y >= (unsigned int)this->get_height()) {
 		throw std::invalid_argument("Invalid grid location.\n");
 	}
 
-	return this->grid[x][y];
+	return this->grid[this->get_index(x, y)];
 }
 
 
@@ -513,32 +744,32 @@ const Cell& Grid::operator()(unsigned int x, unsigned int y) const {
  */
 
 Grid Grid::crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const {
-	if (x0 > this->get_width() ||  y0 > this->get_height() || x1 >  this->get_width()||  y1 >  this->get_height()) {
-		throw std::invalid_argument("Coordinates outside of grid bounds.\n");
-	}
-	if(x0 < 0 || x1 < 0 || y0 < 0 || y1 < 0) {
-		throw std::invalid_argument("Coordinates outside of grid bounds.\n");
-	}
-
-	if (x0 > x1) {
-		throw std::invalid_argument("x0 cannot be greater than x1.\n");
-	}
-
-	if (y0 > y1) {
-		throw std::invalid_argument("y0 cannot be greater than y1.\n");
-	}
-	//creates a new grid with the desired size of cropped grid
-	Grid croppedGrid(x1-x0, y1-y0);
-
-	for (unsigned int x = x0; x < x1; x++) {
-		for (unsigned int y = y0; y < y1; y++) {
-			//loop through cropped grid setting values of old grid
-			croppedGrid(x - x0, y - y0) = this->grid[x][y];
-		}
-	}
-
-	return croppedGrid;
+	//the view checks the window, then its rows are copied out span by span
+	return GridView(*this).crop(x0, y0, x1, y1).to_grid();
+}
 
+/**
+ * Grid::crop(x0, y0, x1, y1, policy)
+ *
+ * Extract a sub-grid from a Grid as with Grid::crop(x0, y0, x1, y1), copying bands of rows under the policy.
+ *
+ * @example
+ *
+ *      // Cut a quarter out of a huge board on every core
+ *      Grid corner = board.crop(0, 0, 16384, 16384, ExecutionPolicy::parallel());
+ *
+ * @param policy
+ *      Whether to copy serially or in parallel.
+ *
+ * @return
+ *      A new grid of the cropped size containing the values extracted from the original grid.
+ *
+ * @throws
+ *      std::exception or sub-class if x0,y0 or x1,y1 are not valid coordinates within the grid
+ *      or if the crop window has a negative size.
+ */
+Grid Grid::crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, const ExecutionPolicy &policy) const {
+	return GridView(*this).crop(x0, y0, x1, y1).to_grid(policy);
 }
 
 
@@ -580,7 +811,59 @@ Grid Grid::crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int
  *      std::exception or sub-class if the other grid being placed does not fit within the bounds of the current grid.
  */
 
-void Grid::merge(Grid other,  int x0, int y0, bool alive_only) {
+void Grid::merge(const Grid &other, int x0, int y0, bool alive_only) {
+	this->merge(GridView(other), x0, y0, alive_only);
+}
+
+/**
+ * Grid::merge(other, x0, y0, alive_only = false)
+ *
+ * Merge a view of a grid into the current grid, as with merging a grid. The view can be cropped,
+ * rotated or transposed, so a region or orientation of a pattern is placed without copying it out first.
+ *
+ * @example
+ *
+ *      // Overlay a glider turned a quarter turn at 8,8 without making a rotated copy
+ *      Grid glider = Zoo::glider();
+ *      board.merge(GridView(glider).rotate(1), 8, 8, true);
+ *
+ * @param other
+ *      The view to merge into the current grid. A view of the current grid itself is copied first.
+ *
+ * @param x0
+ *      The x coordinate of where to place the top left corner of the view.
+ *
+ * @param y0
+ *      The y coordinate of where to place the top left corner of the view.
+ *
+ * @param alive_only
+ *      Optional parameter. If true then merging only sets alive cells to alive. Defaults to false.
+ *
+ * @throws
+ *      std::exception or sub-class if the view being placed does not fit within the bounds of the current grid.
+ */
+void Grid::merge(const GridView &other, int x0, int y0, bool alive_only) {
+	this->merge(other, x0, y0, alive_only, ExecutionPolicy::sequential());
+}
+
+/**
+ * Grid::merge(other, x0, y0, alive_only, policy)
+ *
+ * Merge a view of a grid into the current grid as with Grid::merge(other, x0, y0, alive_only),
+ * overlaying bands of rows under the policy. Each band writes only its own rows, so the result is the same for every policy.
+ *
+ * @example
+ *
+ *      // Stamp a huge pattern onto a huge board on every core
+ *      board.merge(GridView(pattern), 0, 0, true, ExecutionPolicy::parallel());
+ *
+ * @param policy
+ *      Whether to merge serially or in parallel.
+ *
+ * @throws
+ *      std::exception or sub-class if the view being placed does not fit within the bounds of the current grid.
+ */
+void Grid::merge(const GridView &other, int x0, int y0, bool alive_only, const ExecutionPolicy &policy) {
 
 	if (x0<0 || y0 < 0) {
 		throw std::invalid_argument("x0 and y0 must be greater than 0.\n");
@@ -590,24 +873,41 @@ void Grid::merge(Grid other,  int x0, int y0, bool alive_only) {
 		throw std::invalid_argument("Other grid being placed does not fit within the bounds of the current grid.\n");
 	}
 
-	if (alive_only == true) {
-		//merge grid from beginning of other grid
-		for (unsigned int x = x0; x < other.get_width() + x0; x++) {
-			for (unsigned int y = y0; y < other.get_height() + y0; y++) {
-				//does not overwrite alive cells in old grid
-				if (this->grid[x][y] == DEAD) {
-					this->grid[x][y] = other.grid[x - x0][y - y0];
+	if (other.views(*this)) {
+		//the region read could overlap the region written
+		Grid copy = other.to_grid(policy);
+		this->merge(GridView(copy), x0, y0, alive_only, policy);
+		return;
+	}
+
+	policy.for_bands(other.get_height(), other.get_width(), 1, [&](int band0, int band1) {
+		for (int y = band0; y < band1; y++) {
+			Cell *target = this->row(y + y0) + x0;
+
+			if (other.is_contiguous()) {
+				const Cell *source = other.row(y);
+				if (alive_only == true) {
+					//does not overwrite alive cells in old grid
+					for (int x = 0; x < other.get_width(); x++) {
+						if (target[x] == DEAD) {
+							target[x] = source[x];
+						}
+					}
+				} else {
+					//overwrites all values in the row span
+					std::copy(source, source + other.get_width(), target);
 				}
+				continue;
 			}
-		}
-	} else {
-		for (unsigned int x = x0; x < other.get_width() + x0; x++) {
-			for (unsigned int y = y0; y < other.get_height() + y0; y++) {
-					//overwrites all values
-					this->grid[x][y] = other.grid[x - x0][y - y0];
+
+			//a rotated or transposed view is read a cell at a time
+			for (int x = 0; x < other.get_width(); x++) {
+				if (alive_only == false || target[x] == DEAD) {
+					target[x] = other(x, y);
+				}
 			}
 		}
-	}
+	});
 
 }
 
@@ -633,56 +933,52 @@ void Grid::merge(Grid other,  int x0, int y0, bool alive_only) {
  * @return
  *      Returns a copy of the grid that has been rotated.
  */
-// Grid Grid::rotate(int rotation) const {
-// 	Grid tempGrid;
-// 	if (rotation = 0) {
-// 		printf("0");
-// 	} else if (rotation > 0) {
-// 		for (int i = 0; i < rotation; i++) {
-// 			Grid iterGrid;
-// 			if (i % 2 != 0) {
-// 				iterGrid = Grid(this->get_height(), this->get_width());
-// 			} else {
-// 				iterGrid = Grid(this->get_width(), this->get_height());
-// 			}
-//
-// 			for (int x = 0; x < this->get_width(); x++) {
-// 				for (int y = 0; y < this->get_height(); y++) {
-// 					printf("(%d, %d) -> (%d, %d)\n", x, y, tempGrid.get_width() - 1 - y, x);
-// 					iterGrid(iterGrid.get_width() - y, x) = this->get(x, y);
-// 				}
-// 			}
-// 		}
-// 	}
-// return tempGrid;
-// }
-// Grid Grid::rotate(int rotation) const {
-// 	Grid tempGrid = * this;
-// 	if (rotation <= 0) {
-// 		return *this;
-// 	}
-// 	Grid iterGrid;
-//
-//
-// 	for (int i = 0; i < rotation; i++) {
-//
-// 		if (i % 2 != 0) {
-// 			iterGrid = Grid(this->get_height(), this->get_width());
-// 		} else {
-// 			iterGrid = Grid(this->get_width(), this->get_height());
-// 		}
-//
-//
-// 		for (int x = 0; x < iterGrid.get_width(); x++) {
-// 			for (int y = 0; y < iterGrid.get_height(); y++) {
-// 				iterGrid(x,y) = tempGrid.get(y, tempGrid.get_width() );
-// 			}
-// 		}
-//
-// 		tempGrid = iterGrid;
-// 	}
-// 	return tempGrid;
-// }
+Grid Grid::rotate(int rotation) const & {
+	//the rotated view maps each cell to its place, which is then copied out
+	return GridView(*this).rotate(rotation).to_grid();
+}
+
+/**
+ * Grid::rotate(rotation)
+ *
+ * Rotate a temporary grid by a multiple of 90 degrees, as with rotating a grid.
+ * A whole or half turn keeps the same shape, so it reuses the temporary's cell buffer rather than allocating.
+ *
+ * @example
+ *
+ *      // The loaded grid is turned in place and moved into the result
+ *      Grid upsideDown = Zoo::load("path/to/file.gol").rotate(2);
+ *
+ * @param rotation
+ *      An positive or negative integer to rotate by in 90 intervals.
+ *
+ * @return
+ *      Returns the rotated grid.
+ */
+Grid Grid::rotate(int rotation) && {
+	int turns = ((rotation % 4) + 4) % 4;
+	int width = this->get_width();
+	int height = this->get_height();
+
+	if (turns % 2 == 1) {
+		return GridView(*this).rotate(rotation).to_grid();
+	}
+
+	if (turns == 2) {
+		//a half turn reverses every row and the order of the rows
+		for (int y = 0; y < (height + 1) / 2; y++) {
+			Cell *top = this->row(y);
+			Cell *bottom = this->row(height - 1 - y);
+			std::reverse(top, top + width);
+			if (top != bottom) {
+				std::reverse(bottom, bottom + width);
+				std::swap_ranges(top, top + width, bottom);
+			}
+		}
+	}
+
+	return std::move(*this);
+}
 
 /**
  * operator<<(output_stream, grid)
@@ -692,6 +988,8 @@ void Grid::merge(Grid other,  int x0, int y0, bool alive_only) {
  * Alive cells are shown as # (hash) characters, dead cells with ' ' (space) characters.
  *
  * The function should be callable on a constant Grid.
+ * Each call draws into a new Renderer, so it allocates a frame buffer every time. To print every step,
+ * keep one Renderer and call Renderer::print instead, which reuses its buffer.
  *
  * @example
  *
@@ -720,35 +1018,9 @@ void Grid::merge(Grid other,  int x0, int y0, bool alive_only) {
  *      Returns a reference to the output stream to enable operator chaining.
  */
 
- std::ostream& operator<<(std::ostream& output_stream, Grid grid) {
-	 //first padding char
-	 output_stream << "+";
-	 for (int i =0; i < grid.get_width(); i++) {
-		 output_stream << "-";
-	 }
-	 output_stream << "+\n";
-	 //last padding car
-	 //loops through each coord of the grid, adds corresponding
-	 // char to output_stream depending on cell status
-	 for (int y = 0;y <  grid.get_height(); y ++) {
-		 //adds border to beginning of each line
-		 output_stream << "|";
-		 for (int x = 0;x <  grid.get_width(); x ++) {
-			 //determines cell status
-			 if (grid.get(x,y) == ALIVE) {
-				 output_stream << "#";
-			 } else {
-				 output_stream << ' ';
-			 }
-		 }
-		  //adds border to end of each line
-		 output_stream << "|\n";
-	}
-	//end border
-	output_stream << "+";
-	for (int i =0; i < grid.get_width(); i++) {
-		output_stream << "-";
-	}
-	output_stream << "+\n";
-	return output_stream;
+ std::ostream& operator<<(std::ostream& output_stream, const Grid &grid) {
+	 //draw the whole frame into one buffer and write it in one go
+	 Renderer renderer;
+	 renderer.print(output_stream, grid);
+	 return output_stream;
  }
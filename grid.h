@@ -15,6 +15,11 @@
 #include <stdio.h>
 #include <iostream>
 
+#include "execution_policy.h"
+#include "grid_allocator.h"
+
+class GridView;
+
 /**
  * A Cell is a char limited to two named values for Cell::DEAD and Cell::ALIVE.
  */
@@ -37,7 +42,9 @@ public:
 
 	int get_total_cells() const;
 	int get_alive_cells() const;
+	int get_alive_cells(const ExecutionPolicy &policy) const;
 	int get_dead_cells() const;
+	int get_dead_cells(const ExecutionPolicy &policy) const;
 
 	void resize(int square_size);
 	void resize(int width, int height);
@@ -48,15 +55,30 @@ public:
 	Cell& operator()(unsigned int x, unsigned int y);
 	const Cell& operator()(unsigned int x, unsigned int y) const;
 
+	int get_stride() const;
+	int get_halo() const;
+	void set_halo(int halo);
+	void refresh_halo(bool toroidal);
+	Cell* row(unsigned int y);
+	const Cell* row(unsigned int y) const;
+
 	Grid crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const;
-	void merge(Grid other, int x0, int y0, bool alive_only = false);
+	Grid crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, const ExecutionPolicy &policy) const;
+	void merge(const Grid &other, int x0, int y0, bool alive_only = false);
+	void merge(const GridView &other, int x0, int y0, bool alive_only = false);
+	void merge(const GridView &other, int x0, int y0, bool alive_only, const ExecutionPolicy &policy);
 
-	Grid rotate(int rotation) const;
- 	friend std::ostream& operator<<(std::ostream& output_stream, Grid grid);
+	Grid rotate(int rotation) const &;
+	Grid rotate(int rotation) &&;
+ 	friend std::ostream& operator<<(std::ostream& output_stream, const Grid &grid);
 
 
 private:
 	int width, height;
-	std::vector<std::vector<Cell>> grid;
+	//cells of padding stored around each edge, allowing neighbour reads just outside the grid
+	int halo;
+	std::vector<Cell, GridAllocator<Cell>> grid;
+
+	unsigned int get_index(unsigned int x, unsigned int y) const;
 
 };
@@ -0,0 +1,316 @@
+/**
+ * Implements the process wide pool of grid buffers and the counters of grid buffer allocations.
+ *      - Every Grid and BitGrid cell buffer is allocated through GridAllocator, which takes it from the GridPool.
+ *      - Sizes are rounded up to size classes, at most an eighth apart, so a freed buffer can be reused by any
+ *        later request of a similar size: temporaries from Grid::crop or Grid::rotate, resizes, and worlds
+ *        made and dropped many times a second stop going back to the system once the pool is warm.
+ *      - Freed buffers are cached up to a limit (256 MiB by default) and released to the system past it.
+ *      - Buffers start on a cache line. Those of a huge page (2 MiB) or more are mapped on huge page boundaries
+ *        and, where the system supports it, advised to be backed by huge pages, cutting TLB misses when
+ *        stepping big boards.
+ *      - The counters only ever increase, so take a reading before and after the code being checked.
+ *        Every buffer taken counts as an allocation, reused or not, so a hot path that reads zero takes no
+ *        buffers at all. Allocations::get_reused() counts those the pool served without the system.
+ *
+ * @example
+ *
+ *      // Check that stepping a world is allocation free
+ *      World world(Zoo::r_pentomino());
+ *      unsigned long before = Allocations::get_count();
+ *      world.advance(100);
+ *      assert(Allocations::get_count() == before);
+ *
+ *      // Keep up to 1 GiB of freed buffers for reuse
+ *      GridPool::set_limit(1024 * 1024 * 1024);
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "grid_allocator.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+static std::atomic<unsigned long> allocationCount(0);
+static std::atomic<unsigned long> allocationBytes(0);
+static std::atomic<unsigned long> reusedCount(0);
+
+/**
+ * The freed buffers of each size class, and the settings of the pool.
+ */
+struct BufferCache {
+	std::mutex mutex;
+	std::unordered_map<std::size_t, std::vector<void*>> buffers;
+	std::size_t cachedBytes = 0;
+	std::size_t limit = 256 * 1024 * 1024;
+	bool hugePages = true;
+};
+
+//helper function giving the pool, which is never destroyed so grids outliving static destruction can still free
+static BufferCache& cache() {
+	static BufferCache *pool = new BufferCache();
+	return *pool;
+}
+
+//helper function rounding a request up to its size class, so that similar sizes share buffers
+static std::size_t size_class(std::size_t bytes) {
+	if (bytes <= 1024) {
+		//small buffers are whole cache lines, an empty request still takes one
+		return std::max<std::size_t>(1, (bytes + GridPool::ALIGNMENT - 1) / GridPool::ALIGNMENT) * GridPool::ALIGNMENT;
+	}
+	std::size_t top = std::size_t(1) << (63 - __builtin_clzll(bytes));
+	std::size_t step = top / 8;
+	std::size_t size = (bytes + step - 1) / step * step;
+	if (size >= GridPool::HUGE_PAGE) {
+		size = (size + GridPool::HUGE_PAGE - 1) / GridPool::HUGE_PAGE * GridPool::HUGE_PAGE;
+	}
+	return size;
+}
+
+//helper function taking a buffer of a size class from the system
+static void* system_allocate(std::size_t size, bool huge_pages) {
+	if (size < GridPool::HUGE_PAGE) {
+		return ::operator new(size, std::align_val_t(GridPool::ALIGNMENT));
+	}
+
+	//maps a huge page more than needed and unmaps either side of the aligned range
+	std::size_t mapped = size + GridPool::HUGE_PAGE;
+	void *base = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED) {
+		throw std::bad_alloc();
+	}
+	char *start = static_cast<char*>(base);
+	char *aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(start) + GridPool::HUGE_PAGE - 1)
+			& ~(std::uintptr_t)(GridPool::HUGE_PAGE - 1));
+	if (aligned > start) {
+		munmap(start, aligned - start);
+	}
+	if (start + mapped > aligned + size) {
+		munmap(aligned + size, start + mapped - (aligned + size));
+	}
+#ifdef MADV_HUGEPAGE
+	if (huge_pages) {
+		//only advice, the buffer works the same without huge pages
+		madvise(aligned, size, MADV_HUGEPAGE);
+	}
+#else
+	(void)huge_pages;
+#endif
+	return aligned;
+}
+
+//helper function giving a buffer of a size class back to the system
+static void system_deallocate(void *pointer, std::size_t size) {
+	if (size < GridPool::HUGE_PAGE) {
+		::operator delete(pointer, std::align_val_t(GridPool::ALIGNMENT));
+	} else {
+		munmap(pointer, size);
+	}
+}
+
+/**
+ * Allocations::get_count()
+ *
+ * @return
+ *      The number of grid buffer allocations made so far.
+ */
+unsigned long Allocations::get_count() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Allocations::get_bytes()
+ *
+ * @return
+ *      The total number of bytes requested by grid buffer allocations so far.
+ */
+unsigned long Allocations::get_bytes() {
+	return allocationBytes.load(std::memory_order_relaxed);
+}
+
+/**
+ * Allocations::get_reused()
+ *
+ * @return
+ *      The number of grid buffer allocations so far that were served by a buffer freed to the GridPool.
+ */
+unsigned long Allocations::get_reused() {
+	return reusedCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * Allocations::record(bytes)
+ *
+ * Record a single grid buffer allocation.
+ *
+ * @param bytes
+ *      The size of the allocation in bytes.
+ */
+void Allocations::record(std::size_t bytes) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocationBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * Allocations::record_reuse()
+ *
+ * Record that the last grid buffer allocation reused a pooled buffer.
+ */
+void Allocations::record_reuse() {
+	reusedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * GridPool::allocate(bytes)
+ *
+ * Take a buffer from the pool, reusing a freed one of the same size class if there is one.
+ *
+ * @param bytes
+ *      The size of the buffer needed.
+ *
+ * @return
+ *      A buffer of at least bytes, aligned to GridPool::ALIGNMENT.
+ *
+ * @throws
+ *      std::bad_alloc if the system is out of memory.
+ */
+void* GridPool::allocate(std::size_t bytes) {
+	Allocations::record(bytes);
+	std::size_t size = size_class(bytes);
+	BufferCache &pool = cache();
+	bool hugePages;
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		auto found = pool.buffers.find(size);
+		if (found != pool.buffers.end() && !found->second.empty()) {
+			void *buffer = found->second.back();
+			found->second.pop_back();
+			pool.cachedBytes -= size;
+			Allocations::record_reuse();
+			return buffer;
+		}
+		hugePages = pool.hugePages;
+	}
+	return system_allocate(size, hugePages);
+}
+
+/**
+ * GridPool::deallocate(pointer, bytes)
+ *
+ * Give a buffer back to the pool, which keeps it for reuse unless that would pass the limit.
+ *
+ * @param pointer
+ *      The buffer, from GridPool::allocate.
+ *
+ * @param bytes
+ *      The size it was allocated with.
+ */
+void GridPool::deallocate(void *pointer, std::size_t bytes) {
+	std::size_t size = size_class(bytes);
+	BufferCache &pool = cache();
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		if (pool.cachedBytes + size <= pool.limit) {
+			pool.buffers[size].push_back(pointer);
+			pool.cachedBytes += size;
+			return;
+		}
+	}
+	system_deallocate(pointer, size);
+}
+
+/**
+ * GridPool::get_limit()
+ *
+ * @return
+ *      The most bytes of freed buffers the pool keeps for reuse.
+ */
+std::size_t GridPool::get_limit() {
+	BufferCache &pool = cache();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	return pool.limit;
+}
+
+/**
+ * GridPool::set_limit(bytes)
+ *
+ * Sets the most bytes of freed buffers the pool keeps for reuse, releasing any cached past it.
+ *
+ * @param bytes
+ *      The new limit, 0 to return every freed buffer to the system straight away.
+ */
+void GridPool::set_limit(std::size_t bytes) {
+	BufferCache &pool = cache();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	pool.limit = bytes;
+	for (auto &sized : pool.buffers) {
+		while (pool.cachedBytes > pool.limit && !sized.second.empty()) {
+			system_deallocate(sized.second.back(), sized.first);
+			sized.second.pop_back();
+			pool.cachedBytes -= sized.first;
+		}
+	}
+}
+
+/**
+ * GridPool::get_huge_pages()
+ *
+ * @return
+ *      True if buffers of a huge page or more are advised to be backed by huge pages.
+ */
+bool GridPool::get_huge_pages() {
+	BufferCache &pool = cache();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	return pool.hugePages;
+}
+
+/**
+ * GridPool::set_huge_pages(enabled)
+ *
+ * Sets whether buffers of a huge page or more, taken from the system from now on, are advised to be
+ * backed by huge pages. They are aligned to huge pages either way.
+ *
+ * @param enabled
+ *      True to advise huge pages.
+ */
+void GridPool::set_huge_pages(bool enabled) {
+	BufferCache &pool = cache();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	pool.hugePages = enabled;
+}
+
+/**
+ * GridPool::get_cached_bytes()
+ *
+ * @return
+ *      The bytes of freed buffers currently kept for reuse.
+ */
+std::size_t GridPool::get_cached_bytes() {
+	BufferCache &pool = cache();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	return pool.cachedBytes;
+}
+
+/**
+ * GridPool::trim()
+ *
+ * Returns every cached buffer to the system, e.g. after a burst of work on big boards.
+ */
+void GridPool::trim() {
+	BufferCache &pool = cache();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	for (auto &sized : pool.buffers) {
+		for (void *buffer : sized.second) {
+			system_deallocate(buffer, sized.first);
+		}
+	}
+	pool.buffers.clear();
+	pool.cachedBytes = 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * Declares the allocator used for the cell buffers of Grid and BitGrid, which counts every heap
+ * allocation it makes so callers can check that hot paths such as World::step do not allocate.
+ * Buffers come from a process wide pool of cache line aligned, and for big buffers huge page backed,
+ * memory which freed buffers return to, see grid_allocator.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+/**
+ * Process wide counters of the heap allocations made for grid cell buffers.
+ */
+namespace Allocations {
+	unsigned long get_count();
+	unsigned long get_bytes();
+	unsigned long get_reused();
+
+	void record(std::size_t bytes);
+	void record_reuse();
+};
+
+/**
+ * The process wide pool that grid cell buffers are taken from and returned to.
+ */
+namespace GridPool {
+	//every buffer starts on a cache line
+	const std::size_t ALIGNMENT = 64;
+	//buffers of at least a huge page are mapped directly, aligned to huge pages
+	const std::size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+	void* allocate(std::size_t bytes);
+	void deallocate(void *pointer, std::size_t bytes);
+
+	std::size_t get_limit();
+	void set_limit(std::size_t bytes);
+	bool get_huge_pages();
+	void set_huge_pages(bool enabled);
+
+	std::size_t get_cached_bytes();
+	void trim();
+};
+
+/**
+ * A std::allocator that takes its buffers from the GridPool and reports each allocation to the Allocations counters.
+ */
+template <typename T>
+class GridAllocator {
+public:
+	typedef T value_type;
+
+	GridAllocator() {}
+
+	template <typename U>
+	GridAllocator(const GridAllocator<U> &) {}
+
+	T* allocate(std::size_t n) {
+		return static_cast<T*>(GridPool::allocate(n * sizeof(T)));
+	}
+
+	void deallocate(T *pointer, std::size_t n) {
+		GridPool::deallocate(pointer, n * sizeof(T));
+	}
+
+	template <typename U>
+	bool operator==(const GridAllocator<U> &) const {
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const GridAllocator<U> &) const {
+		return false;
+	}
+};
@@ -0,0 +1,345 @@
+/**
+ * Implements a class representing a read-only window onto the cells of a Grid.
+ *      - Cropping moves the origin, rotating and transposing swap and negate the steps, so a chain such as
+ *        GridView(board).crop(...).rotate(1) touches no cells until it is read.
+ *      - A view that has not been rotated or transposed keeps the grid's rows contiguous, so consumers can
+ *        stream it a row at a time with GridView::row(y) exactly as they would the grid itself.
+ *      - Grid::merge, Zoo's save functions and Renderer all accept views, so a region of a board can be
+ *        placed, saved or drawn without first copying it out.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "grid_view.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * GridView::GridView(grid)
+ *
+ * Construct a view of the whole of a grid.
+ * Grids convert to views implicitly, so a Grid can be passed anywhere a GridView is taken.
+ *
+ * @example
+ *
+ *      // View the top left quarter of a board, rotated a quarter turn
+ *      Grid board(64, 64);
+ *      GridView corner = GridView(board).crop(0, 0, 32, 32).rotate(1);
+ *
+ * @param grid
+ *      The grid to view, which must outlive the view.
+ */
+GridView::GridView(const Grid &grid) : grid(&grid), origin(grid.get_height() > 0 ? grid.row(0) : nullptr),
+	stepX(1), stepY(grid.get_stride()), width(grid.get_width()), height(grid.get_height()) {}
+
+/**
+ * GridView::get_width()
+ *
+ * @return
+ *      The width of the view.
+ */
+int GridView::get_width() const {
+	return this->width;
+}
+
+/**
+ * GridView::get_height()
+ *
+ * @return
+ *      The height of the view.
+ */
+int GridView::get_height() const {
+	return this->height;
+}
+
+/**
+ * GridView::get_total_cells()
+ *
+ * @return
+ *      The number of cells in the view.
+ */
+int GridView::get_total_cells() const {
+	return this->width * this->height;
+}
+
+/**
+ * GridView::get_alive_cells()
+ *
+ * @return
+ *      The number of alive cells in the view.
+ */
+int GridView::get_alive_cells() const {
+	int alive = 0;
+	for (int y = 0; y < this->height; y++) {
+		for (int x = 0; x < this->width; x++) {
+			alive += (this->at(x, y) == ALIVE);
+		}
+	}
+	return alive;
+}
+
+/**
+ * GridView::get_dead_cells()
+ *
+ * @return
+ *      The number of dead cells in the view.
+ */
+int GridView::get_dead_cells() const {
+	return this->get_total_cells() - this->get_alive_cells();
+}
+
+//helper function reading a cell without checking the coordinate
+const Cell& GridView::at(int x, int y) const {
+	return this->origin[x * this->stepX + y * this->stepY];
+}
+
+/**
+ * GridView::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate of the view.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The value of the cell.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the view.
+ */
+Cell GridView::get(unsigned int x, unsigned int y) const {
+	return (*this)(x, y);
+}
+
+/**
+ * GridView::operator()(x, y)
+ *
+ * Gets a read-only reference to the cell at the desired coordinate of the view.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      A read-only reference to the cell in the viewed grid.
+ *
+ * @throws
+ *      std::exception or sub-class if x,y is not a valid coordinate within the view.
+ */
+const Cell& GridView::operator()(unsigned int x, unsigned int y) const {
+	if (x >= (unsigned int)this->width || y >= (unsigned int)this->height) {
+		throw std::invalid_argument("Invalid view coordinates.\n");
+	}
+	return this->at(x, y);
+}
+
+/**
+ * GridView::is_contiguous()
+ *
+ * @return
+ *      True if each row of the view is a contiguous run of cells left to right, as it is
+ *      for a view that has only been cropped. Only then can the view be read with GridView::row(y).
+ */
+bool GridView::is_contiguous() const {
+	return this->stepX == 1;
+}
+
+/**
+ * GridView::row(y)
+ *
+ * Gets a read-only pointer to the first cell of a row of a contiguous view, which holds
+ * GridView::get_width() cells.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A read-only pointer to the first cell of the row.
+ *
+ * @throws
+ *      std::exception or sub-class if y is not a valid row or the view is not contiguous.
+ */
+const Cell* GridView::row(unsigned int y) const {
+	if (!this->is_contiguous()) {
+		throw std::logic_error("Rows of a rotated or transposed view are not contiguous.\n");
+	}
+	if (y >= (unsigned int)this->height) {
+		throw std::invalid_argument("Invalid view row.\n");
+	}
+	return this->origin + y * this->stepY;
+}
+
+/**
+ * GridView::views(grid)
+ *
+ * @return
+ *      True if the view is onto the cells of the given grid, e.g. to check a merge does not read what it writes.
+ */
+bool GridView::views(const Grid &grid) const {
+	return this->grid == &grid;
+}
+
+/**
+ * GridView::crop(x0, y0, x1, y1)
+ *
+ * Make a view of the window [x0, x1) by [y0, y1) of this view, in this view's coordinates.
+ *
+ * @example
+ *
+ *      // Save the centre of a board without copying it out first
+ *      Zoo::save_ascii("centre.gol", GridView(board).crop(16, 16, 48, 48));
+ *
+ * @param x0
+ *      Left coordinate of the window.
+ *
+ * @param y0
+ *      Top coordinate of the window.
+ *
+ * @param x1
+ *      Right coordinate of the window, not included.
+ *
+ * @param y1
+ *      Bottom coordinate of the window, not included.
+ *
+ * @return
+ *      A view of the window.
+ *
+ * @throws
+ *      std::exception or sub-class if x0,y0 or x1,y1 are not valid coordinates within the view
+ *      or if the window has a negative size.
+ */
+GridView GridView::crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const {
+	if (x0 > (unsigned int)this->width || y0 > (unsigned int)this->height
+			|| x1 > (unsigned int)this->width || y1 > (unsigned int)this->height) {
+		throw std::invalid_argument("Coordinates outside of grid bounds.\n");
+	}
+	if (x0 > x1) {
+		throw std::invalid_argument("x0 cannot be greater than x1.\n");
+	}
+	if (y0 > y1) {
+		throw std::invalid_argument("y0 cannot be greater than y1.\n");
+	}
+
+	GridView cropped = *this;
+	if (x1 > x0 && y1 > y0) {
+		cropped.origin = &this->at(x0, y0);
+	}
+	cropped.width = x1 - x0;
+	cropped.height = y1 - y0;
+	return cropped;
+}
+
+/**
+ * GridView::rotate(rotation)
+ *
+ * Make a view of this view rotated clockwise by a multiple of 90 degrees, matching Grid::rotate.
+ * The rotation can be any integer, positive, negative, or 0.
+ *
+ * @example
+ *
+ *      // Place a glider in each orientation without copying it
+ *      Grid glider = Zoo::glider();
+ *      for (int i = 0; i < 4; i++) {
+ *          board.merge(GridView(glider).rotate(i), 8 * i, 0);
+ *      }
+ *
+ * @param rotation
+ *      A positive or negative integer to rotate by in 90 intervals.
+ *
+ * @return
+ *      A rotated view.
+ */
+GridView GridView::rotate(int rotation) const {
+	int turns = ((rotation % 4) + 4) % 4;
+	GridView rotated = *this;
+	if (turns == 0 || this->width == 0 || this->height == 0) {
+		if (turns % 2 == 1) {
+			std::swap(rotated.width, rotated.height);
+		}
+		return rotated;
+	}
+
+	//the rotated view's origin is the corner that moves to the top left, its axes follow the turned edges
+	if (turns == 1) {
+		rotated.origin = &this->at(0, this->height - 1);
+		rotated.stepX = -this->stepY;
+		rotated.stepY = this->stepX;
+	} else if (turns == 2) {
+		rotated.origin = &this->at(this->width - 1, this->height - 1);
+		rotated.stepX = -this->stepX;
+		rotated.stepY = -this->stepY;
+	} else {
+		rotated.origin = &this->at(this->width - 1, 0);
+		rotated.stepX = this->stepY;
+		rotated.stepY = -this->stepX;
+	}
+	if (turns % 2 == 1) {
+		std::swap(rotated.width, rotated.height);
+	}
+	return rotated;
+}
+
+/**
+ * GridView::transpose()
+ *
+ * Make a view of this view mirrored along its leading diagonal, so cell (x, y) becomes cell (y, x).
+ *
+ * @return
+ *      A transposed view.
+ */
+GridView GridView::transpose() const {
+	GridView transposed = *this;
+	std::swap(transposed.stepX, transposed.stepY);
+	std::swap(transposed.width, transposed.height);
+	return transposed;
+}
+
+/**
+ * GridView::to_grid()
+ *
+ * Copy the cells of the view out into a new grid of the view's size.
+ *
+ * @return
+ *      A grid holding the view's cells.
+ */
+Grid GridView::to_grid() const {
+	return this->to_grid(ExecutionPolicy::sequential());
+}
+
+/**
+ * GridView::to_grid(policy)
+ *
+ * Copy the cells of the view out into a new grid of the view's size, copying bands of rows under the policy.
+ *
+ * @param policy
+ *      Whether to copy serially or in parallel.
+ *
+ * @return
+ *      A grid holding the view's cells.
+ */
+Grid GridView::to_grid(const ExecutionPolicy &policy) const {
+	Grid grid(this->width, this->height);
+	if (this->width == 0) {
+		return grid;
+	}
+	policy.for_bands(this->height, this->width, 1, [&](int y0, int y1) {
+		for (int y = y0; y < y1; y++) {
+			Cell *target = grid.row(y);
+			if (this->is_contiguous()) {
+				const Cell *source = &this->at(0, y);
+				std::copy(source, source + this->width, target);
+				continue;
+			}
+			for (int x = 0; x < this->width; x++) {
+				target[x] = this->at(x, y);
+			}
+		}
+	});
+	return grid;
+}
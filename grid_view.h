@@ -0,0 +1,56 @@
+/**
+ * Declares a class representing a read-only window onto the cells of a Grid.
+ * Rich documentation for the api and behaviour the GridView class can be found in grid_view.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the GridView class.
+ *
+ * A view does not own any cells, it maps its coordinates onto the grid it was made from: cell (x, y)
+ * of the view is origin[x * stepX + y * stepY]. Cropping, rotating or transposing a view only changes
+ * the origin and steps, so none of them copy or allocate.
+ *
+ * A view must not outlive its grid, and is invalidated by anything that reallocates the grid's cells,
+ * such as Grid::resize. It cannot be made from a temporary grid.
+ */
+class GridView {
+public:
+	GridView(const Grid &grid);
+	GridView(const Grid &&grid) = delete;
+
+	int get_width() const;
+	int get_height() const;
+
+	int get_total_cells() const;
+	int get_alive_cells() const;
+	int get_dead_cells() const;
+
+	Cell get(unsigned int x, unsigned int y) const;
+	const Cell& operator()(unsigned int x, unsigned int y) const;
+
+	bool is_contiguous() const;
+	const Cell* row(unsigned int y) const;
+
+	bool views(const Grid &grid) const;
+
+	GridView crop(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const;
+	GridView rotate(int rotation) const;
+	GridView transpose() const;
+
+	Grid to_grid() const;
+	Grid to_grid(const ExecutionPolicy &policy) const;
+
+private:
+	const Grid *grid;
+	const Cell *origin;
+	long stepX, stepY;
+	int width, height;
+
+	const Cell& at(int x, int y) const;
+};
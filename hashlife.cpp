@@ -0,0 +1,563 @@
+/**
+ * Implements a class simulating Conway's Game of Life with Bill Gosper's HashLife algorithm.
+ *      - https://www.conwaylife.com/wiki/HashLife
+ *
+ *      - The plane is stored as a quadtree of canonical (hash-consed) nodes, so repeated regions
+ *        in space, such as empty space or many copies of the same still life, are stored once.
+ *
+ *      - Each node memoizes its centre advanced in time, so repeated regions in time are only computed once.
+ *
+ *      - HashLife::advance(steps) splits steps into powers of two and jumps 2^j generations at a time,
+ *        so runs of millions of generations of patterns like Zoo::r_pentomino() take a handful of jumps.
+ *
+ *      - The plane is unbounded. HashLife::get_state() and the cell counts report on the width x height
+ *        window the simulation was constructed with, with the top left of that window at 0,0.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "hashlife.h"
+
+#include <algorithm>
+
+//number of nodes held before unreachable nodes and memoized results are thrown away
+static const size_t NODE_LIMIT = 1 << 22;
+
+//smallest root level, so the root always has grandchildren to take successors of
+static const int MIN_LEVEL = 3;
+
+/**
+ * HashLife::Key::operator==(other)
+ *
+ * Nodes are equal when they have the same four (canonical) children.
+ */
+bool HashLife::Key::operator==(const Key &other) const {
+	return nw == other.nw && ne == other.ne && sw == other.sw && se == other.se;
+}
+
+/**
+ * HashLife::KeyHash::operator()(key)
+ *
+ * Mix the child addresses into a hash.
+ */
+size_t HashLife::KeyHash::operator()(const Key &key) const {
+	uint64_t hash = (uint64_t)(uintptr_t)key.nw;
+	hash = hash * 0x9E3779B97F4A7C15ULL + (uint64_t)(uintptr_t)key.ne;
+	hash = hash * 0x9E3779B97F4A7C15ULL + (uint64_t)(uintptr_t)key.sw;
+	hash = hash * 0x9E3779B97F4A7C15ULL + (uint64_t)(uintptr_t)key.se;
+	return (size_t)(hash ^ (hash >> 29));
+}
+
+
+/**
+ * HashLife::HashLife()
+ *
+ * Construct an empty simulation with a 0x0 window.
+ */
+HashLife::HashLife() : HashLife(0) {}
+
+
+/**
+ * HashLife::HashLife(square_size)
+ *
+ * Construct an empty simulation with a square window.
+ *
+ * @param square_size
+ *      The edge size to use for the width and height of the window.
+ */
+HashLife::HashLife(int square_size) : HashLife(square_size, square_size) {}
+
+
+/**
+ * HashLife::HashLife(width, height)
+ *
+ * Construct an empty simulation with the given window.
+ *
+ * @param width
+ *      The width of the window.
+ *
+ * @param height
+ *      The height of the window.
+ */
+HashLife::HashLife(int width, int height) : HashLife(Grid(width, height)) {}
+
+
+/**
+ * HashLife::HashLife(initial_state)
+ *
+ * Construct a simulation from the size and values of an existing grid, such as one loaded through Zoo.
+ *
+ * @example
+ *
+ *      // Run an r-pentomino for a million generations
+ *      Grid grid(64);
+ *      grid.merge(Zoo::r_pentomino(), 32, 32);
+ *      HashLife life(grid);
+ *      life.advance(1000000);
+ *      std::cout << life.get_population() << std::endl;
+ *
+ * @param initial_state
+ *      The state of the window at generation 0.
+ */
+HashLife::HashLife(const Grid &initial_state) {
+	this->width = initial_state.get_width();
+	this->height = initial_state.get_height();
+	this->generation = 0;
+	this->reset_table();
+
+	//smallest power of two square covering the grid
+	int level = MIN_LEVEL;
+	while (((int64_t)1 << level) < std::max(this->width, this->height)) {
+		level++;
+	}
+
+	this->root = this->build(initial_state, 0, 0, level);
+	this->originX = 0;
+	this->originY = 0;
+	this->state = initial_state;
+	this->stateStale = false;
+}
+
+
+/**
+ * HashLife::get_width()
+ *
+ * @return
+ *      The width of the window.
+ */
+int HashLife::get_width() const {
+	return this->width;
+}
+
+
+/**
+ * HashLife::get_height()
+ *
+ * @return
+ *      The height of the window.
+ */
+int HashLife::get_height() const {
+	return this->height;
+}
+
+
+/**
+ * HashLife::get_total_cells()
+ *
+ * @return
+ *      The number of cells in the window.
+ */
+int HashLife::get_total_cells() const {
+	return this->width * this->height;
+}
+
+
+/**
+ * HashLife::get_alive_cells()
+ *
+ * Counts the alive cells inside the window, descending only into nodes straddling its edge.
+ *
+ * @return
+ *      The number of alive cells in the window.
+ */
+int HashLife::get_alive_cells() const {
+	return (int)this->count_window(this->root, this->originX, this->originY);
+}
+
+
+/**
+ * HashLife::get_dead_cells()
+ *
+ * @return
+ *      The number of dead cells in the window.
+ */
+int HashLife::get_dead_cells() const {
+	return this->get_total_cells() - this->get_alive_cells();
+}
+
+
+/**
+ * HashLife::get_population()
+ *
+ * @return
+ *      The number of alive cells on the whole unbounded plane, inside the window or not.
+ */
+uint64_t HashLife::get_population() const {
+	return this->root->population;
+}
+
+
+/**
+ * HashLife::get_generation()
+ *
+ * @return
+ *      The number of generations simulated so far.
+ */
+uint64_t HashLife::get_generation() const {
+	return this->generation;
+}
+
+
+/**
+ * HashLife::get_state()
+ *
+ * Return a read-only reference to the window as a Grid, so it can be printed or saved through Zoo.
+ * The grid is only rebuilt when the state has advanced since it was last read.
+ *
+ * @return
+ *      A reference to the window of the current state.
+ */
+const Grid& HashLife::get_state() const {
+	if (this->stateStale) {
+		this->state = Grid(this->width, this->height);
+		this->write_window(this->root, this->originX, this->originY);
+		this->stateStale = false;
+	}
+	return this->state;
+}
+
+
+/**
+ * HashLife::step()
+ *
+ * Take one step in Conway's Game of Life.
+ */
+void HashLife::step() {
+	this->advance(1);
+}
+
+
+/**
+ * HashLife::advance(steps)
+ *
+ * Advance any number of generations, as a sequence of jumps of 2^j generations, one for each bit set in steps.
+ *
+ * @param steps
+ *      The number of steps to advance the simulation forward.
+ */
+void HashLife::advance(uint64_t steps) {
+	for (int j = 0; j < 64 && (steps >> j) != 0; j++) {
+		if (((steps >> j) & 1) == 0) {
+			continue;
+		}
+
+		if (this->nodes.size() > NODE_LIMIT) {
+			this->collect_garbage();
+		}
+
+		//the root must be big enough to jump 2^j, with the pattern far enough from its edges
+		//that nothing can reach outside the centre that successor() keeps
+		while (this->root->level < j + MIN_LEVEL || !this->is_padded()) {
+			this->expand();
+		}
+
+		int64_t quarter = (int64_t)1 << (this->root->level - 2);
+		this->root = this->successor(this->root, j);
+		this->originX += quarter;
+		this->originY += quarter;
+	}
+
+	this->generation += steps;
+	if (steps != 0) {
+		this->stateStale = true;
+	}
+}
+
+
+/**
+ * HashLife::reset_table()
+ *
+ * Private helper which empties the node table and recreates the two leaves.
+ */
+void HashLife::reset_table() {
+	this->nodes.clear();
+	this->table.clear();
+	this->empties.clear();
+	this->nodes.push_back(Node{nullptr, nullptr, nullptr, nullptr, 0, 0, nullptr, -1});
+	this->dead = &this->nodes.back();
+	this->nodes.push_back(Node{nullptr, nullptr, nullptr, nullptr, 0, 1, nullptr, -1});
+	this->alive = &this->nodes.back();
+	this->empties.push_back(this->dead);
+}
+
+
+/**
+ * HashLife::leaf(isAlive)
+ *
+ * @return
+ *      The canonical level 0 node for a single cell.
+ */
+const HashLife::Node* HashLife::leaf(bool isAlive) {
+	return isAlive ? this->alive : this->dead;
+}
+
+
+/**
+ * HashLife::join(nw, ne, sw, se)
+ *
+ * Private helper returning the canonical node with the given four children, creating it if needed.
+ */
+const HashLife::Node* HashLife::join(const Node *nw, const Node *ne, const Node *sw, const Node *se) {
+	Key key{nw, ne, sw, se};
+	auto found = this->table.find(key);
+	if (found != this->table.end()) {
+		return found->second;
+	}
+
+	this->nodes.push_back(Node{nw, ne, sw, se, nw->level + 1,
+			nw->population + ne->population + sw->population + se->population, nullptr, -1});
+	const Node *node = &this->nodes.back();
+	this->table.emplace(key, node);
+	return node;
+}
+
+
+/**
+ * HashLife::empty(level)
+ *
+ * Private helper returning the canonical empty node of a level.
+ */
+const HashLife::Node* HashLife::empty(int level) {
+	while ((int)this->empties.size() <= level) {
+		const Node *smaller = this->empties.back();
+		this->empties.push_back(this->join(smaller, smaller, smaller, smaller));
+	}
+	return this->empties[level];
+}
+
+
+/**
+ * HashLife::centre(node)
+ *
+ * Private helper returning the central half-size square of a node, without advancing time.
+ */
+const HashLife::Node* HashLife::centre(const Node *node) {
+	return this->join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+
+/**
+ * HashLife::build(grid, x, y, level)
+ *
+ * Private helper building the node covering the 2^level square of grid with its top left at x,y.
+ * Cells outside the grid are dead.
+ */
+const HashLife::Node* HashLife::build(const Grid &grid, int64_t x, int64_t y, int level) {
+	if (x >= grid.get_width() || y >= grid.get_height()) {
+		return this->empty(level);
+	}
+	if (level == 0) {
+		return this->leaf(grid.get((unsigned int)x, (unsigned int)y) == ALIVE);
+	}
+
+	int64_t half = (int64_t)1 << (level - 1);
+	return this->join(this->build(grid, x, y, level - 1), this->build(grid, x + half, y, level - 1),
+			this->build(grid, x, y + half, level - 1), this->build(grid, x + half, y + half, level - 1));
+}
+
+
+/**
+ * HashLife::step_base(node)
+ *
+ * Private helper applying the rules directly to a 4x4 (level 2) node.
+ *
+ * @return
+ *      The central 2x2 (level 1) node one generation later.
+ */
+const HashLife::Node* HashLife::step_base(const Node *node) {
+	//unpack the 4x4 square into a bit per cell, bit (y * 4 + x)
+	const Node *quadrants[4] = {node->nw, node->ne, node->sw, node->se};
+	int bits = 0;
+	for (int q = 0; q < 4; q++) {
+		const Node *cells[4] = {quadrants[q]->nw, quadrants[q]->ne, quadrants[q]->sw, quadrants[q]->se};
+		for (int c = 0; c < 4; c++) {
+			int x = (q % 2) * 2 + (c % 2);
+			int y = (q / 2) * 2 + (c / 2);
+			if (cells[c]->population) {
+				bits |= 1 << (y * 4 + x);
+			}
+		}
+	}
+
+	const Node *next[4];
+	for (int c = 0; c < 4; c++) {
+		int x = 1 + (c % 2);
+		int y = 1 + (c / 2);
+		int numNeighbours = 0;
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				if ((dx != 0 || dy != 0) && (bits & (1 << ((y + dy) * 4 + (x + dx))))) {
+					numNeighbours++;
+				}
+			}
+		}
+		bool isAlive = (bits & (1 << (y * 4 + x))) != 0;
+		next[c] = this->leaf(numNeighbours == 3 || (numNeighbours == 2 && isAlive));
+	}
+
+	return this->join(next[0], next[1], next[2], next[3]);
+}
+
+
+/**
+ * HashLife::successor(node, step)
+ *
+ * Private helper returning the centre of a level k node advanced by 2^step generations, where step <= k - 2.
+ *
+ * The node is cut into 9 overlapping half-size squares. When step == k - 2 each is advanced, regrouped into
+ * 4 squares and advanced again, each pass covering half of the jump. For smaller steps the first pass only
+ * takes the centres, and the whole jump happens in the second pass.
+ */
+const HashLife::Node* HashLife::successor(const Node *node, int step) {
+	if (node->population == 0) {
+		return this->empty(node->level - 1);
+	}
+	if (node->resultStep == step) {
+		return node->result;
+	}
+
+	const Node *result;
+	if (node->level == 2) {
+		result = this->step_base(node);
+	} else {
+		const Node *n00 = node->nw;
+		const Node *n01 = this->join(node->nw->ne, node->ne->nw, node->nw->se, node->ne->sw);
+		const Node *n02 = node->ne;
+		const Node *n10 = this->join(node->nw->sw, node->nw->se, node->sw->nw, node->sw->ne);
+		const Node *n11 = this->centre(node);
+		const Node *n12 = this->join(node->ne->sw, node->ne->se, node->se->nw, node->se->ne);
+		const Node *n20 = node->sw;
+		const Node *n21 = this->join(node->sw->ne, node->se->nw, node->sw->se, node->se->sw);
+		const Node *n22 = node->se;
+
+		bool full = (step == node->level - 2);
+		const Node *parts[9] = {n00, n01, n02, n10, n11, n12, n20, n21, n22};
+		const Node *r[9];
+		for (int i = 0; i < 9; i++) {
+			r[i] = full ? this->successor(parts[i], step - 1) : this->centre(parts[i]);
+		}
+
+		int second = full ? step - 1 : step;
+		result = this->join(
+				this->successor(this->join(r[0], r[1], r[3], r[4]), second),
+				this->successor(this->join(r[1], r[2], r[4], r[5]), second),
+				this->successor(this->join(r[3], r[4], r[6], r[7]), second),
+				this->successor(this->join(r[4], r[5], r[7], r[8]), second));
+	}
+
+	node->result = result;
+	node->resultStep = step;
+	return result;
+}
+
+
+/**
+ * HashLife::expand()
+ *
+ * Private helper which doubles the size of the root, keeping the current root in the centre.
+ */
+void HashLife::expand() {
+	const Node *border = this->empty(this->root->level - 1);
+	const Node *r = this->root;
+	int64_t half = (int64_t)1 << (r->level - 1);
+
+	this->root = this->join(
+			this->join(border, border, border, r->nw),
+			this->join(border, border, r->ne, border),
+			this->join(border, r->sw, border, border),
+			this->join(r->se, border, border, border));
+	this->originX -= half;
+	this->originY -= half;
+}
+
+
+/**
+ * HashLife::is_padded()
+ *
+ * Private helper checking every alive cell lies in the central quarter-size square of the root.
+ * A jump of up to 2^(level - 3) generations then cannot carry any cell out of the centre kept by successor().
+ */
+bool HashLife::is_padded() const {
+	const Node *r = this->root;
+	uint64_t inner = r->nw->se->se->population + r->ne->sw->sw->population
+			+ r->sw->ne->ne->population + r->se->nw->nw->population;
+	return inner == r->population;
+}
+
+
+/**
+ * HashLife::reintern(node, moved)
+ *
+ * Private helper copying a node and its descendants into a freshly reset table.
+ */
+const HashLife::Node* HashLife::reintern(const Node *node, std::unordered_map<const Node*, const Node*> &moved) {
+	if (node->level == 0) {
+		return this->leaf(node->population != 0);
+	}
+	auto found = moved.find(node);
+	if (found != moved.end()) {
+		return found->second;
+	}
+	const Node *copy = this->join(this->reintern(node->nw, moved), this->reintern(node->ne, moved),
+			this->reintern(node->sw, moved), this->reintern(node->se, moved));
+	moved.emplace(node, copy);
+	return copy;
+}
+
+
+/**
+ * HashLife::collect_garbage()
+ *
+ * Private helper which keeps only the nodes reachable from the root and drops every memoized result.
+ */
+void HashLife::collect_garbage() {
+	std::deque<Node> oldNodes;
+	oldNodes.swap(this->nodes);
+	this->reset_table();
+
+	std::unordered_map<const Node*, const Node*> moved;
+	this->root = this->reintern(this->root, moved);
+}
+
+
+/**
+ * HashLife::count_window(node, x, y)
+ *
+ * Private helper counting the alive cells of the node with its top left at x,y which lie in the window.
+ */
+uint64_t HashLife::count_window(const Node *node, int64_t x, int64_t y) const {
+	int64_t size = (int64_t)1 << node->level;
+	if (node->population == 0 || x >= this->width || y >= this->height || x + size <= 0 || y + size <= 0) {
+		return 0;
+	}
+	if (x >= 0 && y >= 0 && x + size <= this->width && y + size <= this->height) {
+		return node->population;
+	}
+
+	int64_t half = size / 2;
+	return this->count_window(node->nw, x, y) + this->count_window(node->ne, x + half, y)
+			+ this->count_window(node->sw, x, y + half) + this->count_window(node->se, x + half, y + half);
+}
+
+
+/**
+ * HashLife::write_window(node, x, y)
+ *
+ * Private helper writing the alive cells of the node with its top left at x,y into the state grid.
+ */
+void HashLife::write_window(const Node *node, int64_t x, int64_t y) const {
+	int64_t size = (int64_t)1 << node->level;
+	if (node->population == 0 || x >= this->width || y >= this->height || x + size <= 0 || y + size <= 0) {
+		return;
+	}
+	if (node->level == 0) {
+		this->state.set((unsigned int)x, (unsigned int)y, ALIVE);
+		return;
+	}
+
+	int64_t half = size / 2;
+	this->write_window(node->nw, x, y);
+	this->write_window(node->ne, x + half, y);
+	this->write_window(node->sw, x, y + half);
+	this->write_window(node->se, x + half, y + half);
+}
@@ -0,0 +1,105 @@
+/**
+ * Declares a class simulating Conway's Game of Life with Bill Gosper's HashLife algorithm.
+ * Rich documentation for the api and behaviour the HashLife class can be found in hashlife.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the HashLife class.
+ *
+ * The interface follows World, but the plane is unbounded: patterns may grow past the edges of the
+ * width x height window that get_state() and the cell counts report on.
+ */
+class HashLife {
+public:
+	HashLife();
+	explicit HashLife(int square_size);
+	HashLife(int width, int height);
+	explicit HashLife(const Grid &initial_state);
+
+	//nodes point into this simulation's own table, so it can be moved but not copied
+	HashLife(const HashLife &) = delete;
+	HashLife& operator=(const HashLife &) = delete;
+	HashLife(HashLife &&) = default;
+	HashLife& operator=(HashLife &&) = default;
+
+	int get_width() const;
+	int get_height() const;
+
+	int get_total_cells() const;
+	int get_dead_cells() const;
+	int get_alive_cells() const;
+
+	uint64_t get_population() const;
+	uint64_t get_generation() const;
+
+	const Grid& get_state() const;
+
+	void step();
+	void advance(uint64_t steps);
+
+private:
+	/**
+	 * A canonical quadtree node covering a square of 2^level cells per side.
+	 * Nodes are hash-consed, so equal squares anywhere in space or time share one node.
+	 */
+	struct Node {
+		const Node *nw, *ne, *sw, *se;
+		int level;
+		uint64_t population;
+		//memoized centre of this node advanced by 2^resultStep generations
+		mutable const Node *result;
+		mutable int resultStep;
+	};
+
+	struct Key {
+		const Node *nw, *ne, *sw, *se;
+		bool operator==(const Key &other) const;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key &key) const;
+	};
+
+	int width, height;
+	uint64_t generation;
+
+	//root covers [originX, originX + 2^level) by [originY, originY + 2^level)
+	const Node *root;
+	int64_t originX, originY;
+
+	std::deque<Node> nodes;
+	std::unordered_map<Key, const Node*, KeyHash> table;
+	std::vector<const Node*> empties;
+	const Node *dead, *alive;
+
+	mutable Grid state;
+	mutable bool stateStale;
+
+	const Node* leaf(bool isAlive);
+	const Node* join(const Node *nw, const Node *ne, const Node *sw, const Node *se);
+	const Node* empty(int level);
+	const Node* centre(const Node *node);
+	const Node* build(const Grid &grid, int64_t x, int64_t y, int level);
+	const Node* step_base(const Node *node);
+	const Node* successor(const Node *node, int step);
+	const Node* reintern(const Node *node, std::unordered_map<const Node*, const Node*> &moved);
+
+	void reset_table();
+	void expand();
+	bool is_padded() const;
+	void collect_garbage();
+
+	uint64_t count_window(const Node *node, int64_t x, int64_t y) const;
+	void write_window(const Node *node, int64_t x, int64_t y) const;
+};
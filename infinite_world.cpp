@@ -0,0 +1,383 @@
+/**
+ * Implements a class representing an unbounded plane for simulating Conway's Game of Life.
+ *      - Cells are addressed by signed 64 bit coordinates (chunk coordinates are 32 bit, giving a plane
+ *        2^38 cells across). Nothing is ever lost off an edge, so gliders and spaceships such as Zoo::glider() and Zoo::light_weight_spaceship() fly forever.
+ *
+ *      - Cells are stored bit-packed in 64x64 chunks held in a sparse map.
+ *          - A chunk is allocated when a cell in it comes to life.
+ *          - A chunk is freed as soon as it holds no alive cells.
+ *
+ *      - Each step only visits the existing chunks, plus the neighbouring chunks that alive cells on their
+ *        borders could spill into, and uses the same bit-parallel rules as the packed World kernel.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "infinite_world.h"
+#include "life_kernel.h"
+
+#include <algorithm>
+
+//cells per chunk side
+static const int CHUNK_SIZE = 64;
+
+//helper function packing a chunk coordinate into a map key
+static uint64_t chunk_key(int64_t cx, int64_t cy) {
+	return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+//helper function unpacking a map key into a chunk coordinate
+static void chunk_coords(uint64_t key, int64_t &cx, int64_t &cy) {
+	cx = (int32_t)(uint32_t)(key >> 32);
+	cy = (int32_t)(uint32_t)key;
+}
+
+//helper function splitting a cell coordinate into its chunk and the offset within the chunk
+static void split(int64_t v, int64_t &chunk, int &offset) {
+	chunk = v >> 6;
+	offset = (int)(v & (CHUNK_SIZE - 1));
+}
+
+
+/**
+ * InfiniteWorld::InfiniteWorld()
+ *
+ * Construct an empty plane.
+ */
+InfiniteWorld::InfiniteWorld() : generation(0) {}
+
+
+/**
+ * InfiniteWorld::InfiniteWorld(initial_state)
+ *
+ * Construct a plane holding the alive cells of a grid, with the top left of the grid at 0,0.
+ *
+ * @example
+ *
+ *      // Set a glider loose on the plane
+ *      InfiniteWorld world(Zoo::glider());
+ *      world.advance(4000);
+ *
+ *      // The glider is now 1000 cells down and to the right
+ *      std::cout << world.get_state() << std::endl;
+ *
+ * @param initial_state
+ *      The grid to copy onto the plane.
+ */
+InfiniteWorld::InfiniteWorld(const Grid &initial_state) : InfiniteWorld() {
+	this->merge(initial_state, 0, 0, true);
+}
+
+
+/**
+ * InfiniteWorld::get(x, y)
+ *
+ * @return
+ *      The value of the cell at x,y.
+ */
+Cell InfiniteWorld::get(int64_t x, int64_t y) const {
+	int64_t cx, cy;
+	int ox, oy;
+	split(x, cx, ox);
+	split(y, cy, oy);
+	const Chunk *chunk = this->find(cx, cy);
+	return (chunk && ((chunk->rows[oy] >> ox) & 1)) ? ALIVE : DEAD;
+}
+
+
+/**
+ * InfiniteWorld::set(x, y, value)
+ *
+ * Overwrites the cell at x,y, allocating its chunk if needed and freeing it if it is left empty.
+ */
+void InfiniteWorld::set(int64_t x, int64_t y, Cell value) {
+	int64_t cx, cy;
+	int ox, oy;
+	split(x, cx, ox);
+	split(y, cy, oy);
+	uint64_t key = chunk_key(cx, cy);
+	uint64_t mask = ((uint64_t)1) << ox;
+
+	if (value == ALIVE) {
+		auto inserted = this->chunks.emplace(key, Chunk());
+		if (inserted.second) {
+			std::fill(inserted.first->second.rows, inserted.first->second.rows + CHUNK_SIZE, 0);
+		}
+		inserted.first->second.rows[oy] |= mask;
+		return;
+	}
+
+	auto found = this->chunks.find(key);
+	if (found == this->chunks.end()) {
+		return;
+	}
+	found->second.rows[oy] &= ~mask;
+	const uint64_t *rows = found->second.rows;
+	if (std::all_of(rows, rows + CHUNK_SIZE, [](uint64_t row) { return row == 0; })) {
+		this->chunks.erase(found);
+	}
+}
+
+
+/**
+ * InfiniteWorld::merge(other, x0, y0, alive_only = false)
+ *
+ * Overlay a grid on the plane with its top left corner at x0,y0.
+ * If alive_only = true then only alive cells from the grid are written.
+ */
+void InfiniteWorld::merge(const Grid &other, int64_t x0, int64_t y0, bool alive_only) {
+	for (int y = 0; y < other.get_height(); y++) {
+		const Cell *source = other.row(y);
+		for (int x = 0; x < other.get_width(); x++) {
+			if (source[x] == ALIVE || !alive_only) {
+				this->set(x0 + x, y0 + y, source[x]);
+			}
+		}
+	}
+}
+
+
+/**
+ * InfiniteWorld::get_alive_cells()
+ *
+ * @return
+ *      The number of alive cells on the plane.
+ */
+uint64_t InfiniteWorld::get_alive_cells() const {
+	uint64_t counter = 0;
+	for (const auto &entry : this->chunks) {
+		for (uint64_t row : entry.second.rows) {
+			counter += __builtin_popcountll(row);
+		}
+	}
+	return counter;
+}
+
+
+/**
+ * InfiniteWorld::get_chunk_count()
+ *
+ * @return
+ *      The number of allocated chunks, each holding at least one alive cell.
+ */
+size_t InfiniteWorld::get_chunk_count() const {
+	return this->chunks.size();
+}
+
+
+/**
+ * InfiniteWorld::get_generation()
+ *
+ * @return
+ *      The number of steps taken so far.
+ */
+uint64_t InfiniteWorld::get_generation() const {
+	return this->generation;
+}
+
+
+/**
+ * InfiniteWorld::get_bounds(x0, y0, x1, y1)
+ *
+ * Computes the bounding box [x0, x1) by [y0, y1) of the alive cells.
+ *
+ * @return
+ *      False if the plane is empty, in which case the bounds are left untouched.
+ */
+bool InfiniteWorld::get_bounds(int64_t &x0, int64_t &y0, int64_t &x1, int64_t &y1) const {
+	bool found = false;
+	for (const auto &entry : this->chunks) {
+		int64_t cx, cy;
+		chunk_coords(entry.first, cx, cy);
+
+		//chunks are never kept empty, so every chunk has a first and last alive row and column
+		uint64_t columns = 0;
+		int firstRow = -1, lastRow = -1;
+		for (int y = 0; y < CHUNK_SIZE; y++) {
+			if (entry.second.rows[y] != 0) {
+				columns |= entry.second.rows[y];
+				firstRow = (firstRow < 0) ? y : firstRow;
+				lastRow = y;
+			}
+		}
+
+		int64_t left = cx * CHUNK_SIZE + __builtin_ctzll(columns);
+		int64_t right = cx * CHUNK_SIZE + 64 - __builtin_clzll(columns);
+		int64_t top = cy * CHUNK_SIZE + firstRow;
+		int64_t bottom = cy * CHUNK_SIZE + lastRow + 1;
+
+		x0 = found ? std::min(x0, left) : left;
+		y0 = found ? std::min(y0, top) : top;
+		x1 = found ? std::max(x1, right) : right;
+		y1 = found ? std::max(y1, bottom) : bottom;
+		found = true;
+	}
+	return found;
+}
+
+
+/**
+ * InfiniteWorld::get_window(x0, y0, width, height)
+ *
+ * Copy a rectangle of the plane into a Grid, so it can be printed or saved through Zoo.
+ *
+ * @return
+ *      A width x height grid whose top left is the cell at x0,y0.
+ */
+Grid InfiniteWorld::get_window(int64_t x0, int64_t y0, int width, int height) const {
+	Grid window(width, height);
+	for (const auto &entry : this->chunks) {
+		int64_t cx, cy;
+		chunk_coords(entry.first, cx, cy);
+		int64_t left = cx * CHUNK_SIZE, top = cy * CHUNK_SIZE;
+		if (left >= x0 + width || top >= y0 + height || left + CHUNK_SIZE <= x0 || top + CHUNK_SIZE <= y0) {
+			continue;
+		}
+		for (int y = 0; y < CHUNK_SIZE; y++) {
+			int64_t wy = top + y - y0;
+			if (wy < 0 || wy >= height || entry.second.rows[y] == 0) {
+				continue;
+			}
+			Cell *target = window.row((unsigned int)wy);
+			for (int x = 0; x < CHUNK_SIZE; x++) {
+				int64_t wx = left + x - x0;
+				if (wx >= 0 && wx < width && ((entry.second.rows[y] >> x) & 1)) {
+					target[wx] = ALIVE;
+				}
+			}
+		}
+	}
+	return window;
+}
+
+
+/**
+ * InfiniteWorld::get_state()
+ *
+ * @return
+ *      A grid covering the bounding box of the alive cells, or a 0x0 grid if the plane is empty.
+ */
+Grid InfiniteWorld::get_state() const {
+	int64_t x0, y0, x1, y1;
+	if (!this->get_bounds(x0, y0, x1, y1)) {
+		return Grid();
+	}
+	return this->get_window(x0, y0, (int)(x1 - x0), (int)(y1 - y0));
+}
+
+
+/**
+ * InfiniteWorld::step()
+ *
+ * Take one step in Conway's Game of Life.
+ *
+ * Every existing chunk is recomputed, as is each neighbouring chunk that an alive cell on the shared border
+ * or corner could bring to life. Chunks that end up empty are not kept.
+ */
+void InfiniteWorld::step() {
+	this->candidates.clear();
+	for (const auto &entry : this->chunks) {
+		int64_t cx, cy;
+		chunk_coords(entry.first, cx, cy);
+		const uint64_t *rows = entry.second.rows;
+
+		uint64_t columns = 0;
+		for (int y = 0; y < CHUNK_SIZE; y++) {
+			columns |= rows[y];
+		}
+		bool north = rows[0] != 0, south = rows[CHUNK_SIZE - 1] != 0;
+		bool west = (columns & 1) != 0, east = (columns >> 63) != 0;
+
+		this->candidates.push_back(entry.first);
+		if (north) this->candidates.push_back(chunk_key(cx, cy - 1));
+		if (south) this->candidates.push_back(chunk_key(cx, cy + 1));
+		if (west) this->candidates.push_back(chunk_key(cx - 1, cy));
+		if (east) this->candidates.push_back(chunk_key(cx + 1, cy));
+		if (rows[0] & 1) this->candidates.push_back(chunk_key(cx - 1, cy - 1));
+		if (rows[0] >> 63) this->candidates.push_back(chunk_key(cx + 1, cy - 1));
+		if (rows[CHUNK_SIZE - 1] & 1) this->candidates.push_back(chunk_key(cx - 1, cy + 1));
+		if (rows[CHUNK_SIZE - 1] >> 63) this->candidates.push_back(chunk_key(cx + 1, cy + 1));
+	}
+
+	std::sort(this->candidates.begin(), this->candidates.end());
+	this->candidates.erase(std::unique(this->candidates.begin(), this->candidates.end()), this->candidates.end());
+
+	this->nextChunks.clear();
+	Chunk result;
+	for (uint64_t key : this->candidates) {
+		int64_t cx, cy;
+		chunk_coords(key, cx, cy);
+		if (this->step_chunk(cx, cy, result)) {
+			this->nextChunks.emplace(key, result);
+		}
+	}
+
+	std::swap(this->chunks, this->nextChunks);
+	this->generation++;
+}
+
+
+/**
+ * InfiniteWorld::advance(steps)
+ *
+ * Advance multiple steps in the Game of Life.
+ *
+ * @param steps
+ *      The number of steps to advance the plane forward.
+ */
+void InfiniteWorld::advance(int steps) {
+	for (int i = 0; i < steps; i++) {
+		this->step();
+	}
+}
+
+
+/**
+ * InfiniteWorld::find(cx, cy)
+ *
+ * Private helper returning the chunk at a chunk coordinate, or null if it holds no alive cells.
+ */
+const InfiniteWorld::Chunk* InfiniteWorld::find(int64_t cx, int64_t cy) const {
+	auto found = this->chunks.find(chunk_key(cx, cy));
+	return (found == this->chunks.end()) ? nullptr : &found->second;
+}
+
+
+/**
+ * InfiniteWorld::step_chunk(cx, cy, result)
+ *
+ * Private helper computing the next generation of one chunk from it and its 8 neighbours.
+ *
+ * @return
+ *      True if the result holds any alive cells.
+ */
+bool InfiniteWorld::step_chunk(int64_t cx, int64_t cy, Chunk &result) const {
+	const Chunk *around[3][3];
+	for (int dy = -1; dy <= 1; dy++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			around[dy + 1][dx + 1] = this->find(cx + dx, cy + dy);
+		}
+	}
+
+	//rows -1 .. 64 of the chunk, each with its left and right neighbour planes
+	uint64_t left[CHUNK_SIZE + 2], middle[CHUNK_SIZE + 2], right[CHUNK_SIZE + 2];
+	for (int r = -1; r <= CHUNK_SIZE; r++) {
+		int band = (r < 0) ? 0 : (r < CHUNK_SIZE ? 1 : 2);
+		int y = (r + CHUNK_SIZE) % CHUNK_SIZE;
+		uint64_t w = around[band][0] ? around[band][0]->rows[y] : 0;
+		uint64_t c = around[band][1] ? around[band][1]->rows[y] : 0;
+		uint64_t e = around[band][2] ? around[band][2]->rows[y] : 0;
+		left[r + 1] = (c << 1) | (w >> 63);
+		middle[r + 1] = c;
+		right[r + 1] = (c >> 1) | (e << 63);
+	}
+
+	uint64_t any = 0;
+	for (int y = 0; y < CHUNK_SIZE; y++) {
+		result.rows[y] = life_word(left[y], middle[y], right[y],
+				left[y + 1], middle[y + 1], right[y + 1],
+				left[y + 2], middle[y + 2], right[y + 2]);
+		any |= result.rows[y];
+	}
+	return any != 0;
+}
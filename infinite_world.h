@@ -0,0 +1,57 @@
+/**
+ * Declares a class representing an unbounded plane for simulating Conway's Game of Life.
+ * Rich documentation for the api and behaviour the InfiniteWorld class can be found in infinite_world.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the InfiniteWorld class.
+ *
+ * The plane is stored as a sparse map of 64x64 chunks of bit-packed cells. Only chunks holding at least
+ * one alive cell are kept, so memory follows the live population rather than a bounding box.
+ */
+class InfiniteWorld {
+public:
+	InfiniteWorld();
+	explicit InfiniteWorld(const Grid &initial_state);
+
+	Cell get(int64_t x, int64_t y) const;
+	void set(int64_t x, int64_t y, Cell value);
+	void merge(const Grid &other, int64_t x0, int64_t y0, bool alive_only = false);
+
+	uint64_t get_alive_cells() const;
+	size_t get_chunk_count() const;
+	uint64_t get_generation() const;
+
+	bool get_bounds(int64_t &x0, int64_t &y0, int64_t &x1, int64_t &y1) const;
+	Grid get_window(int64_t x0, int64_t y0, int width, int height) const;
+	Grid get_state() const;
+
+	void step();
+	void advance(int steps);
+
+private:
+	/**
+	 * 64x64 cells, row y is rows[y] and bit x of the row is the cell at x.
+	 */
+	struct Chunk {
+		uint64_t rows[64];
+	};
+
+	std::unordered_map<uint64_t, Chunk> chunks;
+	std::unordered_map<uint64_t, Chunk> nextChunks;
+	std::vector<uint64_t> candidates;
+	uint64_t generation;
+
+	const Chunk* find(int64_t cx, int64_t cy) const;
+	bool step_chunk(int64_t cx, int64_t cy, Chunk &result) const;
+};
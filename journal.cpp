@@ -0,0 +1,316 @@
+/**
+ * Implements a bounded journal of a world's recent generations, for stepping back through them.
+ *      - Each step is recorded as the xor of the packed words it changed, so one delta moves the state
+ *        forwards or backwards across its step and a still region costs nothing.
+ *      - The deltas live in a ring of fixed capacity: recording past it drops the oldest, reusing its buffers.
+ *      - Every keyframe interval generations a packed copy of the whole state is kept too, so a seek far
+ *        from the current generation starts from the nearest keyframe instead of applying every delta.
+ *      - Recording a step from a generation earlier than the newest (after seeking back) drops the
+ *        generations after it, as they belong to a history that is no longer followed.
+ *
+ * @example
+ *
+ *      // Keep the last 1000 generations, with a keyframe every 100
+ *      World world(Zoo::load("soup.rle"));
+ *      world.set_journal(1000, 100);
+ *      world.advance(5000);
+ *
+ *      // Look at a generation halfway back
+ *      world.seek(4500);
+ *      std::cout << world.get_state() << std::endl;
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "journal.h"
+
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * Journal::Journal()
+ *
+ * Construct a journal that records nothing.
+ */
+Journal::Journal() : Journal(0, 0) {}
+
+/**
+ * Journal::Journal(capacity, keyframe_interval)
+ *
+ * Construct an empty journal, which must be Journal::reset before recording.
+ *
+ * @param capacity
+ *      The number of steps to keep, 0 to record nothing.
+ *
+ * @param keyframe_interval
+ *      Keep a keyframe of every generation that is a multiple of this, 0 for no keyframes.
+ *
+ * @throws
+ *      std::exception or sub-class if capacity or keyframe_interval are negative.
+ */
+Journal::Journal(int capacity, int keyframe_interval) : capacity(capacity), keyframeInterval(keyframe_interval),
+		start(0), startPopulation(0), startBirths(0), startDeaths(0) {
+	if (capacity < 0 || keyframe_interval < 0) {
+		throw std::invalid_argument("Journal capacity and keyframe interval cannot be negative.\n");
+	}
+	this->spare.births = this->spare.deaths = this->spare.population = 0;
+}
+
+/**
+ * Journal::get_capacity()
+ *
+ * @return
+ *      The number of steps the journal keeps, 0 if it records nothing.
+ */
+int Journal::get_capacity() const {
+	return this->capacity;
+}
+
+/**
+ * Journal::get_keyframe_interval()
+ *
+ * @return
+ *      The interval between keyframes in generations, 0 if none are kept.
+ */
+int Journal::get_keyframe_interval() const {
+	return this->keyframeInterval;
+}
+
+/**
+ * Journal::get_start()
+ *
+ * @return
+ *      The oldest generation the journal can go back to.
+ */
+long long Journal::get_start() const {
+	return this->start;
+}
+
+/**
+ * Journal::get_end()
+ *
+ * @return
+ *      The newest generation the journal can go forward to.
+ */
+long long Journal::get_end() const {
+	return this->start + (long long)this->deltas.size();
+}
+
+/**
+ * Journal::get_bytes()
+ *
+ * @return
+ *      The approximate memory held by the deltas and keyframes, in bytes.
+ */
+size_t Journal::get_bytes() const {
+	size_t bytes = 0;
+	for (const JournalDelta &delta : this->deltas) {
+		bytes += sizeof(JournalDelta) + (delta.indices.capacity() + delta.masks.capacity()) * sizeof(uint64_t);
+	}
+	for (const auto &keyframe : this->keyframes) {
+		bytes += (size_t)keyframe.second.get_words_per_row() * keyframe.second.get_height() * sizeof(uint64_t);
+	}
+	return bytes;
+}
+
+/**
+ * Journal::reset(generation, population, births, deaths)
+ *
+ * Forget everything recorded and start again from a generation, e.g. after the world is resized.
+ *
+ * @param generation
+ *      The generation the journal now starts and ends at.
+ *
+ * @param population
+ *      The population at that generation.
+ *
+ * @param births
+ *      The births of the step that led to that generation.
+ *
+ * @param deaths
+ *      The deaths of the step that led to that generation.
+ */
+void Journal::reset(long long generation, long long population, long long births, long long deaths) {
+	this->deltas.clear();
+	this->keyframes.clear();
+	this->start = generation;
+	this->startPopulation = population;
+	this->startBirths = births;
+	this->startDeaths = deaths;
+}
+
+/**
+ * Journal::record(generation)
+ *
+ * Make room for the delta of the step from a generation to the next, dropping the oldest delta if the
+ * journal is full and any generations recorded after this one. The caller fills the delta in.
+ *
+ * @param generation
+ *      The generation stepped from, between Journal::get_start() and Journal::get_end().
+ *
+ * @return
+ *      The new, empty, delta.
+ *
+ * @throws
+ *      std::exception or sub-class if the generation is outside the journal or it records nothing.
+ */
+JournalDelta& Journal::record(long long generation) {
+	this->check_generation(generation);
+	if (this->capacity == 0) {
+		throw std::logic_error("Journal records nothing.\n");
+	}
+
+	//later generations are replaced by the new step
+	while (this->get_end() > generation) {
+		this->spare = std::move(this->deltas.back());
+		this->deltas.pop_back();
+	}
+	this->keyframes.erase(this->keyframes.upper_bound(generation), this->keyframes.end());
+
+	if ((int)this->deltas.size() == this->capacity) {
+		JournalDelta &oldest = this->deltas.front();
+		this->start++;
+		this->startPopulation = oldest.population;
+		this->startBirths = oldest.births;
+		this->startDeaths = oldest.deaths;
+		this->spare = std::move(oldest);
+		this->deltas.pop_front();
+		this->keyframes.erase(this->keyframes.begin(), this->keyframes.lower_bound(this->start));
+	}
+
+	//the spare buffers keep their capacity, so a steady state records without allocating
+	this->deltas.push_back(std::move(this->spare));
+	JournalDelta &delta = this->deltas.back();
+	delta.indices.clear();
+	delta.masks.clear();
+	delta.births = delta.deaths = delta.population = 0;
+	return delta;
+}
+
+/**
+ * Journal::wants_keyframe(generation)
+ *
+ * @return
+ *      True if a keyframe should be kept of the generation.
+ */
+bool Journal::wants_keyframe(long long generation) const {
+	return this->keyframeInterval > 0 && generation % this->keyframeInterval == 0;
+}
+
+/**
+ * Journal::add_keyframe(generation, state)
+ *
+ * Keep a copy of the whole state at a generation.
+ *
+ * @param generation
+ *      The generation of the state, between Journal::get_start() and Journal::get_end().
+ *
+ * @param state
+ *      The packed state.
+ *
+ * @throws
+ *      std::exception or sub-class if the generation is outside the journal.
+ */
+void Journal::add_keyframe(long long generation, BitGrid state) {
+	this->check_generation(generation);
+	this->keyframes[generation] = std::move(state);
+}
+
+/**
+ * Journal::get_delta(generation)
+ *
+ * @param generation
+ *      The generation stepped from, from Journal::get_start() up to but not including Journal::get_end().
+ *
+ * @return
+ *      The delta of the step from the generation to the next.
+ *
+ * @throws
+ *      std::exception or sub-class if the step is not in the journal.
+ */
+const JournalDelta& Journal::get_delta(long long generation) const {
+	if (generation < this->start || generation >= this->get_end()) {
+		throw std::invalid_argument("Step is outside of the journal.\n");
+	}
+	return this->deltas[generation - this->start];
+}
+
+/**
+ * Journal::nearest_keyframe(target, generation)
+ *
+ * Finds the keyframe fewest steps from a target generation, if it is closer than the generation already held.
+ *
+ * @param target
+ *      The generation wanted.
+ *
+ * @param generation
+ *      The generation of the state already held. Set to the keyframe's generation if one is returned.
+ *
+ * @return
+ *      The keyframe, or null if the state already held is at least as close.
+ */
+const BitGrid* Journal::nearest_keyframe(long long target, long long &generation) const {
+	const BitGrid *nearest = nullptr;
+	long long distance = (generation > target) ? generation - target : target - generation;
+
+	//only the keyframes either side of the target can be nearest
+	auto after = this->keyframes.lower_bound(target);
+	if (after != this->keyframes.end() && after->first - target < distance) {
+		nearest = &after->second;
+		distance = after->first - target;
+		generation = after->first;
+	}
+	if (after != this->keyframes.begin()) {
+		auto before = std::prev(after);
+		if (target - before->first < distance) {
+			nearest = &before->second;
+			generation = before->first;
+		}
+	}
+	return nearest;
+}
+
+/**
+ * Journal::get_population(generation)
+ *
+ * @return
+ *      The population at a generation in the journal.
+ *
+ * @throws
+ *      std::exception or sub-class if the generation is outside the journal.
+ */
+long long Journal::get_population(long long generation) const {
+	this->check_generation(generation);
+	return (generation == this->start) ? this->startPopulation : this->deltas[generation - this->start - 1].population;
+}
+
+/**
+ * Journal::get_counts(generation, births, deaths)
+ *
+ * Gets the births and deaths of the step that led to a generation in the journal.
+ *
+ * @throws
+ *      std::exception or sub-class if the generation is outside the journal.
+ */
+void Journal::get_counts(long long generation, long long &births, long long &deaths) const {
+	this->check_generation(generation);
+	if (generation == this->start) {
+		births = this->startBirths;
+		deaths = this->startDeaths;
+	} else {
+		births = this->deltas[generation - this->start - 1].births;
+		deaths = this->deltas[generation - this->start - 1].deaths;
+	}
+}
+
+/**
+ * Journal::check_generation(generation)
+ *
+ * Private helper which throws if a generation is not held by the journal.
+ */
+void Journal::check_generation(long long generation) const {
+	if (generation < this->start || generation > this->get_end()) {
+		throw std::invalid_argument("Generation is outside of the journal.\n");
+	}
+}
@@ -0,0 +1,72 @@
+/**
+ * Declares a bounded journal of a world's recent generations, for stepping back through them.
+ * Rich documentation for the api and behaviour the Journal class can be found in journal.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "bitgrid.h"
+
+/**
+ * The change made by one step, as the words of the BitGrid layout that changed.
+ * Word indices[i] (row * words per row + word) is xor'ed with masks[i], which takes the state either
+ * forwards across the step or back.
+ */
+struct JournalDelta {
+	std::vector<uint64_t> indices;
+	std::vector<uint64_t> masks;
+	long long births;
+	long long deaths;
+	//the population after the step
+	long long population;
+};
+
+/**
+ * Declare the structure of the Journal class.
+ *
+ * A Journal holds the deltas of the last capacity steps in a ring, plus a packed keyframe of every
+ * generation that is a multiple of the keyframe interval, so memory grows with how much changes rather
+ * than with the size of the board.
+ * It does not hold the state itself: the world it belongs to applies the deltas to its own state.
+ */
+class Journal {
+public:
+	Journal();
+	Journal(int capacity, int keyframe_interval);
+
+	int get_capacity() const;
+	int get_keyframe_interval() const;
+	long long get_start() const;
+	long long get_end() const;
+	size_t get_bytes() const;
+
+	void reset(long long generation, long long population, long long births, long long deaths);
+	JournalDelta& record(long long generation);
+	bool wants_keyframe(long long generation) const;
+	void add_keyframe(long long generation, BitGrid state);
+
+	const JournalDelta& get_delta(long long generation) const;
+	const BitGrid* nearest_keyframe(long long target, long long &generation) const;
+	long long get_population(long long generation) const;
+	void get_counts(long long generation, long long &births, long long &deaths) const;
+
+private:
+	int capacity, keyframeInterval;
+	//deltas[i] takes generation start + i to start + i + 1
+	std::deque<JournalDelta> deltas;
+	std::map<long long, BitGrid> keyframes;
+	long long start;
+	long long startPopulation, startBirths, startDeaths;
+	//the buffers of a dropped delta, kept for reuse by the next record
+	JournalDelta spare;
+
+	void check_generation(long long generation) const;
+};
@@ -0,0 +1,117 @@
+/**
+ * Declares the bit-parallel building blocks shared by the kernels that step bit-packed cells under Life-like rules.
+ *
+ * Words follow the BitGrid layout: bit i of a word is the cell at x = i within its 64 cell run.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "rule.h"
+
+/**
+ * full_add(a, b, c, sum, carry)
+ *
+ * Adds three bit planes, producing a sum plane and a carry plane.
+ */
+inline void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t &sum, uint64_t &carry) {
+	uint64_t partial = a ^ b;
+	sum = partial ^ c;
+	carry = (a & b) | (partial & c);
+}
+
+/**
+ * life_word(aboveLeft, above, aboveRight, middleLeft, middle, middleRight, belowLeft, below, belowRight)
+ *
+ * Applies Conway's rules to 64 cells at once.
+ *
+ * middle holds the cells themselves. The other eight words hold, for every bit, one of its neighbours:
+ * the rows above and below, each shifted so that bit i holds the cell to the left, directly above/below,
+ * or to the right of cell i, and the middle row shifted left and right.
+ *
+ * The neighbours are summed with full adders into a 3 bit count per cell. A count of 8 wraps to 0,
+ * which is harmless since both mean the cell is dead next generation. The cell is then alive where
+ * count == 3, or where count == 2 and it is already alive.
+ */
+inline uint64_t life_word(uint64_t aboveLeft, uint64_t above, uint64_t aboveRight,
+		uint64_t middleLeft, uint64_t middle, uint64_t middleRight,
+		uint64_t belowLeft, uint64_t below, uint64_t belowRight) {
+	//count the three cells above and the three below, each as a 2 bit number
+	uint64_t above0, above1, below0, below1;
+	full_add(aboveLeft, above, aboveRight, above0, above1);
+	full_add(belowLeft, below, belowRight, below0, below1);
+
+	//the two side neighbours as a 2 bit number
+	uint64_t side0 = middleLeft ^ middleRight;
+	uint64_t side1 = middleLeft & middleRight;
+
+	//add the three 2 bit numbers into a 3 bit count (mod 8)
+	uint64_t count0, carry1, twos, carry2;
+	full_add(above0, below0, side0, count0, carry1);
+	full_add(above1, below1, side1, twos, carry2);
+	uint64_t count1 = twos ^ carry1;
+	uint64_t count2 = carry2 ^ (twos & carry1);
+
+	//alive next generation on exactly 3, or on exactly 2 if already alive
+	return count1 & ~count2 & (count0 | middle);
+}
+
+/**
+ * count_word(aboveLeft, above, aboveRight, middleLeft, middleRight, belowLeft, below, belowRight, count)
+ *
+ * Sums the eight neighbour planes of 64 cells (see life_word) into a full 4 bit count per cell,
+ * count[k] holding bit k of every count.
+ */
+inline void count_word(uint64_t aboveLeft, uint64_t above, uint64_t aboveRight,
+		uint64_t middleLeft, uint64_t middleRight,
+		uint64_t belowLeft, uint64_t below, uint64_t belowRight, uint64_t count[4]) {
+	uint64_t above0, above1, below0, below1;
+	full_add(aboveLeft, above, aboveRight, above0, above1);
+	full_add(belowLeft, below, belowRight, below0, below1);
+	uint64_t side0 = middleLeft ^ middleRight;
+	uint64_t side1 = middleLeft & middleRight;
+
+	uint64_t carry1, twos, carry2;
+	full_add(above0, below0, side0, count[0], carry1);
+	full_add(above1, below1, side1, twos, carry2);
+	count[1] = twos ^ carry1;
+	uint64_t fours = twos & carry1;
+	count[2] = carry2 ^ fours;
+	count[3] = carry2 & fours;
+}
+
+/**
+ * rule_word(rule, aboveLeft, above, aboveRight, middleLeft, middle, middleRight, belowLeft, below, belowRight)
+ *
+ * Applies a Life-like rule to 64 cells at once. For each neighbour count n the rule allows, the cells
+ * whose count equals n are selected with and/not of the count planes, so with a StaticRule the loop
+ * folds down to just the counts in the rule. Conway's rule uses the shorter life_word.
+ */
+template<typename RuleType>
+inline uint64_t rule_word(const RuleType &rule, uint64_t aboveLeft, uint64_t above, uint64_t aboveRight,
+		uint64_t middleLeft, uint64_t middle, uint64_t middleRight,
+		uint64_t belowLeft, uint64_t below, uint64_t belowRight) {
+	if constexpr (std::is_same<RuleType, ConwayRule>::value) {
+		return life_word(aboveLeft, above, aboveRight, middleLeft, middle, middleRight, belowLeft, below, belowRight);
+	} else {
+		uint64_t count[4];
+		count_word(aboveLeft, above, aboveRight, middleLeft, middleRight, belowLeft, below, belowRight, count);
+
+		uint64_t result = 0;
+		for (int n = 0; n <= 8; n++) {
+			if (((rule.birth | rule.survival) >> n) & 1) {
+				uint64_t equal = ~(uint64_t)0;
+				for (int k = 0; k < 4; k++) {
+					equal &= ((n >> k) & 1) ? count[k] : ~count[k];
+				}
+				uint64_t keep = (((rule.birth >> n) & 1) ? ~middle : 0) | (((rule.survival >> n) & 1) ? middle : 0);
+				result |= equal & keep;
+			}
+		}
+		return result;
+	}
+}
@@ -0,0 +1,519 @@
+/**
+ * Implements a class that shows a running world live in the terminal, drawn on its own thread at a fixed frame rate.
+ *      - The simulation never waits on the terminal: it steps flat out and hands over a sample when one is wanted,
+ *        copying only the window on show. The viewer draws the latest sample once per frame, so a fast run skips
+ *        generations rather than slowing down, and a slow terminal costs frames rather than steps.
+ *      - Frames are drawn with Renderer into the alternate screen. Each line is compared with what is already
+ *        on screen and only the runs of characters that changed are rewritten, after an ANSI cursor move,
+ *        so a mostly still board costs a few bytes a frame.
+ *      - The window follows the size of the terminal, and can be panned and zoomed over boards far bigger than it:
+ *          - w a s d, h j k l or the arrow keys pan by a quarter of the window.
+ *          - + and - zoom in and out by powers of two cells per character.
+ *          - space pauses and resumes stepping, q quits.
+ *      - Keys are only read when interactive and stdin is a terminal, which is put in raw mode until the viewer stops.
+ *
+ * @example
+ *
+ *      // Watch a big soup at 30 frames per second
+ *      World world(Zoo::load("soup.rle"));
+ *      LiveViewer viewer(std::cout, 30);
+ *      viewer.set_scale(4);
+ *      while (!viewer.quit_requested()) {
+ *          world.step();
+ *          if (viewer.wants_frame()) {
+ *              viewer.offer(world.get_state(), world.get_generation());
+ *          }
+ *      }
+ *      viewer.stop();
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "live_viewer.h"
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+#include "grid_view.h"
+
+/**
+ * The settings of the terminal before it was put in raw mode.
+ */
+struct LiveViewer::Terminal {
+	termios saved;
+};
+
+//helper function appending an ANSI cursor move to a zero based line and column
+static void move_cursor(std::string &text, int line, int column) {
+	char escape[32];
+	int length = std::snprintf(escape, sizeof(escape), "\x1b[%d;%dH", line + 1, column + 1);
+	text.append(escape, length);
+}
+
+/**
+ * LiveViewer::LiveViewer(output_stream, fps, interactive)
+ *
+ * Construct a viewer, switch the console to its alternate screen and start drawing.
+ *
+ * @param output_stream
+ *      The stream of the console to draw on, usually std::cout.
+ *
+ * @param fps
+ *      Frames drawn per second. Defaults to 30.
+ *
+ * @param interactive
+ *      True to read keys from stdin, if it is a terminal. Defaults to true.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if fps is less than 1.
+ */
+LiveViewer::LiveViewer(std::ostream &output_stream, int fps, bool interactive)
+		: output(output_stream), fps(fps), interactive(interactive && isatty(STDIN_FILENO)),
+		  wanted(true), paused(false), quit(false), frames(0), bytesWritten(0) {
+	if (fps < 1) {
+		throw std::invalid_argument("Invalid frame rate.\n");
+	}
+	this->view = {0, 0, 1, 1, 1};
+	this->sampleView = this->view;
+	this->fit_terminal();
+
+	if (this->interactive) {
+		//keys arrive one at a time and are not echoed
+		this->terminal.reset(new Terminal());
+		tcgetattr(STDIN_FILENO, &this->terminal->saved);
+		termios raw = this->terminal->saved;
+		raw.c_lflag &= ~(ICANON | ECHO);
+		raw.c_cc[VMIN] = 0;
+		raw.c_cc[VTIME] = 0;
+		tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+	}
+
+	//alternate screen, hidden cursor, cleared
+	this->output << "\x1b[?1049h\x1b[?25l\x1b[2J" << std::flush;
+	this->drawer = std::thread(&LiveViewer::work, this);
+}
+
+/**
+ * LiveViewer::~LiveViewer()
+ *
+ * Stop the viewer if it has not been already, see LiveViewer::stop.
+ */
+LiveViewer::~LiveViewer() {
+	this->stop();
+}
+
+/**
+ * LiveViewer::get_fps()
+ *
+ * @return
+ *      The frames drawn per second.
+ */
+int LiveViewer::get_fps() const {
+	return this->fps;
+}
+
+/**
+ * LiveViewer::is_interactive()
+ *
+ * @return
+ *      True if keys are read from the terminal.
+ */
+bool LiveViewer::is_interactive() const {
+	return this->interactive;
+}
+
+/**
+ * LiveViewer::set_position(x0, y0)
+ *
+ * Move the window so that its top left corner is the cell at (x0, y0). It may hang off the board,
+ * the cells outside are drawn dead.
+ *
+ * @param x0
+ *      The x coordinate of the left edge of the window.
+ *
+ * @param y0
+ *      The y coordinate of the top edge of the window.
+ */
+void LiveViewer::set_position(int x0, int y0) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->view.x = x0;
+	this->view.y = y0;
+	this->wanted = true;
+}
+
+/**
+ * LiveViewer::set_scale(scale)
+ *
+ * Draw one character per scale x scale block of cells, see Renderer::set_scale.
+ *
+ * @param scale
+ *      The side length in cells of the block drawn by each character.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if the scale is less than 1.
+ */
+void LiveViewer::set_scale(int scale) {
+	if (scale < 1) {
+		throw std::invalid_argument("Invalid render scale.\n");
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->view.scale = scale;
+	this->wanted = true;
+}
+
+/**
+ * LiveViewer::set_size(columns, lines)
+ *
+ * Fix the window at a number of characters across and down, instead of following the terminal.
+ *
+ * @param columns
+ *      Characters across the window, 0 to follow the terminal.
+ *
+ * @param lines
+ *      Characters down the window, 0 to follow the terminal.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if columns or lines are negative.
+ */
+void LiveViewer::set_size(int columns, int lines) {
+	if (columns < 0 || lines < 0) {
+		throw std::invalid_argument("Invalid viewer size.\n");
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->fixedColumns = columns;
+	this->fixedLines = lines;
+	this->fit_terminal();
+	this->wanted = true;
+}
+
+/**
+ * LiveViewer::wants_frame()
+ *
+ * A single relaxed read, cheap enough to check after every step.
+ *
+ * @return
+ *      True if the viewer is ready for a new sample from LiveViewer::offer.
+ */
+bool LiveViewer::wants_frame() const {
+	return this->wanted.load(std::memory_order_relaxed);
+}
+
+/**
+ * LiveViewer::offer(state, generation)
+ *
+ * Hand the viewer a sample of the state to draw at its next frame, replacing any sample not yet drawn.
+ * Only the cells inside the window are copied, the state can change as soon as this returns.
+ *
+ * @param state
+ *      The current state of the world.
+ *
+ * @param generation
+ *      The generation of the state, shown with the frame.
+ */
+void LiveViewer::offer(const Grid &state, long long generation) {
+	View taken;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		taken = this->view;
+	}
+	this->wanted = false;
+
+	//the part of the window on the board, clamped so hanging off any edge gives an empty crop
+	long long right = (long long)taken.x + (long long)taken.columns * taken.scale;
+	long long bottom = (long long)taken.y + (long long)taken.lines * taken.scale;
+	int x0 = (int)std::min<long long>(std::max(taken.x, 0), state.get_width());
+	int y0 = (int)std::min<long long>(std::max(taken.y, 0), state.get_height());
+	int x1 = (int)std::max<long long>(x0, std::min<long long>(right, state.get_width()));
+	int y1 = (int)std::max<long long>(y0, std::min<long long>(bottom, state.get_height()));
+	Grid window = GridView(state).crop(x0, y0, x1, y1).to_grid();
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	//the previous sample's buffer goes back to the GridPool
+	this->sample = std::move(window);
+	this->sampleX = x0;
+	this->sampleY = y0;
+	this->sampleView = taken;
+	this->sampleGeneration = generation;
+	this->fresh = true;
+}
+
+/**
+ * LiveViewer::is_paused()
+ *
+ * @return
+ *      True if space was pressed to pause stepping. The caller is expected to stop stepping
+ *      but keep offering samples, so the window can still be panned and zoomed.
+ */
+bool LiveViewer::is_paused() const {
+	return this->paused.load(std::memory_order_relaxed);
+}
+
+/**
+ * LiveViewer::quit_requested()
+ *
+ * @return
+ *      True once q was pressed.
+ */
+bool LiveViewer::quit_requested() const {
+	return this->quit.load(std::memory_order_relaxed);
+}
+
+/**
+ * LiveViewer::stop()
+ *
+ * Draw any sample not yet drawn, stop the viewer's thread, and put the terminal and console back as they were.
+ * Calling it again does nothing.
+ */
+void LiveViewer::stop() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->stopping) {
+			return;
+		}
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	this->drawer.join();
+
+	if (this->terminal) {
+		tcsetattr(STDIN_FILENO, TCSANOW, &this->terminal->saved);
+	}
+	//visible cursor, main screen
+	this->output << "\x1b[?25h\x1b[?1049l" << std::flush;
+}
+
+/**
+ * LiveViewer::get_frames()
+ *
+ * @return
+ *      The number of frames drawn so far.
+ */
+long long LiveViewer::get_frames() const {
+	return this->frames.load(std::memory_order_relaxed);
+}
+
+/**
+ * LiveViewer::get_bytes_written()
+ *
+ * @return
+ *      The number of bytes written to the console by frames so far.
+ */
+long long LiveViewer::get_bytes_written() const {
+	return this->bytesWritten.load(std::memory_order_relaxed);
+}
+
+/**
+ * LiveViewer::work()
+ *
+ * Private helper run by the viewer's thread: read keys until each frame is due, then draw the latest sample.
+ * A frame that runs late pushes the next one back rather than drawing a burst to catch up.
+ */
+void LiveViewer::work() {
+	auto period = std::chrono::microseconds(1000000 / this->fps);
+	auto next = std::chrono::steady_clock::now();
+
+	while (true) {
+		next += period;
+		auto now = std::chrono::steady_clock::now();
+		if (next < now) {
+			next = now;
+		}
+		if (this->interactive) {
+			while (now < next) {
+				int milliseconds = (int)std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count();
+				this->read_keys(std::max(milliseconds, 1));
+				now = std::chrono::steady_clock::now();
+			}
+		}
+
+		View drawn;
+		int x = 0, y = 0;
+		long long generation = 0;
+		bool draw = false, done;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			if (!this->interactive) {
+				this->wake.wait_until(lock, next, [this] { return this->stopping; });
+			}
+			if (this->fresh) {
+				std::swap(this->drawing, this->sample);
+				drawn = this->sampleView;
+				x = this->sampleX;
+				y = this->sampleY;
+				generation = this->sampleGeneration;
+				this->fresh = false;
+				draw = true;
+			}
+			this->fit_terminal();
+			done = this->stopping;
+		}
+
+		if (draw) {
+			this->draw(drawn, x, y, generation);
+		}
+		this->wanted = true;
+		if (done) {
+			return;
+		}
+	}
+}
+
+/**
+ * LiveViewer::draw(drawn, x, y, generation)
+ *
+ * Private helper which draws the sample held in drawing, whose top left cell is (x, y) on the board,
+ * rewriting only what changed since the last frame. A change of window size redraws everything.
+ */
+void LiveViewer::draw(const View &drawn, int x, int y, long long generation) {
+	this->renderer.set_scale(drawn.scale);
+	this->renderer.set_viewport(drawn.x - x, drawn.y - y, drawn.columns * drawn.scale, drawn.lines * drawn.scale);
+	const std::string &frame = this->renderer.render(this->drawing);
+
+	char status[256];
+	int statusLength = std::snprintf(status, sizeof(status), "Generation %lld | x %d y %d | scale %d%s%s",
+			generation, drawn.x, drawn.y, drawn.scale, this->is_paused() ? " | paused" : "",
+			this->interactive ? " | wasd/arrows pan, +/- zoom, space pause, q quit" : "");
+	//cut to the width of the frame, so it never wraps onto the frame below
+	statusLength = std::min<int>(std::min<int>(statusLength, sizeof(status) - 1), drawn.columns + 2);
+
+	//the status line, then the bordered frame
+	size_t lineCount = 1 + drawn.lines + 2;
+	this->text.clear();
+	if (this->shown.size() != lineCount || (lineCount > 1 && this->shown[1].size() != (size_t)drawn.columns + 2)) {
+		this->text += "\x1b[2J";
+		this->shown.assign(lineCount, std::string());
+	}
+
+	size_t offset = 0;
+	for (size_t line = 0; line < lineCount; line++) {
+		const char *characters;
+		size_t length;
+		if (line == 0) {
+			characters = status;
+			length = statusLength;
+		} else {
+			size_t end = frame.find('\n', offset);
+			characters = frame.data() + offset;
+			length = end - offset;
+			offset = end + 1;
+		}
+
+		std::string &old = this->shown[line];
+		size_t column = 0;
+		while (column < length) {
+			if (column < old.size() && old[column] == characters[column]) {
+				column++;
+				continue;
+			}
+			//a few matching characters are cheaper to rewrite than to jump over with another cursor move
+			size_t end = column + 1, matching = 0;
+			while (end < length && matching < 8) {
+				matching = (end < old.size() && old[end] == characters[end]) ? matching + 1 : 0;
+				end++;
+			}
+			end -= matching;
+			move_cursor(this->text, (int)line, (int)column);
+			this->text.append(characters + column, end - column);
+			column = end;
+		}
+		if (old.size() > length) {
+			move_cursor(this->text, (int)line, (int)length);
+			this->text += "\x1b[K";
+		}
+		old.assign(characters, length);
+	}
+
+	if (!this->text.empty()) {
+		this->output.write(this->text.data(), this->text.size());
+	}
+	this->output.flush();
+	this->frames++;
+	this->bytesWritten += (long long)this->text.size();
+}
+
+/**
+ * LiveViewer::read_keys(milliseconds)
+ *
+ * Private helper which waits up to a number of milliseconds for keys on stdin and handles any that arrive.
+ * The arrow keys' escape sequences are turned into the matching w a s d key.
+ */
+void LiveViewer::read_keys(int milliseconds) {
+	pollfd input = {STDIN_FILENO, POLLIN, 0};
+	if (poll(&input, 1, milliseconds) <= 0) {
+		return;
+	}
+	char keys[64];
+	ssize_t count = read(STDIN_FILENO, keys, sizeof(keys));
+	for (ssize_t i = 0; i < count; i++) {
+		if (keys[i] == '\x1b' && i + 2 < count && keys[i + 1] == '[') {
+			const char arrows[] = {'w', 's', 'd', 'a'};
+			if (keys[i + 2] >= 'A' && keys[i + 2] <= 'D') {
+				this->handle_key(arrows[keys[i + 2] - 'A']);
+			}
+			i += 2;
+			continue;
+		}
+		this->handle_key(keys[i]);
+	}
+}
+
+/**
+ * LiveViewer::handle_key(key)
+ *
+ * Private helper which pans, zooms, pauses or quits for a key press.
+ */
+void LiveViewer::handle_key(char key) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	View &v = this->view;
+	int stepX = std::max(1, v.columns * v.scale / 4);
+	int stepY = std::max(1, v.lines * v.scale / 4);
+
+	switch (key) {
+		case 'w': case 'k': v.y -= stepY; break;
+		case 's': case 'j': v.y += stepY; break;
+		case 'a': case 'h': v.x -= stepX; break;
+		case 'd': case 'l': v.x += stepX; break;
+		case '+': case '=': case '-': case '_': {
+			//zoom about the centre of the window
+			int centreX = v.x + v.columns * v.scale / 2;
+			int centreY = v.y + v.lines * v.scale / 2;
+			bool in = (key == '+' || key == '=');
+			v.scale = in ? std::max(1, v.scale / 2) : std::min(v.scale * 2, 1 << 20);
+			v.x = centreX - v.columns * v.scale / 2;
+			v.y = centreY - v.lines * v.scale / 2;
+			break;
+		}
+		case ' ': this->paused = !this->paused; break;
+		case 'q': case 'Q': this->quit = true; break;
+		default: return;
+	}
+	this->wanted = true;
+}
+
+/**
+ * LiveViewer::fit_terminal()
+ *
+ * Private helper which sizes the window to the fixed size, or else to the terminal less the status line and border.
+ * Must be called with the mutex held.
+ */
+void LiveViewer::fit_terminal() {
+	int columns = this->fixedColumns, lines = this->fixedLines;
+	winsize size;
+	bool terminal = ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0;
+	if (columns == 0) {
+		columns = terminal ? size.ws_col - 2 : 78;
+	}
+	if (lines == 0) {
+		lines = terminal ? size.ws_row - 3 : 21;
+	}
+	this->view.columns = std::max(1, columns);
+	this->view.lines = std::max(1, lines);
+}
@@ -0,0 +1,105 @@
+/**
+ * Declares a class that shows a running world live in the terminal, drawn on its own thread at a fixed frame rate.
+ * Rich documentation for the api and behaviour the LiveViewer class can be found in live_viewer.cpp.
+ *
+ * Needs a POSIX terminal (termios, poll) and an ANSI/VT100 compatible console.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "grid.h"
+#include "renderer.h"
+
+/**
+ * Declare the structure of the LiveViewer class.
+ *
+ * The simulation thread offers the viewer samples of the state with LiveViewer::offer, ideally only when
+ * LiveViewer::wants_frame is true. Only the window on show is copied, so offering is cheap however big the board.
+ * The viewer's thread draws the latest sample once per frame, rewriting only the characters that changed,
+ * and reads keys to pan, zoom, pause and quit.
+ */
+class LiveViewer {
+public:
+	explicit LiveViewer(std::ostream &output_stream, int fps = 30, bool interactive = true);
+	~LiveViewer();
+
+	LiveViewer(const LiveViewer &) = delete;
+	LiveViewer& operator=(const LiveViewer &) = delete;
+
+	int get_fps() const;
+	bool is_interactive() const;
+
+	void set_position(int x0, int y0);
+	void set_scale(int scale);
+	void set_size(int columns, int lines);
+
+	bool wants_frame() const;
+	void offer(const Grid &state, long long generation);
+
+	bool is_paused() const;
+	bool quit_requested() const;
+	void stop();
+
+	long long get_frames() const;
+	long long get_bytes_written() const;
+
+private:
+	//the window of the board on show: its top left cell, cells per character, and characters across and down
+	struct View {
+		int x, y;
+		int scale;
+		int columns, lines;
+	};
+	//the terminal settings to put back, defined in live_viewer.cpp
+	struct Terminal;
+
+	std::ostream &output;
+	int fps;
+	bool interactive;
+	std::unique_ptr<Terminal> terminal;
+
+	//guards everything down to the flags
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	View view;
+	//a fixed size from set_size, otherwise the terminal's size is followed
+	int fixedColumns = 0, fixedLines = 0;
+	//the latest sample, its top left cell on the board, and the view it was taken for
+	Grid sample;
+	int sampleX = 0, sampleY = 0;
+	View sampleView;
+	long long sampleGeneration = 0;
+	bool fresh = false;
+	bool stopping = false;
+
+	std::atomic<bool> wanted;
+	std::atomic<bool> paused;
+	std::atomic<bool> quit;
+	std::atomic<long long> frames;
+	std::atomic<long long> bytesWritten;
+
+	//used only by the viewer's thread
+	Renderer renderer;
+	Grid drawing;
+	std::vector<std::string> shown;
+	std::string text;
+
+	std::thread drawer;
+
+	void work();
+	void draw(const View &drawn, int x, int y, long long generation);
+	void read_keys(int milliseconds);
+	void handle_key(char key);
+	void fit_terminal();
+};
@@ -0,0 +1,256 @@
+/**
+ * Implements a class for drawing grids as bordered ascii frames.
+ *
+ * Frames use the same layout as operator<< on a Grid: a border of - (dash), | (pipe) and + (plus) characters
+ * around the cells, with alive cells drawn as # (hash) and dead cells as ' ' (space).
+ *
+ * To watch worlds far larger than a terminal, a renderer can be limited to a viewport (a window of the grid)
+ * and can downsample, drawing one character per scale x scale block of cells. A block is drawn as # when
+ * any of its cells are alive.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "renderer.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+
+/**
+ * Renderer::Renderer()
+ *
+ * Construct a renderer that draws the whole grid at one character per cell.
+ *
+ * @example
+ *
+ *      Renderer renderer;
+ *      renderer.print(std::cout, world.get_state());
+ */
+Renderer::Renderer() : hasViewport(false), viewX(0), viewY(0), viewWidth(0), viewHeight(0), scale(1) {
+}
+
+/**
+ * Renderer::set_viewport(x0, y0, width, height)
+ *
+ * Only draw the width x height window of the grid with its top left corner at (x0, y0).
+ * Parts of the viewport outside of the grid are drawn as dead cells.
+ *
+ * @example
+ *
+ *      // Watch a 80x40 window in the middle of a huge world
+ *      Renderer renderer;
+ *      renderer.set_viewport(5000, 5000, 80, 40);
+ *
+ * @param x0
+ *      The x coordinate of the left edge of the viewport.
+ *
+ * @param y0
+ *      The y coordinate of the top edge of the viewport.
+ *
+ * @param width
+ *      The number of cells across the viewport.
+ *
+ * @param height
+ *      The number of cells down the viewport.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if the width or height are negative.
+ */
+void Renderer::set_viewport(int x0, int y0, int width, int height) {
+	if (width < 0 || height < 0) {
+		throw std::invalid_argument("Invalid viewport size.\n");
+	}
+	this->hasViewport = true;
+	this->viewX = x0;
+	this->viewY = y0;
+	this->viewWidth = width;
+	this->viewHeight = height;
+}
+
+/**
+ * Renderer::clear_viewport()
+ *
+ * Go back to drawing the whole grid.
+ */
+void Renderer::clear_viewport() {
+	this->hasViewport = false;
+}
+
+/**
+ * Renderer::set_scale(scale)
+ *
+ * Draw one character per scale x scale block of cells. A scale of 1 draws every cell.
+ *
+ * @example
+ *
+ *      // Fit a 4096x4096 world in 128x128 characters
+ *      Renderer renderer;
+ *      renderer.set_scale(32);
+ *
+ * @param scale
+ *      The side length in cells of the block drawn by each character.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if the scale is less than 1.
+ */
+void Renderer::set_scale(int scale) {
+	if (scale < 1) {
+		throw std::invalid_argument("Invalid render scale.\n");
+	}
+	this->scale = scale;
+}
+
+/**
+ * Renderer::get_scale()
+ *
+ * @return
+ *      Returns the side length in cells of the block drawn by each character.
+ */
+int Renderer::get_scale() const {
+	return this->scale;
+}
+
+/**
+ * Renderer::render(grid)
+ *
+ * Draw a frame of the grid into the renderer's buffer, honouring the viewport and scale.
+ *
+ * @example
+ *
+ *      Renderer renderer;
+ *      const std::string &frame = renderer.render(Zoo::glider());
+ *
+ *      +---+
+ *      | # |
+ *      |  #|
+ *      |###|
+ *      +---+
+ *
+ * @param grid
+ *      The grid to draw.
+ *
+ * @return
+ *      Returns a reference to the frame, valid until the next call to render or print.
+ */
+const std::string& Renderer::render(const Grid &grid) {
+	return this->render(GridView(grid));
+}
+
+/**
+ * Renderer::render(grid)
+ *
+ * Draw a frame of a view of a grid, e.g. a cropped or rotated region of a board, without copying it out.
+ *
+ * @param grid
+ *      The view to draw.
+ *
+ * @return
+ *      Returns a reference to the frame, valid until the next call to render or print.
+ */
+const std::string& Renderer::render(const GridView &grid) {
+	Stats::Timer timer(Stats::RENDER);
+	int x0 = this->hasViewport ? this->viewX : 0;
+	int y0 = this->hasViewport ? this->viewY : 0;
+	int width = this->hasViewport ? this->viewWidth : grid.get_width();
+	int height = this->hasViewport ? this->viewHeight : grid.get_height();
+
+	//characters across and down the frame, a partial block still gets a character
+	int columns = (width + this->scale - 1) / this->scale;
+	int lines = (height + this->scale - 1) / this->scale;
+
+	//lay out the border and blank cells once, then only alive cells need writing
+	size_t lineLength = columns + 3;
+	this->frame.assign(lineLength * (lines + 2), ' ');
+	//the top and bottom borders are written in place, so a frame no bigger than the last one never allocates
+	for (size_t start : {(size_t)0, lineLength * (lines + 1)}) {
+		char *text = &this->frame[start];
+		text[0] = '+';
+		std::fill(text + 1, text + 1 + columns, '-');
+		text[columns + 1] = '+';
+		text[columns + 2] = '\n';
+	}
+	for (int line = 0; line < lines; line++) {
+		char *text = &this->frame[lineLength * (line + 1)];
+		text[0] = '|';
+		text[columns + 1] = '|';
+		text[columns + 2] = '\n';
+	}
+
+	//only the part of the window that overlaps the grid has cells to draw
+	int left = std::max(x0, 0);
+	int top = std::max(y0, 0);
+	int right = (int)std::min<long long>((long long)x0 + width, grid.get_width());
+	int bottom = (int)std::min<long long>((long long)y0 + height, grid.get_height());
+
+	for (int y = top; y < bottom; y++) {
+		char *text = &this->frame[lineLength * ((y - y0) / this->scale + 1) + 1];
+		if (!grid.is_contiguous()) {
+			//a rotated or transposed view is read a cell at a time
+			for (int x = left; x < right; x++) {
+				if (grid(x, y) == ALIVE) {
+					text[(x - x0) / this->scale] = '#';
+				}
+			}
+			continue;
+		}
+		const Cell *row = grid.row(y);
+		if (this->scale == 1) {
+			for (int x = left; x < right; x++) {
+				if (row[x] == ALIVE) {
+					text[x - x0] = '#';
+				}
+			}
+			continue;
+		}
+		for (int x = left; x < right; x++) {
+			if (row[x] == ALIVE) {
+				text[(x - x0) / this->scale] = '#';
+			}
+		}
+	}
+
+	return this->frame;
+}
+
+/**
+ * Renderer::print(output_stream, grid)
+ *
+ * Draw a frame of the grid and write it to a stream in a single write.
+ *
+ * @example
+ *
+ *      // Print a world every step without one stream call per cell
+ *      Renderer renderer;
+ *      for (int step = 0; step < steps; step++) {
+ *          world.step();
+ *          renderer.print(std::cout, world.get_state());
+ *      }
+ *
+ * @param output_stream
+ *      An ascii mode output stream such as std::cout.
+ *
+ * @param grid
+ *      The grid to draw.
+ */
+void Renderer::print(std::ostream &output_stream, const Grid &grid) {
+	const std::string &text = this->render(grid);
+	output_stream.write(text.data(), text.size());
+}
+
+/**
+ * Renderer::print(output_stream, grid)
+ *
+ * Draw a frame of a view of a grid and write it to a stream in a single write.
+ *
+ * @param output_stream
+ *      An ascii mode output stream such as std::cout.
+ *
+ * @param grid
+ *      The view to draw.
+ */
+void Renderer::print(std::ostream &output_stream, const GridView &grid) {
+	const std::string &text = this->render(grid);
+	output_stream.write(text.data(), text.size());
+}
@@ -0,0 +1,41 @@
+/**
+ * Declares a class for drawing grids as bordered ascii frames.
+ * Rich documentation for the api and behaviour the Renderer class can be found in renderer.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "grid.h"
+#include "grid_view.h"
+
+/**
+ * Declare the structure of the Renderer class.
+ *
+ * A renderer keeps one frame buffer and reuses it for every frame it draws, so printing a world every
+ * step costs a single write per frame and no allocations once the buffer has grown to size.
+ */
+class Renderer {
+public:
+	Renderer();
+
+	void set_viewport(int x0, int y0, int width, int height);
+	void clear_viewport();
+	void set_scale(int scale);
+	int get_scale() const;
+
+	const std::string& render(const Grid &grid);
+	const std::string& render(const GridView &grid);
+	void print(std::ostream &output_stream, const Grid &grid);
+	void print(std::ostream &output_stream, const GridView &grid);
+
+private:
+	std::string frame;
+	bool hasViewport;
+	int viewX, viewY, viewWidth, viewHeight;
+	int scale;
+};
@@ -0,0 +1,111 @@
+/**
+ * Implements the Life-like rules World can step with.
+ *      - Rules are written in B/S notation: B followed by the neighbour counts that bring a dead cell to life,
+ *        a slash, then S followed by the counts that keep an alive cell alive. Conway's Game of Life is B3/S23.
+ *        https://www.conwaylife.com/wiki/Rulestring
+ *      - The older S/B form without letters ("23/3", survival first) is accepted too.
+ *      - Common rules (Conway, HighLife, Seeds, Day & Night, Life without Death) are StaticRule types with
+ *        kernels instantiated for them ahead of time, any other rule runs on the same kernels with its
+ *        tables read at runtime.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "rule.h"
+
+#include <cctype>
+#include <stdexcept>
+
+//helper function reading a run of neighbour count digits into a bit mask, stopping at the first non-digit
+static uint16_t parse_counts(const std::string &text, size_t &at) {
+	uint16_t mask = 0;
+	while (at < text.size() && std::isdigit((unsigned char)text[at])) {
+		int count = text[at] - '0';
+		if (count > 8) {
+			throw std::invalid_argument("Invalid rule, neighbour counts must be 0 to 8.\n");
+		}
+		mask |= (uint16_t)(1 << count);
+		at++;
+	}
+	return mask;
+}
+
+/**
+ * Rule::parse(notation)
+ *
+ * Parse a rule from B/S notation.
+ *
+ * @example
+ *
+ *      // HighLife, where 6 neighbours also give birth
+ *      Rule highLife = Rule::parse("B36/S23");
+ *
+ *      // Seeds, where no cell survives
+ *      Rule seeds = Rule::parse("B2/S");
+ *
+ * @param notation
+ *      The rule in B/S notation, case insensitive, or in S/B notation such as "23/3".
+ *
+ * @return
+ *      Returns the parsed rule.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if the notation is not a valid rule.
+ */
+Rule Rule::parse(const std::string &notation) {
+	std::string text;
+	for (char c : notation) {
+		text += (char)std::toupper((unsigned char)c);
+	}
+
+	Rule rule = {0, 0};
+	size_t at = 0;
+	if (!text.empty() && text[0] == 'B') {
+		at = 1;
+		rule.birth = parse_counts(text, at);
+		if (text.compare(at, 2, "/S") != 0) {
+			throw std::invalid_argument("Invalid rule " + notation + ", expected B.../S...\n");
+		}
+		at += 2;
+		rule.survival = parse_counts(text, at);
+	} else {
+		rule.survival = parse_counts(text, at);
+		if (at >= text.size() || text[at] != '/') {
+			throw std::invalid_argument("Invalid rule " + notation + ", expected B.../S...\n");
+		}
+		at++;
+		rule.birth = parse_counts(text, at);
+	}
+
+	if (at != text.size()) {
+		throw std::invalid_argument("Invalid rule " + notation + ", expected B.../S...\n");
+	}
+	return rule;
+}
+
+/**
+ * Rule::to_string()
+ *
+ * @example
+ *
+ *      // Prints B3/S23
+ *      std::cout << Rule(ConwayRule()).to_string() << std::endl;
+ *
+ * @return
+ *      Returns the rule in B/S notation.
+ */
+std::string Rule::to_string() const {
+	std::string text = "B";
+	for (int n = 0; n <= 8; n++) {
+		if ((this->birth >> n) & 1) {
+			text += (char)('0' + n);
+		}
+	}
+	text += "/S";
+	for (int n = 0; n <= 8; n++) {
+		if ((this->survival >> n) & 1) {
+			text += (char)('0' + n);
+		}
+	}
+	return text;
+}
@@ -0,0 +1,97 @@
+/**
+ * Declares the Life-like rules (B/S notation) that World can step with.
+ * Rich documentation for the api and behaviour of the rule types can be found in rule.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * A Life-like rule chosen at runtime, e.g. parsed from "B36/S23".
+ * Bit n of birth is set if a dead cell with n alive neighbours comes to life,
+ * bit n of survival is set if an alive cell with n alive neighbours stays alive.
+ */
+struct Rule {
+	uint16_t birth;
+	uint16_t survival;
+
+	static Rule parse(const std::string &notation);
+	std::string to_string() const;
+
+	bool operator==(const Rule &other) const {
+		return this->birth == other.birth && this->survival == other.survival;
+	}
+
+	bool operator!=(const Rule &other) const {
+		return !(*this == other);
+	}
+
+	//the next state of a cell with (neighbours) alive neighbours
+	bool next(int neighbours, bool alive) const {
+		return ((((alive ? this->survival : this->birth) >> neighbours) & 1) != 0);
+	}
+};
+
+/**
+ * A Life-like rule fixed at compile time. Kernels templated on a StaticRule get their own instantiation
+ * with the rule tables folded in as constants.
+ */
+template<uint16_t Birth, uint16_t Survival>
+struct StaticRule {
+	static constexpr uint16_t birth = Birth;
+	static constexpr uint16_t survival = Survival;
+
+	//next state indexed by alive * 9 + neighbours
+	static constexpr std::array<bool, 18> table = [] {
+		std::array<bool, 18> result = {};
+		for (int n = 0; n <= 8; n++) {
+			result[n] = ((Birth >> n) & 1) != 0;
+			result[9 + n] = ((Survival >> n) & 1) != 0;
+		}
+		return result;
+	}();
+
+	constexpr bool next(int neighbours, bool alive) const {
+		return table[alive * 9 + neighbours];
+	}
+
+	constexpr operator Rule() const {
+		return Rule{Birth, Survival};
+	}
+};
+
+//the rules with pre-instantiated kernels
+using ConwayRule = StaticRule<(1 << 3), (1 << 2) | (1 << 3)>;
+using HighLifeRule = StaticRule<(1 << 3) | (1 << 6), (1 << 2) | (1 << 3)>;
+using SeedsRule = StaticRule<(1 << 2), 0>;
+using DayAndNightRule = StaticRule<(1 << 3) | (1 << 6) | (1 << 7) | (1 << 8),
+		(1 << 3) | (1 << 4) | (1 << 6) | (1 << 7) | (1 << 8)>;
+using LifeWithoutDeathRule = StaticRule<(1 << 3), 0x1FF>;
+
+/**
+ * with_rule(rule, function)
+ *
+ * Calls function with the StaticRule matching rule when it has a pre-instantiated kernel,
+ * and with the runtime Rule itself otherwise. function must accept either, e.g. a generic lambda.
+ */
+template<typename Function>
+inline void with_rule(const Rule &rule, Function &&function) {
+	if (rule == ConwayRule()) {
+		function(ConwayRule());
+	} else if (rule == HighLifeRule()) {
+		function(HighLifeRule());
+	} else if (rule == SeedsRule()) {
+		function(SeedsRule());
+	} else if (rule == DayAndNightRule()) {
+		function(DayAndNightRule());
+	} else if (rule == LifeWithoutDeathRule()) {
+		function(LifeWithoutDeathRule());
+	} else {
+		function(rule);
+	}
+}
@@ -0,0 +1,206 @@
+/**
+ * Implements the process wide instrumentation of the hot paths.
+ *      - Timers cover whole phases (a step, a file load, a frame), never single cells, so the cost
+ *        is two clock reads and two relaxed atomic adds per phase.
+ *      - Allocation counts are read from the Allocations counters kept by GridAllocator.
+ *      - Like the Allocations counters these only ever increase, so take a reading before and after
+ *        the code being measured and subtract.
+ *      - With GOL_NO_STATS defined the timers are empty and every reading is zero.
+ *
+ * @example
+ *
+ *      // Measure 100 steps and print them as a json line
+ *      Stats::Summary before = Stats::get_summary();
+ *      world.advance(100);
+ *      std::cout << Stats::to_json(Stats::get_summary() - before, world.get_generation()) << std::endl;
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "stats.h"
+
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+
+#include "grid_allocator.h"
+
+static std::atomic<unsigned long long> phaseNanoseconds[Stats::PHASE_COUNT];
+static std::atomic<unsigned long long> phaseCalls[Stats::PHASE_COUNT];
+static std::atomic<unsigned long long> cellCount(0);
+
+/**
+ * Stats::Summary::operator-(earlier)
+ *
+ * @param earlier
+ *      A reading taken before this one.
+ *
+ * @return
+ *      The counts between the two readings.
+ */
+Stats::Summary Stats::Summary::operator-(const Summary &earlier) const {
+	Summary interval;
+	for (int phase = 0; phase < PHASE_COUNT; phase++) {
+		interval.nanoseconds[phase] = this->nanoseconds[phase] - earlier.nanoseconds[phase];
+		interval.calls[phase] = this->calls[phase] - earlier.calls[phase];
+	}
+	interval.cells = this->cells - earlier.cells;
+	interval.allocations = this->allocations - earlier.allocations;
+	interval.allocatedBytes = this->allocatedBytes - earlier.allocatedBytes;
+	interval.reusedAllocations = this->reusedAllocations - earlier.reusedAllocations;
+	return interval;
+}
+
+/**
+ * Stats::enabled()
+ *
+ * @return
+ *      False if the counters were compiled away with GOL_NO_STATS.
+ */
+bool Stats::enabled() {
+#ifndef GOL_NO_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Stats::phase_name(phase)
+ *
+ * @return
+ *      The lower case name of a phase, as used for its key in Stats::to_json.
+ */
+const char* Stats::phase_name(Phase phase) {
+	switch (phase) {
+		case STEP: return "step";
+		case HALO: return "halo";
+		case SYNC: return "sync";
+		case CYCLES: return "cycles";
+		case SNAPSHOT: return "snapshot";
+		case LOAD: return "load";
+		case SAVE: return "save";
+		case RENDER: return "render";
+		case JOURNAL: return "journal";
+		default: return "unknown";
+	}
+}
+
+/**
+ * Stats::get_summary()
+ *
+ * @return
+ *      A reading of every counter so far.
+ */
+Stats::Summary Stats::get_summary() {
+	Summary summary;
+	for (int phase = 0; phase < PHASE_COUNT; phase++) {
+		summary.nanoseconds[phase] = phaseNanoseconds[phase].load(std::memory_order_relaxed);
+		summary.calls[phase] = phaseCalls[phase].load(std::memory_order_relaxed);
+	}
+	summary.cells = cellCount.load(std::memory_order_relaxed);
+	summary.allocations = Allocations::get_count();
+	summary.allocatedBytes = Allocations::get_bytes();
+	summary.reusedAllocations = Allocations::get_reused();
+	return summary;
+}
+
+//helper function giving the cells advanced per second of stepping
+static double cells_per_second(const Stats::Summary &summary) {
+	double seconds = (summary.nanoseconds[Stats::STEP] + summary.nanoseconds[Stats::HALO]) * 1e-9;
+	return (seconds > 0) ? summary.cells / seconds : 0;
+}
+
+/**
+ * Stats::to_json(summary, generation)
+ *
+ * Formats a reading as a single line json object for dashboards, e.g.
+ * {"generation":100,"cells":6553600,"cells_per_second":1.2e+09,"allocations":0,"allocated_bytes":0,"reused_allocations":0,
+ *  "phases":{"step":{"calls":100,"seconds":0.0052},...}}
+ *
+ * @param summary
+ *      The reading, or interval between two readings, to format.
+ *
+ * @param generation
+ *      The generation the reading was taken at.
+ *
+ * @return
+ *      The json object, without a trailing newline.
+ */
+std::string Stats::to_json(const Summary &summary, long long generation) {
+	std::ostringstream json;
+	json << "{\"generation\":" << generation
+	     << ",\"cells\":" << summary.cells
+	     << ",\"cells_per_second\":" << cells_per_second(summary)
+	     << ",\"allocations\":" << summary.allocations
+	     << ",\"allocated_bytes\":" << summary.allocatedBytes
+	     << ",\"reused_allocations\":" << summary.reusedAllocations
+	     << ",\"phases\":{";
+	for (int phase = 0; phase < PHASE_COUNT; phase++) {
+		json << (phase > 0 ? "," : "") << '"' << phase_name((Phase)phase) << "\":{\"calls\":" << summary.calls[phase]
+		     << ",\"seconds\":" << summary.nanoseconds[phase] * 1e-9 << '}';
+	}
+	json << "}}";
+	return json.str();
+}
+
+/**
+ * Stats::print(output_stream, summary)
+ *
+ * Prints a reading as a human readable table, one row per phase that was called.
+ *
+ * @param output_stream
+ *      The stream to print to.
+ *
+ * @param summary
+ *      The reading, or interval between two readings, to print.
+ */
+void Stats::print(std::ostream &output_stream, const Summary &summary) {
+	//the stream's formatting is put back afterwards
+	std::ios format(nullptr);
+	format.copyfmt(output_stream);
+
+	output_stream << std::left << std::setw(10) << "Phase" << std::right << std::setw(12) << "Calls"
+	              << std::setw(14) << "Seconds" << '\n';
+	for (int phase = 0; phase < PHASE_COUNT; phase++) {
+		if (summary.calls[phase] == 0) {
+			continue;
+		}
+		output_stream << std::left << std::setw(10) << phase_name((Phase)phase) << std::right
+		              << std::setw(12) << summary.calls[phase]
+		              << std::setw(14) << std::fixed << std::setprecision(6) << summary.nanoseconds[phase] * 1e-9 << '\n';
+	}
+	output_stream << "Cells advanced " << summary.cells << " (" << std::scientific << std::setprecision(3)
+	              << cells_per_second(summary) << " cells/s)\n"
+	              << "Grid allocations " << summary.allocations << " (" << summary.allocatedBytes << " bytes, "
+	              << summary.reusedAllocations << " reused from the pool)\n";
+	output_stream.copyfmt(format);
+}
+
+/**
+ * Stats::record(phase, nanoseconds)
+ *
+ * Record one call of a phase. Usually called by a Stats::Timer going out of scope.
+ *
+ * @param phase
+ *      The phase that was called.
+ *
+ * @param nanoseconds
+ *      How long the call took.
+ */
+void Stats::record(Phase phase, unsigned long long nanoseconds) {
+	phaseNanoseconds[phase].fetch_add(nanoseconds, std::memory_order_relaxed);
+	phaseCalls[phase].fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Stats::record_cells(cells)
+ *
+ * Record cells advanced by one generation. Usually called through Stats::count_cells.
+ *
+ * @param cells
+ *      The number of cells advanced.
+ */
+void Stats::record_cells(unsigned long long cells) {
+	cellCount.fetch_add(cells, std::memory_order_relaxed);
+}
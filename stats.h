@@ -0,0 +1,99 @@
+/**
+ * Declares the process wide instrumentation of the hot paths: per phase timers, cells advanced and allocations.
+ * Rich documentation for the api and behaviour of the counters can be found in stats.cpp.
+ *
+ * Define GOL_NO_STATS when compiling to compile the timers and counters away entirely.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace Stats {
+	/**
+	 * The phases of work that are timed.
+	 *      - Phase::STEP applies the rule to the cells, counting neighbours and updating in one pass.
+	 *      - Phase::HALO refreshes the halo around the board before a step.
+	 *      - Phase::SYNC unpacks the bit-packed state to cells when it is read.
+	 *      - Phase::CYCLES hashes the state for cycle detection.
+	 *      - Phase::SNAPSHOT copies the state for checkpoints.
+	 *      - Phase::LOAD and Phase::SAVE read and write files with Zoo::load and Zoo::save.
+	 *      - Phase::RENDER draws frames for printing.
+	 *      - Phase::JOURNAL records each step's delta for World::seek.
+	 */
+	enum Phase {
+		STEP,
+		HALO,
+		SYNC,
+		CYCLES,
+		SNAPSHOT,
+		LOAD,
+		SAVE,
+		RENDER,
+		JOURNAL,
+		PHASE_COUNT
+	};
+
+	/**
+	 * A reading of every counter. Readings only ever increase, so subtract an earlier one for an interval.
+	 */
+	struct Summary {
+		unsigned long long nanoseconds[PHASE_COUNT];
+		unsigned long long calls[PHASE_COUNT];
+		unsigned long long cells;
+		unsigned long allocations;
+		unsigned long allocatedBytes;
+		unsigned long reusedAllocations;
+
+		Summary operator-(const Summary &earlier) const;
+	};
+
+	bool enabled();
+	const char* phase_name(Phase phase);
+
+	Summary get_summary();
+	std::string to_json(const Summary &summary, long long generation);
+	void print(std::ostream &output_stream, const Summary &summary);
+
+	void record(Phase phase, unsigned long long nanoseconds);
+	void record_cells(unsigned long long cells);
+
+#ifndef GOL_NO_STATS
+	/**
+	 * Times the enclosing scope as one call of a phase.
+	 */
+	class Timer {
+	public:
+		explicit Timer(Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+		~Timer() {
+			record(this->phase, std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - this->start).count());
+		}
+
+		Timer(const Timer &) = delete;
+		Timer& operator=(const Timer &) = delete;
+
+	private:
+		Phase phase;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	/**
+	 * Count cells advanced by one generation.
+	 */
+	inline void count_cells(unsigned long long cells) {
+		record_cells(cells);
+	}
+#else
+	class Timer {
+	public:
+		explicit Timer(Phase) {}
+	};
+
+	inline void count_cells(unsigned long long) {}
+#endif
+};
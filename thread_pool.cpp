@@ -0,0 +1,135 @@
+/**
+ * Implements a persistent pool of worker threads.
+ *      - Threads are created when the pool is constructed and joined when it is destroyed.
+ *      - ThreadPool::run hands out a batch of numbered tasks and blocks until every task has finished.
+ *      - The calling thread works on the batch too, so a pool of N threads uses N-1 workers.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "thread_pool.h"
+
+/**
+ * ThreadPool::ThreadPool(threads)
+ *
+ * Construct a pool that runs batches on the given number of threads, including the caller.
+ *
+ * @example
+ *
+ *      // Make a pool for an 8 core machine
+ *      ThreadPool pool(8);
+ *
+ * @param threads
+ *      The number of threads to run batches on. Values below 1 are treated as 1.
+ */
+ThreadPool::ThreadPool(int threads) {
+	for (int i = 1; i < threads; i++) {
+		this->workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+/**
+ * ThreadPool::~ThreadPool()
+ *
+ * Stop and join every worker thread.
+ */
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	for (std::thread &worker : this->workers) {
+		worker.join();
+	}
+}
+
+/**
+ * ThreadPool::get_threads()
+ *
+ * @return
+ *      The number of threads batches run on, including the caller.
+ */
+int ThreadPool::get_threads() const {
+	return (int)this->workers.size() + 1;
+}
+
+/**
+ * ThreadPool::run(tasks, task)
+ *
+ * Run task(0) ... task(tasks - 1) across the pool and wait for all of them to finish.
+ * Tasks may run in any order and on any thread, so they must not depend on each other.
+ *
+ * @example
+ *
+ *      // Fill a vector in four slices
+ *      pool.run(4, [&](int i) { std::fill(slice_begin(i), slice_end(i), 0); });
+ *
+ * @param tasks
+ *      The number of tasks in the batch.
+ *
+ * @param task
+ *      The function to call with each task number.
+ */
+void ThreadPool::run(int tasks, const std::function<void(int)> &task) {
+	std::lock_guard<std::mutex> runLock(this->runMutex);
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	this->job = &task;
+	this->jobTasks = tasks;
+	this->nextTask = 0;
+	this->pendingTasks = tasks;
+	this->generation++;
+	this->wake.notify_all();
+
+	//help out until there is nothing left to start
+	while (this->run_one(lock)) {}
+
+	this->done.wait(lock, [this] { return this->pendingTasks == 0; });
+	this->job = nullptr;
+}
+
+/**
+ * ThreadPool::work()
+ *
+ * Private worker loop, waits for a new batch then takes tasks from it until the batch is exhausted.
+ */
+void ThreadPool::work() {
+	unsigned long seen = 0;
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true) {
+		this->wake.wait(lock, [&] { return this->stopping || this->generation != seen; });
+		if (this->stopping) {
+			return;
+		}
+		seen = this->generation;
+		while (this->run_one(lock)) {}
+	}
+}
+
+/**
+ * ThreadPool::run_one(lock)
+ *
+ * Private helper which claims and runs the next task of the current batch, if there is one.
+ * The lock is released while the task runs.
+ *
+ * @return
+ *      True if a task was run.
+ */
+bool ThreadPool::run_one(std::unique_lock<std::mutex> &lock) {
+	if (this->job == nullptr || this->nextTask >= this->jobTasks) {
+		return false;
+	}
+
+	int index = this->nextTask++;
+	const std::function<void(int)> &task = *this->job;
+
+	lock.unlock();
+	task(index);
+	lock.lock();
+
+	if (--this->pendingTasks == 0) {
+		this->done.notify_all();
+	}
+	return true;
+}
@@ -0,0 +1,52 @@
+/**
+ * Declares a persistent pool of worker threads used to split work such as World::step into bands.
+ * Rich documentation for the api and behaviour the ThreadPool class can be found in thread_pool.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Declare the structure of the ThreadPool class.
+ *
+ * The pool's threads are started once and reused by every call to ThreadPool::run.
+ */
+class ThreadPool {
+public:
+	explicit ThreadPool(int threads);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool& operator=(const ThreadPool &) = delete;
+
+	int get_threads() const;
+
+	void run(int tasks, const std::function<void(int)> &task);
+
+private:
+	std::vector<std::thread> workers;
+
+	//serializes callers of run
+	std::mutex runMutex;
+
+	//guards the job description below
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const std::function<void(int)> *job = nullptr;
+	int jobTasks = 0;
+	int nextTask = 0;
+	int pendingTasks = 0;
+	unsigned long generation = 0;
+	bool stopping = false;
+
+	void work();
+	bool run_one(std::unique_lock<std::mutex> &lock);
+};
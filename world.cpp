@@ -3,6 +3,7 @@
  *      - Worlds can be constructed empty, from a size, or from an existing Grid with an initial state for the world.
  *      - Worlds can be resized.
  *      - Worlds can return counts of the alive and dead cells in the current Grid state.
+ *          - The population is kept up to date by each step from its births and deaths, so counts are O(1).
  *      - Worlds can return their current Grid state.
  *
  *      - A World holds two equally sized Grid objects for the current state and next state.
@@ -10,10 +11,28 @@
  *
  *      - Stepping a world forward in time applies the rules of Conway's Game of Life.
  *          - https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
+ *          - Other Life-like rules in B/S notation can be used instead, see rule.cpp.
  *
  *      - Worlds have a private helper function used to count the number of alive cells in a 3x3 neighbours
  *        around a given cell.
  *
+ *      - Worlds can step with a scalar byte-per-cell kernel or a bit-parallel kernel over a BitGrid,
+ *        which computes 64 cells per word using full-adder neighbour sums.
+ *      - The byte-per-cell layout can also be stepped with SIMD (SSE2/AVX2/AVX-512BW) chosen at runtime.
+ *      - The bit-packed layout can also be kept and stepped on a GPU, copied back only when the state is read.
+ *
+ *      - Stepping can be split into horizontal bands of rows run on a persistent pool of threads.
+ *        Each band reads the rows bordering it (its halo) straight from the shared current state,
+ *        so the results are identical to a serial step.
+ *
+ *      - Stepping can optionally track which 64x64 tiles changed in the previous generation,
+ *        and only recompute tiles that changed or that border a change.
+ *
+ *      - Advancing can detect when the world has become a still life or oscillator and skip the remaining periods.
+ *      - Advancing can run asynchronously, in cancellable chunks that report progress, see advance_task.cpp.
+ *
+ *      - Worlds can optionally journal their recent steps as deltas, and seek or rewind back through them.
+ *
  *      - Updating the world state can conditionally be performed using a toroidal topology.
  *          - Moving off the left edge you appear on the right edge and vice versa.
  *          - Moving off the top edge you appear on the bottom edge and vice versa.
@@ -22,12 +41,193 @@
  * @date March, 2020
  */
 #include "world.h"
+#include "life_kernel.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <utility>
 
 //helper function for returning true modulo (used in torodial location calculation)
 int mod(int a, int b) {
 	return (a % b + b) % b;
 }
 
+//edge length of the square tiles used to skip stable areas, one packed word wide
+static const int TILE_SIZE = 64;
+
+//helper function unpacking a BitGrid into an equally sized Grid, leaving its halo as it is
+static void unpack_cells(const BitGrid &source, Grid &target) {
+	for (int y = 0; y < source.get_height(); y++) {
+		const uint64_t *words = source.row(y);
+		Cell *cells = target.row(y);
+		for (int x = 0; x < source.get_width(); x++) {
+			cells[x] = ((words[x / 64] >> (x % 64)) & 1) ? ALIVE : DEAD;
+		}
+	}
+}
+
+//helper function producing a mask of the cells that differ between two runs of up to 64 cells
+static inline uint64_t changed_cells(const Cell *before, const Cell *after, int count) {
+	//most of a board is unchanged by a step, so whole runs are compared first
+	if (std::memcmp(before, after, count) == 0) {
+		return 0;
+	}
+	uint64_t mask = 0;
+	for (int i = 0; i < count; i++) {
+		mask |= (uint64_t)(before[i] != after[i]) << i;
+	}
+	return mask;
+}
+
+//helper function producing, for every bit of word w of a packed row, the cell to its left and right.
+//edge bits come from the opposite edge of the row when toroidal, otherwise they are dead.
+//a null row is entirely dead.
+static inline void shift_row(const uint64_t *row, int w, int lastWord, int width, bool toroidal,
+		uint64_t &left, uint64_t &right) {
+	if (row == nullptr) {
+		left = right = 0;
+		return;
+	}
+
+	uint64_t word = row[w];
+	uint64_t leftIn, rightIn;
+
+	if (w > 0) {
+		leftIn = row[w - 1] >> 63;
+	} else {
+		leftIn = toroidal ? ((row[lastWord] >> ((width - 1) % 64)) & 1) : 0;
+	}
+	left = (word << 1) | leftIn;
+
+	if (w < lastWord) {
+		rightIn = row[w + 1] << 63;
+	} else {
+		//the cell past the last one sits in the (always dead) padding, or wraps to cell 0
+		rightIn = toroidal ? ((row[0] & 1) << ((width - 1) % 64)) : 0;
+	}
+	right = (word >> 1) | rightIn;
+}
+
+/**
+ * step_packed_rows(rule, current, next, toroidal, y0, y1, w0, w1)
+ *
+ * Bit-parallel Game of Life kernel. Computes words [w0, w1) of rows [y0, y1) of next from current,
+ * 64 cells per word. Adds the number of cells born and cells died in that region to counts.
+ *
+ * For each word the 8 neighbour planes (the rows above and below shifted left, centred and right,
+ * plus the row itself shifted left and right) are built and handed to rule_word.
+ */
+template<typename RuleType>
+static void step_packed_rows(const RuleType &rule, const BitGrid &current, BitGrid &next, bool toroidal,
+		int y0, int y1, int w0, int w1, StepCounts &counts) {
+	int width = current.get_width();
+	int height = current.get_height();
+	int words = current.get_words_per_row();
+	int lastWord = words - 1;
+	uint64_t tailMask = (width % 64 == 0) ? ~(uint64_t)0 : ((((uint64_t)1) << (width % 64)) - 1);
+	long long births = 0, deaths = 0;
+
+	for (int y = y0; y < y1; y++) {
+		//rows beyond a bounded edge are left null and read as dead
+		const uint64_t *above = nullptr, *below = nullptr;
+		const uint64_t *middle = current.row(y);
+
+		if (y > 0) {
+			above = current.row(y - 1);
+		} else if (toroidal) {
+			above = current.row(height - 1);
+		}
+
+		if (y < height - 1) {
+			below = current.row(y + 1);
+		} else if (toroidal) {
+			below = current.row(0);
+		}
+
+		uint64_t *target = next.row(y);
+		for (int w = w0; w < w1; w++) {
+			uint64_t aboveLeft, aboveRight, middleLeft, middleRight, belowLeft, belowRight;
+			shift_row(above, w, lastWord, width, toroidal, aboveLeft, aboveRight);
+			shift_row(middle, w, lastWord, width, toroidal, middleLeft, middleRight);
+			shift_row(below, w, lastWord, width, toroidal, belowLeft, belowRight);
+
+			uint64_t result = rule_word(rule, aboveLeft, above ? above[w] : 0, aboveRight,
+					middleLeft, middle[w], middleRight,
+					belowLeft, below ? below[w] : 0, belowRight);
+			if (w == lastWord) {
+				//keep the padding bits dead
+				result &= tailMask;
+			}
+			target[w] = result;
+			births += __builtin_popcountll(result & ~middle[w]);
+			deaths += __builtin_popcountll(middle[w] & ~result);
+		}
+	}
+
+	counts.births += births;
+	counts.deaths += deaths;
+}
+
+//helper function folding a word into a running tile hash
+static inline uint64_t mix_hash(uint64_t hash, uint64_t word) {
+	hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+	return hash ^ (hash >> 29);
+}
+
+//helper function hashing the rows of a tile of a packed grid, a tile being one word wide
+static uint64_t hash_packed_tile(const BitGrid &grid, int tx, int ty) {
+	uint64_t hash = mix_hash(0, ((uint64_t)ty << 32) | (uint32_t)tx);
+	int y1 = std::min(grid.get_height(), (ty + 1) * TILE_SIZE);
+	for (int y = ty * TILE_SIZE; y < y1; y++) {
+		hash = mix_hash(hash, grid.row(y)[tx]);
+	}
+	return hash;
+}
+
+//helper function hashing the cells of a tile of a byte-per-cell grid, 8 cells at a time
+static uint64_t hash_scalar_tile(const Grid &grid, int tx, int ty) {
+	uint64_t hash = mix_hash(0, ((uint64_t)ty << 32) | (uint32_t)tx);
+	int x0 = tx * TILE_SIZE, x1 = std::min(grid.get_width(), x0 + TILE_SIZE);
+	int y1 = std::min(grid.get_height(), (ty + 1) * TILE_SIZE);
+	for (int y = ty * TILE_SIZE; y < y1; y++) {
+		const Cell *row = grid.row(y);
+		int x = x0;
+		for (; x + 8 <= x1; x += 8) {
+			uint64_t word;
+			std::memcpy(&word, row + x, sizeof(word));
+			hash = mix_hash(hash, word);
+		}
+		for (; x < x1; x++) {
+			hash = mix_hash(hash, (uint64_t)row[x]);
+		}
+	}
+	return hash;
+}
+
+//helper function testing two packed grids of the same size for equal cells
+static bool same_cells(const BitGrid &a, const BitGrid &b) {
+	for (int y = 0; y < a.get_height(); y++) {
+		if (std::memcmp(a.row(y), b.row(y), a.get_words_per_row() * sizeof(uint64_t)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//helper function testing two grids of the same size for equal cells
+static bool same_cells(const Grid &a, const Grid &b) {
+	for (int y = 0; y < a.get_height(); y++) {
+		if (std::memcmp(a.row(y), b.row(y), a.get_width() * sizeof(Cell)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
 /**
  * World::World()
  *
@@ -78,14 +278,11 @@ World::World(int square_size) : World(square_size,square_size) {}
  * @param height
  *      The height of the world.
  */
- World::World(int width, int height) {
-	 Grid worldGrid;
-	 Grid nextGrid;
-	 worldGrid = Grid(width,height);
-	 nextGrid = Grid(width,height);
-	 this->currentState = worldGrid;
-	 this->nextState = nextGrid;
- }
+ World::World(int width, int height) : currentState(width, height), nextState(width, height) {
+	//one cell of padding around each buffer for World::count_neighbours to read past the edges
+	this->currentState.set_halo(1);
+	this->nextState.set_halo(1);
+}
 
 /**
  * World::World(initial_state)
@@ -106,9 +303,11 @@ World::World(int square_size) : World(square_size,square_size) {}
  * @param initial_state
  *      The state of the constructed world.
  */
-World::World(Grid initial_state) {
-	this->currentState = initial_state;
-	this->nextState = initial_state;
+World::World(Grid initial_state)
+	: currentState(std::move(initial_state)), nextState(currentState.get_width(), currentState.get_height()) {
+	this->currentState.set_halo(1);
+	this->nextState.set_halo(1);
+	this->population = this->currentState.get_alive_cells();
 }
 
 /**
@@ -217,7 +416,7 @@ int World::get_total_cells() const {
  *      The number of alive cells.
  */
  int World::get_alive_cells() const {
- 	return currentState.get_alive_cells();
+	return (int)this->population;
  }
 
 /**
@@ -244,7 +443,63 @@ int World::get_total_cells() const {
  *      The number of dead cells.
  */
  int World::get_dead_cells() const {
- 	return currentState.get_dead_cells();
+	return this->get_total_cells() - (int)this->population;
+ }
+
+/**
+ * World::get_population()
+ *
+ * Gets the number of alive cells in the world in O(1). The count is kept up to date by each step
+ * from the births and deaths it makes, rather than by scanning the grid.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+ long long World::get_population() const {
+	return this->population;
+ }
+
+/**
+ * World::get_births()
+ *
+ * Gets the number of dead cells that came to life during the last step.
+ *
+ * @example
+ *
+ *      // Export per generation statistics without scanning the grid
+ *      world.step();
+ *      std::cout << world.get_generation() << "," << world.get_population() << ","
+ *                << world.get_births() << "," << world.get_deaths() << std::endl;
+ *
+ * @return
+ *      The number of births in the last step, 0 before the first step.
+ */
+ long long World::get_births() const {
+	return this->lastStep.births;
+ }
+
+/**
+ * World::get_deaths()
+ *
+ * Gets the number of alive cells that died during the last step.
+ *
+ * @return
+ *      The number of deaths in the last step, 0 before the first step.
+ */
+ long long World::get_deaths() const {
+	return this->lastStep.deaths;
+ }
+
+/**
+ * World::get_generation()
+ *
+ * Gets the number of steps taken since the world was constructed.
+ *
+ * @return
+ *      The current generation.
+ */
+ long long World::get_generation() const {
+	return this->generation;
  }
 
 /**
@@ -272,9 +527,194 @@ int World::get_total_cells() const {
  *      A reference to the current state.
  */
 	const Grid& World::get_state() const {
+		this->sync_state();
 		return this->currentState;
 	}
 
+/**
+ * World::snapshot()
+ *
+ * Take an immutable copy of the current state that can outlive later steps, e.g. to be written out
+ * by a CheckpointWriter on another thread while the world keeps stepping.
+ *
+ * Stepping rewrites every cell of the next state buffer each generation, so sharing the live buffers
+ * would have to copy within two steps anyway; the snapshot is instead a single bulk copy. When every
+ * holder of a snapshot has released it, its buffer is kept and reused by the next snapshot rather than reallocated.
+ *
+ * @example
+ *
+ *      // Checkpoint without stopping the simulation for the disk
+ *      CheckpointWriter writer;
+ *      writer.submit("checkpoint.bgol", world.snapshot());
+ *      world.step();
+ *
+ * @return
+ *      A shared read-only copy of the current state.
+ */
+	std::shared_ptr<const Grid> World::snapshot() const {
+		this->sync_state();
+		Stats::Timer timer(Stats::SNAPSHOT);
+
+		std::unique_ptr<Grid> buffer;
+		{
+			std::lock_guard<std::mutex> lock(this->snapshots->mutex);
+			if (!this->snapshots->spare.empty()) {
+				buffer = std::move(this->snapshots->spare.back());
+				this->snapshots->spare.pop_back();
+			}
+		}
+		if (buffer) {
+			*buffer = this->currentState;
+		} else {
+			buffer.reset(new Grid(this->currentState));
+		}
+
+		//the last holder to let go hands the buffer back, the pool outlives the world if it has to
+		std::weak_ptr<SnapshotPool> pool = this->snapshots;
+		return std::shared_ptr<const Grid>(buffer.release(), [pool](const Grid *grid) {
+			std::unique_ptr<Grid> released(const_cast<Grid*>(grid));
+			std::shared_ptr<SnapshotPool> owner = pool.lock();
+			if (owner) {
+				std::lock_guard<std::mutex> lock(owner->mutex);
+				if (owner->spare.empty()) {
+					owner->spare.push_back(std::move(released));
+				}
+			}
+		});
+	}
+
+/**
+ * World::get_backend()
+ *
+ * Gets the kernel currently used to step the world.
+ *
+ * @return
+ *      The current backend.
+ */
+	Backend World::get_backend() const {
+		return this->backend;
+	}
+
+/**
+ * World::set_backend(backend)
+ *
+ * Selects the kernel used to step the world. The current state is carried across unchanged.
+ *
+ * @example
+ *
+ *      // Make a world and step it 64 cells at a time
+ *      World world(Zoo::r_pentomino());
+ *      world.set_backend(Backend::PACKED);
+ *      world.advance(100);
+ *
+ * @param backend
+ *      The new backend.
+ *
+ * @throws
+ *      std::exception or sub-class if backend is Backend::GPU and gpu_available() is false.
+ */
+	void World::set_backend(Backend backend) {
+		if (backend == GPU && !gpu_available()) {
+			throw std::runtime_error("No GPU is available for Backend::GPU.\n");
+		}
+		this->sync_state();
+		bool packed = (backend == PACKED || backend == GPU);
+		this->packedCurrent = packed ? BitGrid(this->currentState) : BitGrid();
+		//on the GPU only the current packed grid is kept on the host, to download into when the state is read
+		this->packedNext = (backend == PACKED) ? BitGrid(this->get_width(), this->get_height()) : BitGrid();
+		this->gpuCurrent = (backend == GPU) ? GpuGrid(this->packedCurrent) : GpuGrid();
+		this->gpuNext = (backend == GPU) ? GpuGrid(this->get_width(), this->get_height()) : GpuGrid();
+		this->backend = backend;
+		this->tileChanged.clear();
+		//each backend hashes its own layout, so earlier hashes no longer compare
+		this->hashGeneration = -1;
+		this->hashHistory.clear();
+	}
+
+/**
+ * World::get_threads()
+ *
+ * Gets the number of threads used to step the world.
+ *
+ * @return
+ *      The number of threads, 1 when stepping serially.
+ */
+	int World::get_threads() const {
+		return this->pool ? this->pool->get_threads() : 1;
+	}
+
+/**
+ * World::set_threads(threads)
+ *
+ * Sets the number of threads used to step the world. The board is split into one horizontal band
+ * of rows per thread, and the threads are kept alive between steps.
+ *
+ * @example
+ *
+ *      // Step a large world on 64 threads
+ *      World world(8192);
+ *      world.set_threads(64);
+ *      world.advance(1000, true);
+ *
+ * @param threads
+ *      The number of threads. Values of 1 or less step serially on the calling thread.
+ */
+	void World::set_threads(int threads) {
+		if (threads <= 1) {
+			this->pool.reset();
+		} else if (this->get_threads() != threads) {
+			this->pool = std::make_shared<ThreadPool>(threads);
+		}
+	}
+
+/**
+ * World::run_bands(height, band)
+ *
+ * Private helper which splits [0, height) rows (of cells or of tiles) into one band per thread and calls
+ * band(y0, y1) for each band [y0, y1), in parallel when a thread pool is set.
+ * The band is taken as a template, and the pool is handed a reference to the task, so no std::function
+ * ever has to store a large capture and stepping stays free of heap allocations.
+ */
+	template<typename Band>
+	void World::run_bands(int height, const Band &band) {
+		int bands = std::min(this->get_threads(), std::max(height, 1));
+
+		if (bands <= 1) {
+			band(0, height);
+			return;
+		}
+
+		int rowsPerBand = (height + bands - 1) / bands;
+		auto task = [&](int i) {
+			int y0 = i * rowsPerBand;
+			int y1 = std::min(height, y0 + rowsPerBand);
+			if (y0 < y1) {
+				band(y0, y1);
+			}
+		};
+		//a std::function holds a reference_wrapper in place, where the lambda's captures would not fit
+		this->pool->run(bands, std::ref(task));
+	}
+
+/**
+ * World::sync_state()
+ *
+ * Private helper which brings the byte-per-cell current state up to date with the packed state,
+ * so the packed kernel only pays for unpacking when the state is actually read.
+ * On the GPU the packed state is downloaded first, so the cells only leave the device when read.
+ */
+	void World::sync_state() const {
+		if (!this->stateStale) {
+			return;
+		}
+		Stats::Timer timer(Stats::SYNC);
+		if (this->backend == GPU) {
+			this->gpuCurrent.download(this->packedCurrent);
+		}
+		unpack_cells(this->packedCurrent, this->currentState);
+		this->stateStale = false;
+	}
+
 
 /**
  * World::resize(square_size)
@@ -325,11 +765,29 @@ int World::get_total_cells() const {
  *      The new height for the grid.
  */
 	void World::resize(int new_width, int new_height) {
+		this->sync_state();
 		this->currentState.resize(new_width, new_height);
+		//the next state is overwritten in full by each step, resizing in place just keeps its halo in one allocation
+		this->nextState.resize(new_width, new_height);
+		this->tileChanged.clear();
+		this->forget_cycles();
+		this->population = this->currentState.get_alive_cells();
+		if (this->backend == PACKED) {
+			this->packedCurrent = BitGrid(this->currentState);
+			this->packedNext = BitGrid(new_width, new_height);
+		} else if (this->backend == GPU) {
+			this->packedCurrent = BitGrid(this->currentState);
+			this->gpuCurrent = GpuGrid(this->packedCurrent);
+			this->gpuNext = GpuGrid(new_width, new_height);
+		}
+		if (this->journal.get_capacity() > 0) {
+			//the deltas recorded belong to the old size
+			this->journal.reset(this->generation, this->population, this->lastStep.births, this->lastStep.deaths);
+		}
 	}
 
 /**
- * World::count_neighbours(x, y, toroidal)
+ * World::count_neighbours(x, y)
  *
  * Private helper function to count the number of alive neighbours of a cell.
  * The function should not be visible from outside the World class.
@@ -338,10 +796,9 @@ int World::get_total_cells() const {
  * Ignore the centre coordinate, a cell is not its own neighbour.
  * Attempt to keep the logic as simple, expressive, and readable as possible.
  *
- * If toroidal = false then skip any neighbours that would be outside of the grid,
- * this assumes the grid is Cell::DEAD outside its bounds.
- *
- * If toroidal = true then correctly wrap out of bounds coordinates to the opposite side of the grid.
+ * The current state grid keeps a one cell halo, which World::step refreshes before stepping: dead for a
+ * bounded step, or holding the opposite edges for a toroidal step. So the 8 neighbours are always at the
+ * same offsets from the cell, with no checks for the edges and no wrapping of coordinates.
  *
  * This function is in World and not Grid because the 3x3 sized neighbourhood is specific to Conway's Game of Life,
  * while Grid is more generic to any 2D grid based cellular automaton.
@@ -352,142 +809,141 @@ int World::get_total_cells() const {
  * @param y
  *      The y coordinate of the centre of the neighbourhood.
  *
- * @param toroidal
- *      If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom.
- *
  * @return
  *      Returns the number of alive neighbours.
  */
-int World::count_neighbours(int x, int y,bool toroidal) {
-	int numNeighbours = 0;
-	//applies non torodial rules
-	if (toroidal == false) {
-		//where it is possible for a neigbouring cell to be alive we check its
-		//value and increment neighbours.
-		//i.e if we are on left edge we cant check left cell
-
-		//if x > 0 we can check left for neighbour
-		if (x > 0) {
-			if (this->currentState.get(x-1,y) == ALIVE) {
-				numNeighbours++;
-			}
-		}
-
-		//if x < width we can check right neighbour
-		if (x < this->currentState.get_width()-1) {
-			if (this->currentState.get(x+1,y) == ALIVE) {
-				numNeighbours++;
-			}
-		}
+int World::count_neighbours(int x, int y) {
+	const Cell *above = this->currentState.row(y) - this->currentState.get_stride();
+	const Cell *middle = this->currentState.row(y);
+	const Cell *below = middle + this->currentState.get_stride();
 
+	//each comparison is 0 or 1, so the sum needs no branches
+	return (above[x-1] == ALIVE) + (above[x] == ALIVE) + (above[x+1] == ALIVE)
+		+ (middle[x-1] == ALIVE) + (middle[x+1] == ALIVE)
+		+ (below[x-1] == ALIVE) + (below[x] == ALIVE) + (below[x+1] == ALIVE);
+}
 
-		//if y > 0 we can check for a top neighbour
-		if (y > 0) {
-			if (this->currentState.get(x,y-1) == ALIVE) {
-				numNeighbours++;
-			}
-		}
-
-		//if y < height we can check bottom neighbour
-		if (y < this->currentState.get_height()-1) {
-			if (this->currentState.get(x,y+1) == ALIVE) {
-				numNeighbours++;
-			}
-		}
-
-
-		//if x >0 and y < height we can check bottom left neighbour
-		if (x>0 && y < this->currentState.get_height()-1) {
-			if (this->currentState.get(x-1,y+1) == ALIVE) {
-				numNeighbours++;
-			}
-		}
-
-		//if x > width  and y < height we can check bottom right neighbour
-		if (x < this->currentState.get_width()-1 && y < this->currentState.get_height()-1) {
-			if (this->currentState.get(x+1,y+1) == ALIVE) {
-				numNeighbours++;
-			}
-		}
-
-		//if x > 0  and y > 0 we can check top left neighbour
-		if (x > 0 && y > 0) {
-			if (this->currentState.get(x-1,y-1) == ALIVE) {
-				numNeighbours++;
-			}
-		}
-
-			//if x <width  and y > 0 we can check top Right neighbour
-		if (x < this->currentState.get_width()-1 && y > 0) {
-			if (this->currentState.get(x+1,y-1) == ALIVE) {
-				numNeighbours++;
-			}
-		}
-		//std::cout << " Num Neighbours = "<< numNeighbours << std::endl;
-
-	} else if(toroidal == true) {
-		int width = this->currentState.get_width();
-		int height = this->currentState.get_height();
-
-		//uses modulo to ensure we do not read out of bounds
-		//i.e loops out of bound read to other end of grid
 
-		//left
-		if (this->currentState.get(mod(x-1,width), y) == ALIVE) {
-			numNeighbours++;
-		}
-
-		//right
-		if (this->currentState.get(mod(x+1,width), y) == ALIVE) {
-			numNeighbours++;
-		}
+/**
+ * World::step_rows(rule, x0, x1, y0, y1, counts)
+ *
+ * Private helper which applies the rules to the cells [x0, x1) by [y0, y1), reading the current state
+ * and writing the next state. The current state's halo must already be refreshed for the step. Bands and tiles only write their own cells, so several can run at once.
+ * Adds the number of cells born and cells died in the region to counts.
+ */
+template<typename RuleType>
+void World::step_rows(const RuleType &rule, int x0, int x1, int y0, int y1, StepCounts &counts) {
+	InstructionSet instructionSet = (this->backend == VECTOR) ? detect_instruction_set() : NO_VECTOR;
+	int stride = this->currentState.get_stride();
 
-		//bottom
-		if (this->currentState.get(x, mod(y-1,height)) == ALIVE) {
-			numNeighbours++;
+	for (int y = y0; y < y1; y++) {
+		const Cell *middle = this->currentState.row(y);
+		Cell *target = this->nextState.row(y);
+		int x = x0;
+		if (instructionSet != NO_VECTOR) {
+			//the halo covers the edge columns and rows, so the vector kernel can take the whole span
+			x = step_byte_span(instructionSet, Rule(rule), middle - stride, middle, middle + stride,
+					target, x0, x1, counts.births, counts.deaths);
 		}
-
-		//top
-		if (this->currentState.get(x, mod(y+1,height)) == ALIVE) {
-			numNeighbours++;
+		for (; x < x1; x++) {
+			//counts number of neighbours of each cell
+			int numNeighbours = this->count_neighbours(x,y);
+			//the rule's table gives birth or survival for the count, for Conway birth on 3 and survival on 2 or 3.
+			//every cell is written since the next state buffer still holds an older generation.
+			bool wasAlive = middle[x] == ALIVE;
+			bool alive = rule.next(numNeighbours, wasAlive);
+			target[x] = alive ? ALIVE : DEAD;
+			counts.births += (alive && !wasAlive);
+			counts.deaths += (wasAlive && !alive);
 		}
+	}
+}
 
-		//bottom-left
-		if (this->currentState.get(mod(x-1,width), mod(y-1,height)) == ALIVE) {
-			numNeighbours++;
-		}
+/**
+ * World::step_tiles(rule, toroidal, publish)
+ *
+ * Private helper which steps the world a tile at a time, skipping tiles that cannot change.
+ * Each band of tiles hands its births and deaths to publish.
+ *
+ * A tile can only change if it, or one of the 8 tiles around it, changed during the previous step.
+ * A skipped tile did not change last step either, so the next state buffer (which holds the generation
+ * before the current one) already matches the current state there and nothing needs to be copied.
+ * After a resize, a change of backend, or a step with the other topology than the last, every tile is treated as changed.
+ */
+template<typename RuleType, typename Publish>
+void World::step_tiles(const RuleType &rule, bool toroidal, const Publish &publish) {
+	int width = this->get_width();
+	int height = this->get_height();
+	int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
 
-		//bottom-right
-		if (this->currentState.get(mod(x+1,width), mod(y-1,height)) == ALIVE) {
-			numNeighbours++;
-		}
+	//edge tiles settled with the edges bounded can wake once they wrap, and the reverse
+	if ((int)this->tileChanged.size() != tilesX * tilesY || this->tileToroidal != toroidal) {
+		this->tileChanged.assign(tilesX * tilesY, 1);
+		this->tileChangedNext.assign(tilesX * tilesY, 1);
+	}
+	this->tileToroidal = toroidal;
 
-		//top-left
-		if (this->currentState.get(mod(x-1,width), mod(y+1,height)) == ALIVE) {
-			numNeighbours++;
-		}
+	this->run_bands(tilesY, [&](int ty0, int ty1) {
+		StepCounts bandCounts = {0, 0};
+		for (int ty = ty0; ty < ty1; ty++) {
+			for (int tx = 0; tx < tilesX; tx++) {
+				//look for a change in the 3x3 tiles around this one, wrapping only when toroidal
+				bool active = false;
+				for (int dy = -1; dy <= 1 && !active; dy++) {
+					for (int dx = -1; dx <= 1 && !active; dx++) {
+						int nx = tx + dx, ny = ty + dy;
+						if (toroidal) {
+							nx = mod(nx, tilesX);
+							ny = mod(ny, tilesY);
+						} else if (nx < 0 || ny < 0 || nx >= tilesX || ny >= tilesY) {
+							continue;
+						}
+						active = this->tileChanged[ny * tilesX + nx] != 0;
+					}
+				}
 
-		//top-right
-		if (this->currentState.get(mod(x+1,width), mod(y+1,height)) == ALIVE) {
-			numNeighbours++;
+				StepCounts counts = {0, 0};
+				if (active) {
+					int y0 = ty * TILE_SIZE, y1 = std::min(height, y0 + TILE_SIZE);
+					if (this->backend == PACKED) {
+						//a tile is exactly one word wide
+						step_packed_rows(rule, this->packedCurrent, this->packedNext, toroidal, y0, y1, tx, tx + 1, counts);
+					} else {
+						int x0 = tx * TILE_SIZE, x1 = std::min(width, x0 + TILE_SIZE);
+						this->step_rows(rule, x0, x1, y0, y1, counts);
+					}
+				}
+				this->tileChangedNext[ty * tilesX + tx] = (counts.births != 0 || counts.deaths != 0);
+				bandCounts.births += counts.births;
+				bandCounts.deaths += counts.deaths;
+			}
 		}
-	}
+		publish(bandCounts);
+	});
 
-	return numNeighbours;
+	std::swap(this->tileChanged, this->tileChangedNext);
 }
 
-
 /**
  * World::step(toroidal)
  *
  * Take one step in Conway's Game of Life.
  *
  * Reads from the current state grid and writes to the next state grid. Then swaps the grids.
- * Should be implemented by invoking World::count_neighbours(x, y, toroidal).
+ * Should be implemented by invoking World::count_neighbours(x, y).
+ * The byte-per-cell backends first refresh the current state's halo, once per step, so the kernels
+ * read past the edges without branching and step bounded and toroidal worlds identically.
  * Swapping the grids should be done in O(1) constant time, and should not invoke a copy.
  * Try and boil the logic down to the fewest and most simple conditional statements.
  *
+ * With Backend::PACKED the bit-parallel kernel is used instead, giving identical results.
+ * With Backend::GPU the same kernel runs on the GPU over the whole board, ignoring tile tracking and threads,
+ * and only the births and deaths come back each step.
+ * With more than one thread set the rows are stepped in parallel bands, again giving identical results.
+ *
+ * The rule defaults to Conway's and can be changed with World::set_rule.
+ *
  * Rules: https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
  *      - Any live cell with fewer than two live neighbours dies, as if by underpopulation.
  *      - Any live cell with two or three live neighbours lives on to the next generation.
@@ -499,35 +955,351 @@ int World::count_neighbours(int x, int y,bool toroidal) {
  *      wraps to the right edge and the top to the bottom. Defaults to false.
  */
 void World::step(bool toroidal) {
-	for (int y = 0; y < this->get_height(); y++) {
-		for (int x = 0; x < this->get_width(); x++) {
+	//bands report their births and deaths here once they finish
+	std::atomic<long long> births(0), deaths(0);
+	auto publish = [&](const StepCounts &counts) {
+		births += counts.births;
+		deaths += counts.deaths;
+	};
 
-			//counts number of neighbours of each cell
-			int numNeighbours = this->count_neighbours(x,y,toroidal);
-			//updates new states grid x,y value depending on number of neighbours
-			//underpopulation
-			if (this->currentState.get(x,y) == ALIVE && numNeighbours < 2) {
-				this->nextState.set(x,y,DEAD);
+	//the byte-per-cell kernels read the edges' neighbours from the halo
+	if (this->backend == SCALAR || this->backend == VECTOR) {
+		Stats::Timer timer(Stats::HALO);
+		this->currentState.refresh_halo(toroidal);
+	}
+
+	{
+		Stats::Timer timer(Stats::STEP);
+		//each pre-instantiated rule gets its own copy of the kernels, any other rule reads its tables at runtime
+		if (this->backend == GPU) {
+			//the device kernel takes the rule's tables as arguments
+			StepCounts counts = {0, 0};
+			this->gpuCurrent.step(this->rule, toroidal, this->gpuNext, counts.births, counts.deaths);
+			publish(counts);
+		} else {
+			with_rule(this->rule, [&](const auto &rule) {
+				if (this->tileTracking) {
+					this->step_tiles(rule, toroidal, publish);
+				} else if (this->backend == PACKED) {
+					//64 cells per word
+					this->run_bands(this->get_height(), [&](int y0, int y1) {
+						StepCounts counts = {0, 0};
+						step_packed_rows(rule, this->packedCurrent, this->packedNext, toroidal, y0, y1, 0,
+								this->packedCurrent.get_words_per_row(), counts);
+						publish(counts);
+					});
+				} else {
+					this->run_bands(this->get_height(), [&](int y0, int y1) {
+						StepCounts counts = {0, 0};
+						this->step_rows(rule, 0, this->get_width(), y0, y1, counts);
+						publish(counts);
+					});
+				}
+			});
+		}
+	}
+
+	//swaps the buffers in O(1), the old state becomes scratch space for the next step
+	if (this->backend == PACKED) {
+		std::swap(this->packedCurrent, this->packedNext);
+		this->stateStale = true;
+	} else if (this->backend == GPU) {
+		std::swap(this->gpuCurrent, this->gpuNext);
+		this->stateStale = true;
+	} else {
+		std::swap(this->currentState, this->nextState);
+	}
+
+	if (this->journal.get_capacity() > 0) {
+		this->record_journal(births, deaths);
+	}
+
+	this->lastStep.births = births;
+	this->lastStep.deaths = deaths;
+	this->population += this->lastStep.births - this->lastStep.deaths;
+	this->generation++;
+	Stats::count_cells((unsigned long long)this->get_width() * this->get_height());
+}
+
+/**
+ * World::get_tile_tracking()
+ *
+ * @return
+ *      True if the world only recomputes tiles near a change from the previous step.
+ */
+bool World::get_tile_tracking() const {
+	return this->tileTracking;
+}
+
+/**
+ * World::set_tile_tracking(enabled)
+ *
+ * Enables or disables stepping by tiles. With tracking enabled the world is split into 64x64 tiles,
+ * and only the tiles that changed during the previous step, or border one that did, are recomputed.
+ * Large boards that have mostly died out or settled into still lifes then cost time in proportion to
+ * their activity rather than their area. The results are identical either way.
+ *
+ * @example
+ *
+ *      // Step a big, mostly empty world
+ *      World world(16384);
+ *      world.set_tile_tracking(true);
+ *      world.advance(1000);
+ *
+ * @param enabled
+ *      True to step by tiles.
+ */
+void World::set_tile_tracking(bool enabled) {
+	this->tileTracking = enabled;
+	this->tileChanged.clear();
+}
+
+/**
+ * World::get_journal()
+ *
+ * @return
+ *      The number of recent steps the world keeps to seek back through, 0 when the journal is off.
+ */
+int World::get_journal() const {
+	return this->journal.get_capacity();
+}
+
+/**
+ * World::set_journal(generations, keyframe_interval)
+ *
+ * Keeps the last steps of the world so that it can be taken back to an earlier generation with
+ * World::seek or World::rewind. Each step is kept as the 64 cell words it changed, so a board that is
+ * mostly settled costs little however big it is. Every keyframe_interval generations the whole state
+ * is kept too, packed, so a seek applies at most about half an interval of steps.
+ * Anything already recorded is dropped, the journal starts from the current generation.
+ *
+ * @example
+ *
+ *      // Run a soup, then go back to look at generation 900
+ *      World world(Zoo::load("soup.rle"));
+ *      world.set_journal(1000);
+ *      world.advance(1000);
+ *      world.seek(900);
+ *
+ * @param generations
+ *      The number of steps to keep, 0 to turn the journal off.
+ *
+ * @param keyframe_interval
+ *      Optional parameter. Generations between keyframes, 0 for none. Defaults to 256.
+ *
+ * @throws
+ *      std::exception or sub-class if generations or keyframe_interval are negative.
+ */
+void World::set_journal(int generations, int keyframe_interval) {
+	this->journal = Journal(generations, keyframe_interval);
+	this->journalScratch = BitGrid();
+	if (generations > 0) {
+		//on the GPU each step is diffed against the host's copy, so it must be current
+		this->sync_state();
+		this->journal.reset(this->generation, this->population, this->lastStep.births, this->lastStep.deaths);
+	}
+}
+
+/**
+ * World::get_journal_start()
+ *
+ * @return
+ *      The earliest generation the world can seek back to, the current one when the journal is off.
+ */
+long long World::get_journal_start() const {
+	return (this->journal.get_capacity() > 0) ? this->journal.get_start() : this->generation;
+}
+
+/**
+ * World::get_journal_end()
+ *
+ * @return
+ *      The latest generation the world can seek forward to without stepping, the current one when the journal is off.
+ *      This is later than the current generation after seeking back, until the world is stepped again.
+ */
+long long World::get_journal_end() const {
+	return (this->journal.get_capacity() > 0) ? this->journal.get_end() : this->generation;
+}
+
+/**
+ * World::get_journal_bytes()
+ *
+ * @return
+ *      The approximate memory held by the journal, in bytes.
+ */
+size_t World::get_journal_bytes() const {
+	return this->journal.get_bytes();
+}
+
+/**
+ * World::seek(generation)
+ *
+ * Takes the world to any generation held by the journal, backwards or forwards, restoring the state,
+ * the population and the last step's counts exactly as they were.
+ * Stepping from an earlier generation records a new history and drops the generations after it.
+ *
+ * @example
+ *
+ *      // Step forward, look back, then return
+ *      World world(Zoo::glider());
+ *      world.set_journal(100);
+ *      world.advance(50);
+ *      world.seek(10);
+ *      world.seek(50);
+ *
+ * @param generation
+ *      The generation to go to, from World::get_journal_start() to World::get_journal_end().
+ *
+ * @throws
+ *      std::exception or sub-class if the generation is not held by the journal.
+ */
+void World::seek(long long generation) {
+	if (generation < this->get_journal_start() || generation > this->get_journal_end()) {
+		throw std::invalid_argument("Generation is outside of the journal.\n");
+	}
+	if (generation == this->generation) {
+		return;
+	}
+
+	//start from the nearest keyframe if it is closer than the current state
+	long long from = this->generation;
+	const BitGrid *keyframe = this->journal.nearest_keyframe(generation, from);
+	if (keyframe != nullptr) {
+		this->load_keyframe(*keyframe);
+	}
+	for (; from < generation; from++) {
+		this->apply_delta(this->journal.get_delta(from));
+	}
+	for (; from > generation; from--) {
+		this->apply_delta(this->journal.get_delta(from - 1));
+	}
+
+	if (this->backend == PACKED || this->backend == GPU) {
+		this->stateStale = true;
+	}
+	if (this->backend == GPU) {
+		this->gpuCurrent = GpuGrid(this->packedCurrent);
+	}
+	this->generation = generation;
+	this->population = this->journal.get_population(generation);
+	this->journal.get_counts(generation, this->lastStep.births, this->lastStep.deaths);
+	//the next state no longer trails the current one, and any cycle found was in another history
+	this->tileChanged.clear();
+	this->forget_cycles();
+}
+
+/**
+ * World::rewind(steps)
+ *
+ * Takes the world back a number of generations, see World::seek.
+ *
+ * @param steps
+ *      Optional parameter. The number of generations to go back. Defaults to 1.
+ *
+ * @throws
+ *      std::exception or sub-class if the generation is not held by the journal.
+ */
+void World::rewind(int steps) {
+	this->seek(this->generation - steps);
+}
+
+/**
+ * World::record_journal(births, deaths)
+ *
+ * Private helper which records the step just taken, from the old state to the swapped in new one.
+ * With tile tracking only the tiles that changed are compared, otherwise the whole board is.
+ * On the GPU the new state is downloaded and compared with the host's copy of the old one.
+ */
+void World::record_journal(long long births, long long deaths) {
+	Stats::Timer timer(Stats::JOURNAL);
+	JournalDelta &delta = this->journal.record(this->generation);
+	delta.births = births;
+	delta.deaths = deaths;
+	delta.population = this->population + births - deaths;
+
+	int width = this->get_width(), height = this->get_height();
+	int words = (width + 63) / 64;
+	if (this->backend == GPU) {
+		if (this->journalScratch.get_width() != width || this->journalScratch.get_height() != height) {
+			this->journalScratch = BitGrid(width, height);
+		}
+		this->gpuCurrent.download(this->journalScratch);
+	}
+
+	//a tile is one word wide, so its flag covers the same words as the delta
+	int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	bool tracked = this->tileTracking && this->backend != GPU && this->tileChanged.size() == (size_t)words * tilesY;
+	for (int ty = 0; ty < tilesY; ty++) {
+		int y1 = std::min(height, (ty + 1) * TILE_SIZE);
+		for (int w = 0; w < words; w++) {
+			if (tracked && !this->tileChanged[(size_t)ty * words + w]) {
+				continue;
 			}
-			//lives on to next generation
-			if (this->currentState.get(x,y) == ALIVE && (numNeighbours == 2 || numNeighbours == 3)) {
-				this->nextState.set(x,y,ALIVE);
+			for (int y = ty * TILE_SIZE; y < y1; y++) {
+				uint64_t mask;
+				if (this->backend == PACKED) {
+					mask = this->packedNext.row(y)[w] ^ this->packedCurrent.row(y)[w];
+				} else if (this->backend == GPU) {
+					mask = this->packedCurrent.row(y)[w] ^ this->journalScratch.row(y)[w];
+				} else {
+					mask = changed_cells(this->nextState.row(y) + w * 64, this->currentState.row(y) + w * 64,
+							std::min(64, width - w * 64));
+				}
+				if (mask != 0) {
+					delta.indices.push_back((uint64_t)y * words + w);
+					delta.masks.push_back(mask);
+				}
 			}
+		}
+	}
 
-			//overpopulation
-			if (this->currentState.get(x,y) == ALIVE && numNeighbours > 3) {
-				this->nextState.set(x,y,DEAD);
-			}
+	if (this->backend == GPU) {
+		//the host's copy now holds the new state, and the old one is the scratch for the next step
+		std::swap(this->packedCurrent, this->journalScratch);
+	}
+	if (this->journal.wants_keyframe(this->generation + 1)) {
+		bool packed = (this->backend == PACKED || this->backend == GPU);
+		this->journal.add_keyframe(this->generation + 1, packed ? this->packedCurrent : BitGrid(this->currentState));
+	}
+}
 
-			//reproduction
-			if (this->currentState.get(x,y) == DEAD && numNeighbours == 3) {
-				this->nextState.set(x,y,ALIVE);
-			}
+/**
+ * World::apply_delta(delta)
+ *
+ * Private helper which flips the cells of a journaled step in the current state, taking it across the step
+ * in either direction. The packed backends flip their packed state, which is then unpacked when read.
+ */
+void World::apply_delta(const JournalDelta &delta) {
+	int words = (this->get_width() + 63) / 64;
+	bool packed = (this->backend == PACKED || this->backend == GPU);
+	for (size_t i = 0; i < delta.indices.size(); i++) {
+		int y = (int)(delta.indices[i] / words);
+		int w = (int)(delta.indices[i] % words);
+		uint64_t mask = delta.masks[i];
+		if (packed) {
+			this->packedCurrent.row(y)[w] ^= mask;
+			continue;
+		}
+		Cell *cells = this->currentState.row(y) + w * 64;
+		for (; mask != 0; mask &= mask - 1) {
+			int bit = __builtin_ctzll(mask);
+			cells[bit] = (cells[bit] == ALIVE) ? DEAD : ALIVE;
 		}
+	}
+}
 
+/**
+ * World::load_keyframe(state)
+ *
+ * Private helper which replaces the current state with a journaled keyframe, in the backend's own layout.
+ */
+void World::load_keyframe(const BitGrid &state) {
+	if (this->backend == PACKED || this->backend == GPU) {
+		std::copy(state.row(0), state.row(0) + (size_t)state.get_words_per_row() * state.get_height(),
+				this->packedCurrent.row(0));
+	} else {
+		unpack_cells(state, this->currentState);
 	}
-	//sets currentState to the new state incrementing the game
-	this->currentState = this->nextState;
 }
 
 /**
@@ -535,6 +1307,10 @@ void World::step(bool toroidal) {
  *
  * Advance multiple steps in the Game of Life.
  * Should be implemented by invoking World::step(toroidal).
+ * Once the world is constructed stepping makes no grid buffer allocations, which can be checked with Allocations::get_count(),
+ * and no other heap allocations either, which BM_Step_Allocations checks by counting every call to operator new.
+ * With cycle detection on (see World::set_cycle_detection) the world stops stepping once it is found to be
+ * a still life or oscillator, and jumps to the final generation.
  *
  * @param steps
  *      The number of steps to advance the world forward.
@@ -545,8 +1321,307 @@ void World::step(bool toroidal) {
  */
 
  void World::advance(int steps,bool toroidal) {
-	 //runs step 'steps' amount of times
-	 for (int i = 0; i < steps; i++) {
+	 if (this->cycleLimit == 0) {
+		 //runs step 'steps' amount of times
+		 for (int i = 0; i < steps; i++) {
+			 this->step(toroidal);
+		 }
+		 return;
+	 }
+
+	 long long target = this->generation + steps;
+
+	 //stepping is deterministic, so a cycle found earlier lasts until the world is resized
+	 if (this->period > 0 && this->periodToroidal == toroidal) {
+		 this->skip_cycles(target, toroidal);
+		 return;
+	 }
+
+	 //carry on from hashes left by an earlier advance only if nothing stepped the world in between
+	 if (this->hashGeneration != this->generation || this->historyToroidal != toroidal) {
+		 this->hashHistory.clear();
+		 this->update_hash();
+		 this->hashHistory.push_back(this->stateHash);
+		 this->historyToroidal = toroidal;
+	 }
+
+	 while (this->generation < target) {
 		 this->step(toroidal);
+		 this->update_hash();
+
+		 //a step without births or deaths proves a still life (or an empty world), no hashing needed
+		 long long found = 0;
+		 if (this->lastStep.births == 0 && this->lastStep.deaths == 0) {
+			 found = 1;
+		 }
+		 for (long long q = 2; found == 0 && q <= (long long)this->hashHistory.size(); q++) {
+			 if (this->hashHistory[this->hashHistory.size() - q] == this->stateHash) {
+				 found = q;
+			 }
+		 }
+		 this->hashHistory.push_back(this->stateHash);
+		 while ((int)this->hashHistory.size() > this->cycleLimit) {
+			 this->hashHistory.pop_front();
+		 }
+
+		 if (found > 1) {
+			 //rule out a hash collision: the state must come back exactly one period later
+			 if (target - this->generation < found) {
+				 continue;
+			 }
+			 bool same;
+			 if (this->backend == PACKED || this->backend == GPU) {
+				 //on the GPU update_hash has just downloaded the state into packedCurrent
+				 BitGrid reference = this->packedCurrent;
+				 for (long long i = 0; i < found; i++) {
+					 this->step(toroidal);
+					 this->update_hash();
+					 this->hashHistory.push_back(this->stateHash);
+					 this->hashHistory.pop_front();
+				 }
+				 same = same_cells(reference, this->packedCurrent);
+			 } else {
+				 Grid reference = this->currentState;
+				 for (long long i = 0; i < found; i++) {
+					 this->step(toroidal);
+					 this->update_hash();
+					 this->hashHistory.push_back(this->stateHash);
+					 this->hashHistory.pop_front();
+				 }
+				 same = same_cells(reference, this->currentState);
+			 }
+			 if (!same) {
+				 continue;
+			 }
+		 }
+
+		 if (found > 0) {
+			 //the repeat was first seen one period before the matching hash, which is now one period back
+			 this->period = found;
+			 this->periodStart = this->generation - ((found == 1) ? 1 : 2 * found);
+			 this->periodToroidal = toroidal;
+			 this->skip_cycles(target, toroidal);
+			 return;
+		 }
+	 }
+ }
+
+/**
+ * World::advance_async(steps, toroidal, chunk, progress)
+ *
+ * Advance multiple steps on a thread of their own, returning straight away. The steps are taken a chunk
+ * of generations at a time, between which the advance can be cancelled, report progress, and hand out
+ * snapshots of the state. See AdvanceTask, which can also be stepped chunk by chunk without a thread.
+ * The world must not be used directly until the task is done.
+ *
+ * @example
+ *
+ *      // Keep a service responsive while a big world runs
+ *      std::unique_ptr<AdvanceTask> task = world.advance_async(100000, true, 64, [](const AdvanceProgress &now) {
+ *          std::cout << now.done << " of " << now.steps << std::endl;
+ *      });
+ *      long long reached = task->wait();
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the steps will consider the grid as a torus. Defaults to false.
+ *
+ * @param chunk
+ *      Optional parameter. Generations stepped between chances to cancel, report and snapshot. Defaults to 64.
+ *
+ * @param progress
+ *      Optional parameter. Called on the stepping thread after every chunk.
+ *
+ * @return
+ *      The running task, which cancels and waits for the stepping if it is destroyed first.
+ *
+ * @throws
+ *      std::exception or sub-class if steps is negative or chunk is less than 1.
+ */
+ std::unique_ptr<AdvanceTask> World::advance_async(int steps, bool toroidal, int chunk,
+		 std::function<void(const AdvanceProgress&)> progress) {
+	 std::unique_ptr<AdvanceTask> task(new AdvanceTask(*this, steps, toroidal, chunk, std::move(progress)));
+	 task->start();
+	 return task;
+ }
+
+/**
+ * World::skip_cycles(target, toroidal)
+ *
+ * Private helper which jumps a periodic world to the target generation. Whole periods leave the state,
+ * the population, the last step's counts and the tile flags exactly as they are, so only the generation
+ * moves. The few generations left over are stepped as normal.
+ */
+ void World::skip_cycles(long long target, bool toroidal) {
+	 long long remaining = target - this->generation;
+	 long long jump = remaining - remaining % this->period;
+	 if (this->hashGeneration == this->generation) {
+		 //hashes repeat with the state, so the recorded history is still in phase
+		 this->hashGeneration += jump;
+	 }
+	 this->generation += jump;
+	 if (jump > 0 && this->journal.get_capacity() > 0) {
+		 //the skipped generations were never stepped through, so the journal starts again from here
+		 this->journal.reset(this->generation, this->population, this->lastStep.births, this->lastStep.deaths);
+	 }
+	 for (long long i = 0; i < remaining % this->period; i++) {
+		 this->step(toroidal);
+	 }
+ }
+
+/**
+ * World::update_hash()
+ *
+ * Private helper which brings the per tile hashes, and their combination stateHash, up to the current generation.
+ * With tile tracking on and the hashes one generation behind, only the tiles that changed in the last step are
+ * rehashed. Otherwise every tile is rehashed, split into bands across the thread pool.
+ * On the GPU the state is downloaded to be hashed, so cycle detection costs a copy back each step.
+ */
+ void World::update_hash() {
+	 Stats::Timer timer(Stats::CYCLES);
+	 if (this->backend == GPU) {
+		 this->gpuCurrent.download(this->packedCurrent);
+	 }
+	 int tilesX = (this->get_width() + TILE_SIZE - 1) / TILE_SIZE;
+	 int tilesY = (this->get_height() + TILE_SIZE - 1) / TILE_SIZE;
+	 size_t tiles = (size_t)tilesX * tilesY;
+
+	 bool incremental = this->tileTracking && this->backend != GPU && this->hashGeneration == this->generation - 1
+			 && this->tileHashes.size() == tiles && this->tileChanged.size() == tiles;
+	 if (!incremental) {
+		 this->tileHashes.assign(tiles, 0);
+		 this->stateHash = 0;
 	 }
+
+	 std::atomic<uint64_t> change(0);
+	 this->run_bands(tilesY, [&](int ty0, int ty1) {
+		 uint64_t bandChange = 0;
+		 for (int ty = ty0; ty < ty1; ty++) {
+			 for (int tx = 0; tx < tilesX; tx++) {
+				 size_t tile = (size_t)ty * tilesX + tx;
+				 if (incremental && !this->tileChanged[tile]) {
+					 continue;
+				 }
+				 uint64_t hash = (this->backend == PACKED || this->backend == GPU) ? hash_packed_tile(this->packedCurrent, tx, ty)
+						 : hash_scalar_tile(this->currentState, tx, ty);
+				 bandChange ^= this->tileHashes[tile] ^ hash;
+				 this->tileHashes[tile] = hash;
+			 }
+		 }
+		 change ^= bandChange;
+	 });
+
+	 this->stateHash ^= change;
+	 this->hashGeneration = this->generation;
+ }
+
+/**
+ * World::forget_cycles()
+ *
+ * Private helper which drops any detected cycle and recorded hashes, for when the state changes outside of stepping.
+ */
+ void World::forget_cycles() {
+	 this->period = 0;
+	 this->periodStart = 0;
+	 this->hashGeneration = -1;
+	 this->hashHistory.clear();
+ }
+
+/**
+ * World::get_rule()
+ *
+ * @return
+ *      The Life-like rule the world is stepped with, Conway's B3/S23 unless changed.
+ */
+ Rule World::get_rule() const {
+	 return this->rule;
+ }
+
+/**
+ * World::set_rule(rule)
+ *
+ * Step the world with another Life-like rule from now on. The current state is kept.
+ *
+ * @example
+ *
+ *      // Run a replicator under HighLife
+ *      World world(Zoo::load_rle("path/to/replicator.rle"));
+ *      world.set_rule(Rule::parse("B36/S23"));
+ *      world.advance(1000);
+ *
+ * @param rule
+ *      The new rule.
+ */
+ void World::set_rule(const Rule &rule) {
+	 this->rule = rule;
+	 //cells that were settled under the old rule may not be under the new one
+	 this->tileChanged.clear();
+	 this->forget_cycles();
+ }
+
+/**
+ * World::get_cycle_detection()
+ *
+ * @return
+ *      The longest period World::advance looks for, 0 when cycle detection is off.
+ */
+ int World::get_cycle_detection() const {
+	 return this->cycleLimit;
+ }
+
+/**
+ * World::set_cycle_detection(max_period)
+ *
+ * Make World::advance watch for the world settling down, and skip straight to the end once it has.
+ *
+ * While advancing, the world keeps a hash of each of the last (max_period) generations, built from per tile
+ * hashes so that with tile tracking on only changed tiles are rehashed. A step with no births or deaths is a
+ * still life (period 1). A hash matching that of a generation up to max_period steps back is checked exactly,
+ * by stepping one more period and comparing the cells, and after that every remaining whole period is skipped
+ * in O(1). The results are identical to stepping every generation.
+ *
+ * @example
+ *
+ *      // A glider on a torus comes back to the same place every 4 * size generations
+ *      World world(16);
+ *      ...
+ *      world.set_cycle_detection(64);
+ *      world.advance(1000000, true);
+ *      std::cout << "period " << world.get_period() << " from " << world.get_period_start() << std::endl;
+ *
+ * @param max_period
+ *      The longest period to look for, 0 to turn cycle detection off.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if max_period is negative.
+ */
+ void World::set_cycle_detection(int max_period) {
+	 if (max_period < 0) {
+		 throw std::invalid_argument("Invalid cycle period.\n");
+	 }
+	 this->cycleLimit = max_period;
+	 this->hashHistory.clear();
+	 this->hashGeneration = -1;
+ }
+
+/**
+ * World::get_period()
+ *
+ * @return
+ *      The period of the cycle the world was found to be in (1 for a still life), 0 if none has been found.
+ */
+ long long World::get_period() const {
+	 return this->period;
+ }
+
+/**
+ * World::get_period_start()
+ *
+ * @return
+ *      The generation at which the detected cycle was first seen, 0 if none has been found.
+ */
+ long long World::get_period_start() const {
+	 return this->periodStart;
  }
@@ -12,6 +12,44 @@
 
 // Add the minimal number of includes you need in order to declare the class.
  #include "grid.h"
+ #include "bitgrid.h"
+ #include "byte_kernel.h"
+ #include "gpu_kernel.h"
+ #include "journal.h"
+ #include "advance_task.h"
+ #include "rule.h"
+ #include "thread_pool.h"
+
+ #include <cstdint>
+ #include <deque>
+ #include <functional>
+ #include <memory>
+ #include <mutex>
+ #include <vector>
+
+/**
+ * A Backend selects which kernel World::step uses to compute the next generation.
+ *      - Backend::SCALAR counts neighbours cell by cell on a byte-per-cell Grid.
+ *      - Backend::PACKED steps a bit-packed BitGrid 64 cells at a time.
+ *      - Backend::VECTOR steps the byte-per-cell Grid 16 to 64 cells at a time with SIMD instructions,
+ *        picked at runtime, falling back to the scalar kernel on CPUs without them.
+ *      - Backend::GPU steps a bit-packed copy of the state kept in GPU memory with OpenCL, only copying
+ *        it back when the state is read. Needs a build with GOL_OPENCL, see gpu_kernel.h.
+ */
+enum Backend {
+    SCALAR,
+    PACKED,
+    VECTOR,
+    GPU
+};
+
+/**
+ * Counts of the cells that came to life and the cells that died during one step.
+ */
+struct StepCounts {
+    long long births;
+    long long deaths;
+};
 
 /**
  * Declare the structure of the World class for representing a 2d grid world.
@@ -33,18 +71,109 @@ public:
 	int get_dead_cells() const;
 	int get_alive_cells() const;
 
+	long long get_population() const;
+	long long get_births() const;
+	long long get_deaths() const;
+	long long get_generation() const;
+
 	void resize(int square_size);
 	void resize(int new_width, int new_height);
 
 	const Grid& get_state() const;
+	std::shared_ptr<const Grid> snapshot() const;
+
+	Backend get_backend() const;
+	void set_backend(Backend backend);
+
+	int get_threads() const;
+	void set_threads(int threads);
+
+	bool get_tile_tracking() const;
+	void set_tile_tracking(bool enabled);
+
+	Rule get_rule() const;
+	void set_rule(const Rule &rule);
+
+	int get_cycle_detection() const;
+	void set_cycle_detection(int max_period);
+	long long get_period() const;
+	long long get_period_start() const;
+
+	int get_journal() const;
+	void set_journal(int generations, int keyframe_interval = 256);
+	long long get_journal_start() const;
+	long long get_journal_end() const;
+	size_t get_journal_bytes() const;
+	void seek(long long generation);
+	void rewind(int steps = 1);
 
 	void step(bool toroidal = false);
 	void advance(int steps, bool toroidal = false);
+	std::unique_ptr<AdvanceTask> advance_async(int steps, bool toroidal = false, int chunk = 64,
+			std::function<void(const AdvanceProgress&)> progress = nullptr);
 
 private:
-	Grid currentState;
+	//currentState is refreshed lazily from packedCurrent by get_state() when stepping packed,
+	//and packedCurrent in turn from gpuCurrent when stepping on the GPU
+	mutable Grid currentState;
 	Grid nextState;
-	int count_neighbours(int x, int y,bool toroidal);
+	mutable BitGrid packedCurrent;
+	BitGrid packedNext;
+	GpuGrid gpuCurrent;
+	GpuGrid gpuNext;
+	Backend backend = SCALAR;
+	Rule rule = ConwayRule();
+	mutable bool stateStale = false;
+	//shared so copies of a world reuse the same workers, null when stepping serially
+	std::shared_ptr<ThreadPool> pool;
+	//per tile flags recording whether the tile changed during the previous step
+	bool tileTracking = false;
+	std::vector<char> tileChanged;
+	std::vector<char> tileChangedNext;
+	//the topology the flags were computed under
+	bool tileToroidal = false;
+	//kept up to date by each step from its births and deaths
+	long long population = 0;
+	long long generation = 0;
+	StepCounts lastStep = {0, 0};
+	//longest period advance looks for, 0 when cycle detection is off
+	int cycleLimit = 0;
+	//the detected cycle, 0 until one is found
+	long long period = 0;
+	long long periodStart = 0;
+	bool periodToroidal = false;
+	//per tile hashes of the current state, combined by xor into stateHash for generation hashGeneration
+	std::vector<uint64_t> tileHashes;
+	uint64_t stateHash = 0;
+	long long hashGeneration = -1;
+	//state hashes of the generations up to and including hashGeneration, newest last
+	std::deque<uint64_t> hashHistory;
+	bool historyToroidal = false;
+	//buffers of released snapshots, kept for reuse by the next snapshot
+	struct SnapshotPool {
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Grid>> spare;
+	};
+	std::shared_ptr<SnapshotPool> snapshots = std::make_shared<SnapshotPool>();
+	//deltas of the recent steps for World::seek, recording nothing unless turned on
+	Journal journal;
+	//the state downloaded from the GPU by each journaled step
+	BitGrid journalScratch;
+
+	int count_neighbours(int x, int y);
+	template<typename RuleType>
+	void step_rows(const RuleType &rule, int x0, int x1, int y0, int y1, StepCounts &counts);
+	template<typename RuleType, typename Publish>
+	void step_tiles(const RuleType &rule, bool toroidal, const Publish &publish);
+	template<typename Band>
+	void run_bands(int height, const Band &band);
+	void sync_state() const;
+	void update_hash();
+	void forget_cycles();
+	void skip_cycles(long long target, bool toroidal);
+	void record_journal(long long births, long long deaths);
+	void apply_delta(const JournalDelta &delta);
+	void load_keyframe(const BitGrid &state);
 
 
 };
@@ -0,0 +1,539 @@
+/**
+ * Implements a class simulating many same sized worlds together, for parameter sweeps over many seeds.
+ *      - The worlds are bit-sliced: bit i of the word for a cell is that cell in world i of a group of 64,
+ *        so the bit-parallel kernels from life_kernel.h step 64 worlds per operation with no shifting.
+ *      - All of the planes live in one arena, a group's current and next planes side by side.
+ *      - A world that dies out or becomes a still life is frozen and stops being stepped, and a group
+ *        with no running worlds is skipped entirely.
+ *      - Steps are spread across a thread pool by group, and by bands of rows within a group when
+ *        there are fewer groups than threads.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#include "world_batch.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "life_kernel.h"
+#include "stats.h"
+
+//helper function filling the halo of a group's plane, dead or wrapped from the opposite edges
+static void refresh_plane_halo(uint64_t *cells, int width, int height, bool toroidal) {
+	int stride = width + 2;
+	if (toroidal == false || width == 0 || height == 0) {
+		std::fill(cells, cells + stride, 0);
+		std::fill(cells + (height + 1) * stride, cells + (height + 2) * stride, 0);
+		for (int y = 1; y <= height; y++) {
+			cells[y * stride] = 0;
+			cells[y * stride + width + 1] = 0;
+		}
+		return;
+	}
+
+	//the ends of each row first, so the rows copied into the top and bottom carry the corners
+	for (int y = 1; y <= height; y++) {
+		cells[y * stride] = cells[y * stride + width];
+		cells[y * stride + width + 1] = cells[y * stride + 1];
+	}
+	std::copy(cells + height * stride, cells + (height + 1) * stride, cells);
+	std::copy(cells + stride, cells + 2 * stride, cells + (height + 1) * stride);
+}
+
+/**
+ * WorldBatch::WorldBatch()
+ *
+ * Construct an empty batch holding no worlds.
+ */
+WorldBatch::WorldBatch() : WorldBatch(0, 0, 0) {}
+
+/**
+ * WorldBatch::WorldBatch(width, height, count)
+ *
+ * Construct a batch of count worlds of the same size, every cell dead.
+ *
+ * @example
+ *
+ *      // Make 10000 32x32 worlds
+ *      WorldBatch batch(32, 32, 10000);
+ *
+ * @param width
+ *      The width of every world.
+ *
+ * @param height
+ *      The height of every world.
+ *
+ * @param count
+ *      The number of worlds.
+ *
+ * @throws
+ *      std::exception or sub-class if any of width, height or count is negative.
+ */
+WorldBatch::WorldBatch(int width, int height, int count) : width(width), height(height), count(count) {
+	if (width < 0 || height < 0 || count < 0) {
+		throw std::invalid_argument("Invalid batch size.\n");
+	}
+
+	int groups = (count + 63) / 64;
+	this->planeSize = (width + 2) * (height + 2);
+	this->cells.assign((size_t)2 * groups * this->planeSize, 0);
+	this->front.assign(groups, 0);
+	this->running.assign(groups, 0);
+	this->status.assign(count, RUNNING);
+	this->finishedGeneration.assign(count, -1);
+	this->restart();
+}
+
+/**
+ * WorldBatch::WorldBatch(initial_states)
+ *
+ * Construct a batch with one world per grid, using the size and values of the grids.
+ *
+ * @example
+ *
+ *      // Make a batch of a glider in each of its 4 orientations
+ *      std::vector<Grid> seeds;
+ *      for (int i = 0; i < 4; i++) {
+ *          Grid seed(16, 16);
+ *          seed.merge(Zoo::glider().rotate(i), 6, 6);
+ *          seeds.push_back(seed);
+ *      }
+ *      WorldBatch batch(seeds);
+ *
+ * @param initial_states
+ *      The states of the worlds, world i starting from initial_states[i].
+ *
+ * @throws
+ *      std::exception or sub-class if the grids are not all the same size.
+ */
+WorldBatch::WorldBatch(const std::vector<Grid> &initial_states)
+	: WorldBatch(initial_states.empty() ? 0 : initial_states[0].get_width(),
+			initial_states.empty() ? 0 : initial_states[0].get_height(), (int)initial_states.size()) {
+	for (int i = 0; i < this->get_count(); i++) {
+		this->set_state(i, initial_states[i]);
+	}
+}
+
+/**
+ * WorldBatch::get_width()
+ *
+ * @return
+ *      The width of every world in the batch.
+ */
+int WorldBatch::get_width() const {
+	return this->width;
+}
+
+/**
+ * WorldBatch::get_height()
+ *
+ * @return
+ *      The height of every world in the batch.
+ */
+int WorldBatch::get_height() const {
+	return this->height;
+}
+
+/**
+ * WorldBatch::get_count()
+ *
+ * @return
+ *      The number of worlds in the batch.
+ */
+int WorldBatch::get_count() const {
+	return this->count;
+}
+
+/**
+ * WorldBatch::get_running()
+ *
+ * @return
+ *      The number of worlds still being stepped, those neither extinct nor stable.
+ */
+int WorldBatch::get_running() const {
+	int total = 0;
+	for (uint64_t mask : this->running) {
+		total += __builtin_popcountll(mask);
+	}
+	return total;
+}
+
+/**
+ * WorldBatch::get_generation()
+ *
+ * @return
+ *      The number of steps taken by the batch. Frozen worlds keep their state but count the steps too.
+ */
+long long WorldBatch::get_generation() const {
+	return this->generation;
+}
+
+/**
+ * WorldBatch::check_world(world)
+ *
+ * Private helper which throws std::invalid_argument if world is not the index of a world in the batch.
+ */
+void WorldBatch::check_world(int world) const {
+	if (world < 0 || world >= this->count) {
+		throw std::invalid_argument("Invalid world index.\n");
+	}
+}
+
+/**
+ * WorldBatch::plane(group, side)
+ *
+ * Private helper returning the first cell, including the halo, of side 0 or 1 of a group's planes.
+ */
+uint64_t* WorldBatch::plane(int group, int side) {
+	return this->cells.data() + (size_t)(2 * group + side) * this->planeSize;
+}
+
+const uint64_t* WorldBatch::plane(int group, int side) const {
+	return this->cells.data() + (size_t)(2 * group + side) * this->planeSize;
+}
+
+/**
+ * WorldBatch::get_state(world)
+ *
+ * Copies the current state of one world out of the batch.
+ *
+ * @example
+ *
+ *      // Print the first world after 100 steps
+ *      batch.advance(100);
+ *      std::cout << batch.get_state(0) << std::endl;
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @return
+ *      A grid holding the world's cells.
+ *
+ * @throws
+ *      std::exception or sub-class if world is not a valid index.
+ */
+Grid WorldBatch::get_state(int world) const {
+	this->check_world(world);
+	int group = world / 64, bit = world % 64;
+	const uint64_t *current = this->plane(group, this->front[group]);
+	int stride = this->width + 2;
+
+	Grid state(this->width, this->height);
+	for (int y = 0; y < this->height; y++) {
+		const uint64_t *source = current + (y + 1) * stride + 1;
+		Cell *target = state.row(y);
+		for (int x = 0; x < this->width; x++) {
+			target[x] = ((source[x] >> bit) & 1) ? ALIVE : DEAD;
+		}
+	}
+	return state;
+}
+
+/**
+ * WorldBatch::set_state(world, state)
+ *
+ * Replaces the cells of one world, which is then running again from the batch's current generation.
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @param state
+ *      The new cells, of the same size as the batch.
+ *
+ * @throws
+ *      std::exception or sub-class if world is not a valid index or the grid is the wrong size.
+ */
+void WorldBatch::set_state(int world, const Grid &state) {
+	this->check_world(world);
+	if (state.get_width() != this->width || state.get_height() != this->height) {
+		throw std::invalid_argument("Grid does not match the size of the batch.\n");
+	}
+
+	int group = world / 64;
+	uint64_t bit = (uint64_t)1 << (world % 64);
+	uint64_t *current = this->plane(group, this->front[group]);
+	int stride = this->width + 2;
+	for (int y = 0; y < this->height; y++) {
+		const Cell *source = state.row(y);
+		uint64_t *target = current + (y + 1) * stride + 1;
+		for (int x = 0; x < this->width; x++) {
+			target[x] = (source[x] == ALIVE) ? (target[x] | bit) : (target[x] & ~bit);
+		}
+	}
+
+	this->running[group] |= bit;
+	this->status[world] = RUNNING;
+	this->finishedGeneration[world] = -1;
+}
+
+/**
+ * WorldBatch::get_population(world)
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @return
+ *      The number of alive cells in the world.
+ *
+ * @throws
+ *      std::exception or sub-class if world is not a valid index.
+ */
+long long WorldBatch::get_population(int world) const {
+	this->check_world(world);
+	int group = world / 64, bit = world % 64;
+	const uint64_t *current = this->plane(group, this->front[group]);
+	int stride = this->width + 2;
+
+	long long population = 0;
+	for (int y = 0; y < this->height; y++) {
+		const uint64_t *source = current + (y + 1) * stride + 1;
+		for (int x = 0; x < this->width; x++) {
+			population += (source[x] >> bit) & 1;
+		}
+	}
+	return population;
+}
+
+/**
+ * WorldBatch::get_status(world)
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @return
+ *      Whether the world is still running, extinct or stable.
+ *
+ * @throws
+ *      std::exception or sub-class if world is not a valid index.
+ */
+WorldStatus WorldBatch::get_status(int world) const {
+	this->check_world(world);
+	return this->status[world];
+}
+
+/**
+ * WorldBatch::get_finished_generation(world)
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @return
+ *      The generation at which the world was first seen dead, or unchanged from the generation before,
+ *      or -1 while it is running.
+ *
+ * @throws
+ *      std::exception or sub-class if world is not a valid index.
+ */
+long long WorldBatch::get_finished_generation(int world) const {
+	this->check_world(world);
+	return this->finishedGeneration[world];
+}
+
+/**
+ * WorldBatch::get_threads()
+ *
+ * @return
+ *      The number of threads used to step the batch, 1 when stepping serially.
+ */
+int WorldBatch::get_threads() const {
+	return this->pool ? this->pool->get_threads() : 1;
+}
+
+/**
+ * WorldBatch::set_threads(threads)
+ *
+ * Sets the number of threads used to step the batch. The threads are kept alive between steps.
+ *
+ * @param threads
+ *      The number of threads. Values of 1 or less step serially on the calling thread.
+ */
+void WorldBatch::set_threads(int threads) {
+	if (threads <= 1) {
+		this->pool.reset();
+	} else if (this->get_threads() != threads) {
+		this->pool = std::make_shared<ThreadPool>(threads);
+	}
+}
+
+/**
+ * WorldBatch::get_rule()
+ *
+ * @return
+ *      The rule every world in the batch is stepped with.
+ */
+Rule WorldBatch::get_rule() const {
+	return this->rule;
+}
+
+/**
+ * WorldBatch::set_rule(rule)
+ *
+ * Sets the rule every world is stepped with from the next step on.
+ * A world that finished under the old rule may not have under the new one, so every world runs again.
+ *
+ * @param rule
+ *      The Life-like rule to step with.
+ */
+void WorldBatch::set_rule(const Rule &rule) {
+	this->rule = rule;
+	this->restart();
+}
+
+/**
+ * WorldBatch::restart()
+ *
+ * Private helper which marks every world as running again.
+ */
+void WorldBatch::restart() {
+	for (size_t group = 0; group < this->running.size(); group++) {
+		int lanes = std::min(64, this->count - (int)group * 64);
+		this->running[group] = (lanes == 64) ? ~(uint64_t)0 : (((uint64_t)1 << lanes) - 1);
+	}
+	std::fill(this->status.begin(), this->status.end(), RUNNING);
+	std::fill(this->finishedGeneration.begin(), this->finishedGeneration.end(), -1);
+}
+
+/**
+ * WorldBatch::step_rows(rule, group, y0, y1, changed, alive)
+ *
+ * Private helper which steps the rows [y0, y1) of a group's 64 worlds. Frozen worlds keep their cells.
+ * Ors into changed the worlds with a cell that changed, and into alive the worlds with a cell alive.
+ * The halo of the group's current plane must already be refreshed for the step.
+ */
+template<typename RuleType>
+void WorldBatch::step_rows(const RuleType &rule, int group, int y0, int y1, uint64_t &changed, uint64_t &alive) {
+	int stride = this->width + 2;
+	const uint64_t *current = this->plane(group, this->front[group]);
+	uint64_t *next = this->plane(group, this->front[group] ^ 1);
+	uint64_t keep = this->running[group];
+
+	for (int y = y0; y < y1; y++) {
+		const uint64_t *above = current + y * stride + 1;
+		const uint64_t *middle = above + stride;
+		const uint64_t *below = middle + stride;
+		uint64_t *target = next + (y + 1) * stride + 1;
+		for (int x = 0; x < this->width; x++) {
+			//the neighbours of a cell are the same cell of the same worlds, so no shifting is needed
+			uint64_t result = rule_word(rule, above[x - 1], above[x], above[x + 1], middle[x - 1], middle[x], middle[x + 1],
+					below[x - 1], below[x], below[x + 1]);
+			result = (result & keep) | (middle[x] & ~keep);
+			target[x] = result;
+			changed |= result ^ middle[x];
+			alive |= result;
+		}
+	}
+}
+
+/**
+ * WorldBatch::step(toroidal)
+ *
+ * Take one step in every running world.
+ *
+ * A world with no alive cells left becomes WorldStatus::EXTINCT (unless the rule gives birth on 0
+ * neighbours, when an empty world does not stay empty), and a world the step left unchanged becomes
+ * WorldStatus::STABLE. Either way it stops being stepped and keeps its cells from then on.
+ *
+ * Worlds finish for one topology, so stepping with a different toroidal than the last step runs every world again.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then every world is a torus, where the left edge wraps to
+ *      the right edge and the top to the bottom. Defaults to false.
+ */
+void WorldBatch::step(bool toroidal) {
+	if (toroidal != this->statusToroidal) {
+		this->restart();
+		this->statusToroidal = toroidal;
+	}
+
+	this->activeGroups.clear();
+	{
+		Stats::Timer timer(Stats::HALO);
+		for (int group = 0; group < (int)this->running.size(); group++) {
+			if (this->running[group] != 0) {
+				refresh_plane_halo(this->plane(group, this->front[group]), this->width, this->height, toroidal);
+				this->activeGroups.push_back(group);
+			}
+		}
+	}
+	Stats::Timer timer(Stats::STEP);
+
+	//one task per group, split into bands of rows when there are spare threads
+	int groups = (int)this->activeGroups.size();
+	int bands = std::max(1, std::min(this->height, groups > 0 ? this->get_threads() / groups : 1));
+	int rowsPerBand = (this->height + bands - 1) / bands;
+	int tasks = groups * bands;
+	this->partialMasks.assign((size_t)2 * tasks, 0);
+
+	with_rule(this->rule, [&](const auto &rule) {
+		std::function<void(int)> task = [&](int i) {
+			int y0 = (i % bands) * rowsPerBand;
+			int y1 = std::min(this->height, y0 + rowsPerBand);
+			if (y0 < y1) {
+				this->step_rows(rule, this->activeGroups[i / bands], y0, y1, this->partialMasks[2 * i], this->partialMasks[2 * i + 1]);
+			}
+		};
+		if (this->pool && tasks > 1) {
+			this->pool->run(tasks, task);
+		} else {
+			for (int i = 0; i < tasks; i++) {
+				task(i);
+			}
+		}
+	});
+
+	this->generation++;
+	Stats::count_cells((unsigned long long)groups * 64 * this->width * this->height);
+	bool deadStaysDead = (this->rule.birth & 1) == 0;
+	for (int g = 0; g < groups; g++) {
+		int group = this->activeGroups[g];
+		uint64_t changed = 0, alive = 0;
+		for (int band = 0; band < bands; band++) {
+			changed |= this->partialMasks[2 * (g * bands + band)];
+			alive |= this->partialMasks[2 * (g * bands + band) + 1];
+		}
+		this->front[group] ^= 1;
+
+		//record the worlds that finished on this step, then freeze them
+		uint64_t extinct = deadStaysDead ? (this->running[group] & ~alive) : 0;
+		uint64_t stable = this->running[group] & ~changed & ~extinct;
+		for (uint64_t finished = extinct | stable; finished != 0; finished &= finished - 1) {
+			int bit = __builtin_ctzll(finished);
+			int world = group * 64 + bit;
+			this->status[world] = ((extinct >> bit) & 1) ? EXTINCT : STABLE;
+			this->finishedGeneration[world] = this->generation;
+		}
+		this->running[group] &= ~(extinct | stable);
+	}
+}
+
+/**
+ * WorldBatch::advance(steps, toroidal)
+ *
+ * Advance every world by multiple steps. Stops stepping as soon as every world has finished,
+ * since the frozen worlds cannot change, but still counts the remaining steps in the generation.
+ *
+ * @example
+ *
+ *      // Run 10000 random soups for up to 5000 generations and count the survivors
+ *      batch.advance(5000);
+ *      int survivors = 0;
+ *      for (int i = 0; i < batch.get_count(); i++) {
+ *          survivors += batch.get_status(i) != EXTINCT;
+ *      }
+ *
+ * @param steps
+ *      The number of steps to advance.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then every world is a torus. Defaults to false.
+ */
+void WorldBatch::advance(int steps, bool toroidal) {
+	for (int i = 0; i < steps; i++) {
+		if (toroidal == this->statusToroidal && this->get_running() == 0) {
+			this->generation += steps - i;
+			return;
+		}
+		this->step(toroidal);
+	}
+}
@@ -0,0 +1,93 @@
+/**
+ * Declares a class simulating many same sized worlds together, for parameter sweeps over many seeds.
+ * Rich documentation for the api and behaviour the WorldBatch class can be found in world_batch.cpp.
+ *
+ * @author 963541
+ * @date March, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "grid.h"
+#include "grid_allocator.h"
+#include "rule.h"
+#include "thread_pool.h"
+
+/**
+ * The state of one world in a batch.
+ *      - WorldStatus::RUNNING is still being stepped.
+ *      - WorldStatus::EXTINCT has no alive cells left.
+ *      - WorldStatus::STABLE is a still life, a step leaves it unchanged.
+ */
+enum WorldStatus {
+    RUNNING,
+    EXTINCT,
+    STABLE
+};
+
+/**
+ * Declare the structure of the WorldBatch class.
+ *
+ * The worlds are bit-sliced in groups of 64 (structure of arrays): a word holds the same cell of 64
+ * worlds, bit i for world i of the group, so one bit-parallel operation steps that cell in 64 worlds at once.
+ * Every group keeps a current and a next plane, padded with a one cell halo, in a single arena.
+ */
+class WorldBatch {
+public:
+	WorldBatch();
+	WorldBatch(int width, int height, int count);
+	explicit WorldBatch(const std::vector<Grid> &initial_states);
+
+	int get_width() const;
+	int get_height() const;
+	int get_count() const;
+	int get_running() const;
+	long long get_generation() const;
+
+	Grid get_state(int world) const;
+	void set_state(int world, const Grid &state);
+	long long get_population(int world) const;
+	WorldStatus get_status(int world) const;
+	long long get_finished_generation(int world) const;
+
+	int get_threads() const;
+	void set_threads(int threads);
+
+	Rule get_rule() const;
+	void set_rule(const Rule &rule);
+
+	void step(bool toroidal = false);
+	void advance(int steps, bool toroidal = false);
+
+private:
+	int width, height, count;
+	//cells per plane, including the halo
+	int planeSize;
+	//two planes per group, the current one is cells[(2 * group + front[group]) * planeSize]
+	std::vector<uint64_t, GridAllocator<uint64_t>> cells;
+	std::vector<char> front;
+	//per group masks of the worlds still being stepped
+	std::vector<uint64_t> running;
+	std::vector<WorldStatus> status;
+	std::vector<long long> finishedGeneration;
+	long long generation = 0;
+	bool statusToroidal = false;
+	Rule rule = ConwayRule();
+	//null when stepping serially
+	std::shared_ptr<ThreadPool> pool;
+
+	//scratch space reused by each step, the groups stepped and their partial change and alive masks
+	std::vector<int> activeGroups;
+	std::vector<uint64_t> partialMasks;
+
+	uint64_t* plane(int group, int side);
+	const uint64_t* plane(int group, int side) const;
+	void check_world(int world) const;
+	void restart();
+	template<typename RuleType>
+	void step_rows(const RuleType &rule, int group, int y0, int y1, uint64_t &changed, uint64_t &alive);
+};
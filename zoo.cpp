@@ -17,11 +17,241 @@
  *              - followed by (width * height) number of individual bits in C-style row/column format,
  *                padded with zero or more 0 bits.
  *              - a 0 bit should be considered Cell::DEAD, a 1 bit should be considered Cell::ALIVE.
+ *          - Binary files can also be loaded and saved through a memory mapping (POSIX mmap). When the width
+ *            is a multiple of 64 the payload is already laid out like a BitGrid and is used in place.
+ *
+ *      - Bit-packed grids can be saved to and loaded from a compressed snapshot format (.gols).
+ *          - Snapshot files are composed of (all ints little-endian):
+ *              - a 24 byte header: the magic bytes "GOLS", then 4 byte ints for the format version (1),
+ *                the grid width, the grid height, the tile size (64) and the number of stored tiles.
+ *              - a tile index with one 20 byte entry per stored tile, sorted by tile row then tile column:
+ *                4 byte tile column, 4 byte tile row, 8 byte file offset and 4 byte size of the payload.
+ *              - the tile payloads. A payload is a codec byte followed by the 64 rows of the tile as
+ *                8 byte little-endian words (bit x of a row is the cell at x), either raw (codec 0)
+ *                or PackBits run-length encoded (codec 1).
+ *          - Tiles without any alive cells are not stored, and any one tile can be read on its own.
+ *
+ *      - Grids can be loaded from and saved to the run length encoded (.rle) format used by Golly and the LifeWiki.
+ *          - RLE files can be decoded straight into a Grid, a BitGrid or an InfiniteWorld.
  *
  * @author 963541
  * @date March, 2020
  */
 #include "zoo.h"
+#include "stats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//size of the .bgol header, two 4 byte little-endian ints
+static const size_t HEADER_BYTES = 8;
+
+//helper function reading n (<= 64) bits starting at bit offset pos of a little-endian bitstream of numBytes bytes.
+//bits past the end of the stream read as 0.
+static uint64_t read_stream_bits(const unsigned char *bytes, size_t numBytes, uint64_t pos, int n) {
+	size_t first = pos / 8;
+	int shift = pos % 8;
+	uint64_t value = 0;
+	for (int i = 0; i < 8 && first + i < numBytes; i++) {
+		value |= ((uint64_t)bytes[first + i]) << (8 * i);
+	}
+	value >>= shift;
+	if (shift != 0 && first + 8 < numBytes) {
+		value |= ((uint64_t)bytes[first + 8]) << (64 - shift);
+	}
+	return (n == 64) ? value : (value & ((((uint64_t)1) << n) - 1));
+}
+
+//helper function writing the rows of a bit-packed grid back to back as a little-endian bitstream.
+//out must hold ceil(width * height / 8) bytes.
+static void pack_stream(const BitGrid &grid, unsigned char *out) {
+	uint64_t pending = 0;
+	int filled = 0;
+	for (int y = 0; y < grid.get_height(); y++) {
+		const uint64_t *source = grid.row(y);
+		for (int w = 0; w < grid.get_words_per_row(); w++) {
+			int n = std::min(64, grid.get_width() - w * 64);
+			uint64_t value = source[w];
+			pending |= value << filled;
+			if (filled + n < 64) {
+				filled += n;
+				continue;
+			}
+			//a full word is ready, emit it and keep the bits that did not fit
+			for (int i = 0; i < 8; i++) {
+				*out++ = (unsigned char)(pending >> (8 * i));
+			}
+			pending = (filled == 0) ? 0 : (value >> (64 - filled));
+			filled = filled + n - 64;
+		}
+	}
+	for (int i = 0; i * 8 < filled; i++) {
+		*out++ = (unsigned char)(pending >> (8 * i));
+	}
+}
+
+//helper function encoding rows [y0, y1) of a grid into the .bgol bitstream, one bit per cell.
+//row y0 must start on a byte boundary of the stream (y0 * width a multiple of 8). only the bytes holding
+//those rows are written, so bands of rows starting on multiples of 8 can be encoded at the same time.
+static void encode_rows(const GridView &grid, int y0, int y1, unsigned char *out) {
+	int width = grid.get_width();
+	out += (uint64_t)y0 * width / 8;
+	unsigned char pending = 0;
+	int filled = 0;
+	for (int y = y0; y < y1; y++) {
+		const Cell *cells = grid.is_contiguous() ? grid.row(y) : nullptr;
+		for (int x = 0; x < width; x++) {
+			Cell cell = cells ? cells[x] : grid(x, y);
+			pending |= (unsigned char)(cell == ALIVE) << filled;
+			if (++filled == 8) {
+				*out++ = pending;
+				pending = 0;
+				filled = 0;
+			}
+		}
+	}
+	if (filled > 0) {
+		*out = pending;
+	}
+}
+
+//helper function decoding rows [y0, y1) of a grid from the .bgol bitstream, 64 cells at a time.
+//the grid must start out dead, only alive cells are written.
+static void decode_rows(const unsigned char *bytes, size_t numBytes, int y0, int y1, Grid &grid) {
+	int width = grid.get_width();
+	for (int y = y0; y < y1; y++) {
+		Cell *cells = grid.row(y);
+		for (int x = 0; x < width; x += 64) {
+			int n = std::min(64, width - x);
+			uint64_t word = read_stream_bits(bytes, numBytes, (uint64_t)y * width + x, n);
+			//visit only the set bits
+			while (word != 0) {
+				cells[x + __builtin_ctzll(word)] = ALIVE;
+				word &= word - 1;
+			}
+		}
+	}
+}
+
+//helper function writing the low (bytes) bytes of value little-endian
+static void put_le(unsigned char *out, uint64_t value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		out[i] = (unsigned char)(value >> (8 * i));
+	}
+}
+
+//helper function reading a (bytes) byte little-endian unsigned int
+static uint64_t get_le(const unsigned char *in, int bytes) {
+	uint64_t value = 0;
+	for (int i = 0; i < bytes; i++) {
+		value |= ((uint64_t)in[i]) << (8 * i);
+	}
+	return value;
+}
+
+//helper function encoding the .bgol header
+static void write_header(unsigned char *headBytes, int width, int height) {
+	put_le(headBytes, (uint32_t)width, 4);
+	put_le(headBytes + 4, (uint32_t)height, 4);
+}
+
+//helper function decoding the .bgol header
+static void read_header(const unsigned char *headBytes, int &width, int &height) {
+	width = (int)(uint32_t)get_le(headBytes, 4);
+	height = (int)(uint32_t)get_le(headBytes + 4, 4);
+}
+
+//true when the in-memory word layout of a BitGrid of this width is byte for byte the .bgol bitstream
+static bool stream_matches_words(int width) {
+	return (width % 64 == 0) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+}
+
+/**
+ * Reads an input stream in large blocks so parsers can walk the bytes in memory instead of calling
+ * std::istream::get() once per character.
+ */
+class AsciiReader {
+public:
+	explicit AsciiReader(std::istream &input) : input(input), buffer(BLOCK_BYTES), begin(0), end(0) {}
+
+	//number of buffered bytes not yet consumed
+	size_t available() const {
+		return end - begin;
+	}
+
+	//the next (count) bytes, or nullptr if the stream ends first. the bytes are consumed.
+	const char* take(size_t count) {
+		if (!fill(count)) {
+			return nullptr;
+		}
+		const char *bytes = buffer.data() + begin;
+		begin += count;
+		return bytes;
+	}
+
+	//the buffered bytes up to and including the next newline (not consumed), or nullptr if there is none
+	const char* line() {
+		size_t scanned = 0;
+		while (std::memchr(buffer.data() + begin + scanned, '\n', available() - scanned) == nullptr) {
+			scanned = available();
+			if (!fill(available() + 1)) {
+				return nullptr;
+			}
+		}
+		return buffer.data() + begin;
+	}
+
+	void consume(size_t count) {
+		begin += count;
+	}
+
+	//all of the buffered bytes (not consumed), reading another block if none are left. 0 at the end of the stream.
+	size_t block(const char *&bytes) {
+		fill(1);
+		bytes = buffer.data() + begin;
+		return available();
+	}
+
+private:
+	static const size_t BLOCK_BYTES = 1 << 20;
+
+	std::istream &input;
+	std::vector<char> buffer;
+	size_t begin, end;
+
+	//make sure at least (count) bytes are buffered, reading whole blocks at a time
+	bool fill(size_t count) {
+		if (available() >= count) {
+			return true;
+		}
+		//move the unconsumed tail to the front and grow for rows longer than a block
+		std::memmove(buffer.data(), buffer.data() + begin, available());
+		end -= begin;
+		begin = 0;
+		if (buffer.size() < count) {
+			buffer.resize(std::max(count, 2 * buffer.size()));
+		}
+		while (end < count && input) {
+			input.read(buffer.data() + end, buffer.size() - end);
+			end += input.gcount();
+		}
+		return end >= count;
+	}
+};
 
 // int main(int argc, char const *argv[]) {
 // 	Grid grid(6);
@@ -146,7 +376,8 @@ Grid Zoo::glider() {
  * Zoo::load_ascii(path)
  *
  * Load an ascii file and parse it as a grid of cells.
- * Should be implemented using std::ifstream.
+ * The file is read through std::ifstream in 1MB blocks and parsed a whole row at a time,
+ * so the width and height may be any number of digits and large patterns load at disk speed.
  *
  * @example
  *
@@ -168,72 +399,61 @@ Grid Zoo::glider() {
  */
 
 Grid Zoo::load_ascii(std::string path) {
-	std::ifstream inputFile;
-	inputFile.exceptions (std::ifstream::badbit);
-	Grid parsedGrid;
-	try {
-    	inputFile.open(path);
-		char widthChar;
-		char heightChar;
-		//first get width and height chars
-		widthChar = inputFile.get();
-		inputFile.get();
-		heightChar = inputFile.get();
-
-
-    	// while (!inputFile.eof()) {
-		// 	std::string line;
-		//
-		// 	getline(inputFile,line);
-		//  	std::cout << line << '\n';
-		//
-		//  }
-		char buffer;
-		//converts width char from ascii to actual int value
-		int width = (int)widthChar - (int)'0' ;
-		int height = (int)heightChar - (int)'0';
-
-		if (width < 0 || height < 0) {
-			//invalid coords.
-			throw std::runtime_error("invalid width or height (<0)");
-		}
-		inputFile.get();
-		//make grid correct size
- 	 	parsedGrid.resize(width, height);
-
-		for(int y = 0; y < height; y++) {
-			for(int x = 0; x < width; x++) {
-				buffer = inputFile.get();
-				//for each coord in grid retrieve value from text file
-				if (buffer == '#') {
-					//set cell to correct state
-					parsedGrid.set(x,y,ALIVE);
-				} else if ( buffer == ' ')  {
-					//a bit redundant but makes code clearer
-					parsedGrid.set(x,y,DEAD);
-				} else {
-					// throws exception if any other char is present
-					throw std::runtime_error("invalid cell status/char");
-				}
-			}
-
-			buffer =inputFile.get();
-			//if buffer is not a line width is set incorrectly.
-			if (buffer != '\n') {
-				throw std::runtime_error("invalid charecter at end of line should be \n");
-			}
-		}
+	std::ifstream inputFile(path, std::ios::in | std::ios::binary);
+	if (!inputFile) {
+		throw std::runtime_error("Failed to open ascii file.");
+	}
+	AsciiReader reader(inputFile);
 
-		 inputFile.close();
+	//header line, two multi-digit integers separated by a space
+	const char *line = reader.line();
+	if (line == nullptr) {
+		throw std::runtime_error("missing width and height header line");
+	}
+	const char *lineEnd = (const char*)std::memchr(line, '\n', reader.available());
+	int width, height;
+	auto parsedWidth = std::from_chars(line, lineEnd, width);
+	if (parsedWidth.ec != std::errc() || parsedWidth.ptr == lineEnd || *parsedWidth.ptr != ' ') {
+		throw std::runtime_error("invalid width or height");
+	}
+	auto parsedHeight = std::from_chars(parsedWidth.ptr + 1, lineEnd, height);
+	if (parsedHeight.ec != std::errc() || parsedHeight.ptr != lineEnd) {
+		throw std::runtime_error("invalid width or height");
+	}
+	if (width < 0 || height < 0) {
+		//invalid coords.
+		throw std::runtime_error("invalid width or height (<0)");
+	}
+	reader.consume(lineEnd - line + 1);
 
-  		}
-  	catch (std::ifstream::failure e) {
-    	std::cerr << "Exception opening/reading/closing file\n";
-  	}
-	return parsedGrid;
+	//make grid correct size
+	Grid parsedGrid(width, height);
 
+	for (int y = 0; y < height; y++) {
+		//each row is exactly width cells and a newline
+		const char *cells = reader.take(width + 1);
+		if (cells == nullptr) {
+			throw std::runtime_error("file ends before the last row");
+		}
+		if (cells[width] != '\n' || std::memchr(cells, '\n', width) != nullptr) {
+			throw std::runtime_error("invalid charecter at end of line should be \n");
+		}
 
+		Cell *row = parsedGrid.row(y);
+		for (int x = 0; x < width; x++) {
+			//for each coord in grid retrieve value from text file
+			if (cells[x] == '#') {
+				row[x] = ALIVE;
+			} else if (cells[x] == ' ') {
+				row[x] = DEAD;
+			} else {
+				// throws exception if any other char is present
+				throw std::runtime_error("invalid cell status/char");
+			}
+		}
+	}
 
+	return parsedGrid;
 }
 
 /**
@@ -265,8 +485,31 @@ Grid Zoo::load_ascii(std::string path) {
  *      Throws std::runtime_error or sub-class if the file cannot be opened.
  */
 
-void Zoo::save_ascii(std::string path,Grid grid) {
-	 std::ofstream writefile(path);
+void Zoo::save_ascii(std::string path, const Grid &grid) {
+	Zoo::save_ascii(path, GridView(grid));
+}
+
+/**
+ * Zoo::save_ascii(path, grid)
+ *
+ * Save a view of a grid, e.g. a cropped region of a board, as an ascii .gol file without copying it out first.
+ *
+ * @example
+ *
+ *      // Save the top left 32x32 of the board
+ *      Zoo::save_ascii("path/to/corner.gol", GridView(board).crop(0, 0, 32, 32));
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The view to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_ascii(std::string path, const GridView &grid) {
+	 std::ofstream writefile(path, std::ios::out | std::ios::binary);
 	 if (writefile.fail()) {
 		 throw std::runtime_error("failed to open output file");
 
@@ -275,16 +518,20 @@ void Zoo::save_ascii(std::string path,Grid grid) {
 	//writes height and width of grid to file
 	 writefile<< grid.get_width() << " " << grid.get_height() << '\n';
 
+	 //build each line in memory and write it in one go
+	 std::string line(grid.get_width() + 1, '\n');
 	 for(int y = 0; y < grid.get_height(); y++) {
-		 for(int x = 0; x < grid.get_height(); x++) {
-			 //loop through grid adding cell value to file.
-			 if (grid.get(x,y) == ALIVE) {
-				 writefile << "#";
-			 } else if (grid.get(x,y) == DEAD) {
-				 writefile << " ";
+		 if (grid.is_contiguous()) {
+			 const Cell *row = grid.row(y);
+			 for(int x = 0; x < grid.get_width(); x++) {
+				 line[x] = (row[x] == ALIVE) ? '#' : ' ';
+			 }
+		 } else {
+			 for(int x = 0; x < grid.get_width(); x++) {
+				 line[x] = (grid(x, y) == ALIVE) ? '#' : ' ';
 			 }
 		 }
-		 writefile << '\n';
+		 writefile.write(line.data(), line.size());
 	 }
 
 	 writefile.close();
@@ -314,6 +561,36 @@ void Zoo::save_ascii(std::string path,Grid grid) {
  */
 
 Grid Zoo::load_binary(std::string path) {
+	return Zoo::load_binary(path, ExecutionPolicy::sequential());
+}
+
+/**
+ * Zoo::load_binary(path, policy)
+ *
+ * Load a binary file and parse it as a grid of cells, as with Zoo::load_binary(path).
+ * The payload is read in one go, then bands of rows are decoded from it under the policy,
+ * each band writing only its own rows of the grid.
+ *
+ * @example
+ *
+ *      // Decode a huge board on every core
+ *      Grid grid = Zoo::load_binary("path/to/huge.bgol", ExecutionPolicy::parallel());
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param policy
+ *      Whether to decode serially or in parallel.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file ends unexpectedly.
+ */
+Grid Zoo::load_binary(std::string path, const ExecutionPolicy &policy) {
 	int width, height;
 	Grid loadGrid;
 
@@ -324,34 +601,25 @@ Grid Zoo::load_binary(std::string path) {
 
 	try {
 		//read in height and width from file and create blank grid of that size
-		inputFile.read((char*)&width, sizeof(int));
-		inputFile.read((char*)&height, sizeof(int));
+		unsigned char headBytes[HEADER_BYTES];
+		if (!inputFile.read((char*)headBytes, sizeof(headBytes))) {
+			throw std::runtime_error("Failed to read from binary file (incorrect format?).");
+		}
+		read_header(headBytes, width, height);
 		loadGrid = Grid(width, height);
 
 		//read in bytes from binary file.
-		int numBytes = ((height*width)+((height*width)%8))/8;
-		unsigned char cellBytes[numBytes] = {0};
-		inputFile.read((char*)&cellBytes, sizeof(char)*numBytes);
-
-		//convert bytes array to cells and add to grid.
-		for (int i = 0; i < numBytes; i++) {
-			for (int j = 0; j < 8; j++) {
-				//check if we have run out of bits
-				int curBit = i*8 + j;
-				if (curBit >= height*width) {
-					break;
-				}
-				//calculate 2D grid location from current bit number(1D)
-				int x = (curBit%width);
-				int y = (int)curBit/(width);
-
-				if (cellBytes[i] & (1 << j)) {
-					loadGrid.set(x, y, Cell::ALIVE);
-				}
-
-			}
+		size_t numBytes = ((uint64_t)width * height + 7) / 8;
+		std::vector<unsigned char> cellBytes(numBytes, 0);
+		if (!inputFile.read((char*)cellBytes.data(), numBytes)) {
+			throw std::runtime_error("Binary file ends before the last cell (truncated?).");
 		}
-	} catch (std::exception e) {
+
+		//convert bytes array to cells and add to grid, a band of rows at a time.
+		policy.for_bands(height, width, 1, [&](int y0, int y1) {
+			decode_rows(cellBytes.data(), numBytes, y0, y1, loadGrid);
+		});
+	} catch (const std::exception &) {
 		throw std::runtime_error("Failed to read from binary file (incorrect format?).");
 	}
 
@@ -390,7 +658,75 @@ Grid Zoo::load_binary(std::string path) {
  *      Throws std::runtime_error or sub-class if the file cannot be opened.
  */
 
- void Zoo::save_binary(std::string path, Grid grid) {
+ void Zoo::save_binary(std::string path, const Grid &grid) {
+	Zoo::save_binary(path, GridView(grid));
+ }
+
+/**
+ * Zoo::save_binary(path, grid, policy)
+ *
+ * Save a grid as a binary .bgol file, as with Zoo::save_binary(path, grid), encoding bands of rows under the policy.
+ *
+ * @example
+ *
+ *      // Encode a huge board on every core
+ *      Zoo::save_binary("path/to/huge.bgol", board, ExecutionPolicy::parallel());
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @param policy
+ *      Whether to encode serially or in parallel.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_binary(std::string path, const Grid &grid, const ExecutionPolicy &policy) {
+	Zoo::save_binary(path, GridView(grid), policy);
+}
+
+/**
+ * Zoo::save_binary(path, grid)
+ *
+ * Save a view of a grid, e.g. a cropped or rotated region of a board, as a binary .bgol file
+ * without copying it out first.
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The view to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+ void Zoo::save_binary(std::string path, const GridView &grid) {
+	Zoo::save_binary(path, grid, ExecutionPolicy::sequential());
+ }
+
+/**
+ * Zoo::save_binary(path, grid, policy)
+ *
+ * Save a view of a grid as a binary .bgol file, encoding bands of rows under the policy.
+ * Every band but the last starts on a multiple of 8 rows, so it starts on a byte of the bitstream and
+ * writes its own bytes of the preallocated buffer. The file is the same for every policy.
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The view to be written out to file.
+ *
+ * @param policy
+ *      Whether to encode serially or in parallel.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_binary(std::string path, const GridView &grid, const ExecutionPolicy &policy) {
 	//open/create the file to be written to
 	std::ofstream outputFile (path, std::ios::out | std::ios::binary);
 	if (!outputFile.is_open()) {
@@ -402,46 +738,1153 @@ Grid Zoo::load_binary(std::string path) {
 	int height = grid.get_height();
 
 	//explicitly creating byte array for first the height and width integers
-	unsigned char headBytes[sizeof(int)*2];
-	headBytes[0] = (char)(width  << 0);
-	headBytes[1] = (char)(width  << 8);
-	headBytes[2] = (char)(width  << 16);
-	headBytes[3] = (char)(width  << 24);
-	headBytes[4] = (char)(height << 0);
-	headBytes[5] = (char)(height << 8);
-	headBytes[6] = (char)(height << 16);
-	headBytes[7] = (char)(height << 24);
-
-	//initialise the correct byte size for the grid
-	int numBytes = ((height*width)+((height*width)%8))/8;
-	unsigned char gridBytes[numBytes] = {0};
-
-	//assign values to the grid bytes
-	for (int i = 0; i < numBytes; i++) {
-		for (int j = 0; j < 8; j++) {
-			// Check if we have finished writing headBytes
-			int curBit = i*8 + j;
-			if (curBit >= height*width) {
-				break;
-			}
+	unsigned char headBytes[HEADER_BYTES];
+	write_header(headBytes, width, height);
 
-			//Calculate the 2d grid location of the next bit to be written
-			int x = curBit%width;
-			int y = (int)curBit/width;
+	//initialise the correct byte size for the grid, then fill it a band of rows at a time
+	size_t numBytes = ((uint64_t)width * height + 7) / 8;
+	std::vector<unsigned char> gridBytes(numBytes, 0);
+	policy.for_bands(height, width, 8, [&](int y0, int y1) {
+		encode_rows(grid, y0, y1, gridBytes.data());
+	});
+
+	//Write to file
+	outputFile.write((char*)headBytes, sizeof(headBytes));
+	outputFile.write((char*)gridBytes.data(), numBytes);
+}
 
-			//0010 0110
-			//|
-			//0100 0000
-			//0110 0110
 
-			//If it's an alive cell, assign the bit as 1
-			if (grid(x, y) == Cell::ALIVE) {
-				gridBytes[i] = gridBytes[i] | (1 << j);
-			}
+/**
+ * Zoo::load_binary_packed(path)
+ *
+ * Load a binary .bgol file straight into a bit-packed grid.
+ * The payload is already one bit per cell, so rows are lifted out of the bitstream 64 cells at a time
+ * instead of being decoded cell by cell.
+ *
+ * @example
+ *
+ *      // Load a binary file from a directory
+ *      BitGrid grid = Zoo::load_binary_packed("path/to/file.bgol");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed bit-packed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file ends unexpectedly.
+ */
+BitGrid Zoo::load_binary_packed(std::string path) {
+	std::ifstream inputFile(path.c_str(), std::ios::in | std::ios::binary);
+	if (!inputFile) {
+		throw std::runtime_error("Failed to open binary file.");
+	}
+
+	unsigned char headBytes[HEADER_BYTES];
+	if (!inputFile.read((char*)headBytes, sizeof(headBytes))) {
+		throw std::runtime_error("Failed to read from binary file (incorrect format?).");
+	}
+
+	int width, height;
+	read_header(headBytes, width, height);
+	if (width < 0 || height < 0) {
+		throw std::runtime_error("Failed to read from binary file (incorrect format?).");
+	}
+
+	size_t numBytes = ((uint64_t)width * height + 7) / 8;
+	std::vector<unsigned char> cellBytes(numBytes, 0);
+	if (!inputFile.read((char*)cellBytes.data(), numBytes)) {
+		throw std::runtime_error("Binary file ends before the last cell (truncated?).");
+	}
+
+	BitGrid loadGrid(width, height);
+	for (int y = 0; y < height; y++) {
+		uint64_t *target = loadGrid.row(y);
+		for (int w = 0; w < loadGrid.get_words_per_row(); w++) {
+			int n = std::min(64, width - w * 64);
+			target[w] = read_stream_bits(cellBytes.data(), numBytes, (uint64_t)y * width + w * 64, n);
 		}
 	}
 
-	//Write to file
-	outputFile.write((char*)&headBytes, sizeof(int)*2);
-	outputFile.write((char*)&gridBytes, sizeof(char)*numBytes);
- }
+	inputFile.close();
+
+	return loadGrid;
+}
+
+
+/**
+ * Zoo::save_binary(path, grid)
+ *
+ * Save a bit-packed grid as a binary .bgol file according to the specified file format.
+ * Rows are appended to the bitstream 64 cells at a time.
+ *
+ * @example
+ *
+ *      // Save a bit-packed grid to a binary file in a directory
+ *      Zoo::save_binary("path/to/file.bgol", BitGrid(Zoo::glider()));
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The bit-packed grid to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_binary(std::string path, const BitGrid &grid) {
+	std::ofstream outputFile (path, std::ios::out | std::ios::binary);
+	if (!outputFile.is_open()) {
+		throw std::runtime_error("Failed to open output file.");
+	}
+
+	unsigned char headBytes[HEADER_BYTES];
+	write_header(headBytes, grid.get_width(), grid.get_height());
+
+	//pack each row onto the end of the bitstream a word at a time
+	size_t numBytes = ((uint64_t)grid.get_width() * grid.get_height() + 7) / 8;
+	std::vector<unsigned char> gridBytes(numBytes);
+	pack_stream(grid, gridBytes.data());
+
+	outputFile.write((char*)headBytes, sizeof(headBytes));
+	outputFile.write((char*)gridBytes.data(), numBytes);
+}
+
+
+/**
+ * Zoo::load_binary_mapped(path)
+ *
+ * Load a binary .bgol file by mapping it into memory.
+ *
+ * When each row of the file fills a whole number of 64 bit words (the width is a multiple of 64) the file
+ * layout is exactly the BitGrid layout, so the returned grid wraps the mapping directly and nothing is copied
+ * or parsed: pages are only read in from disk as they are touched. The mapping is private, so changes made
+ * to the grid are never written back to the file. Other widths are spliced out of the mapping into a new grid
+ * 64 cells at a time.
+ *
+ * @example
+ *
+ *      // Map a multi-GB snapshot and start stepping it straight away
+ *      World world(Zoo::load_binary_mapped("path/to/snapshot.bgol").to_grid());
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed bit-packed grid, which may wrap the mapped file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened or mapped.
+ *          - The file ends unexpectedly.
+ */
+BitGrid Zoo::load_binary_mapped(std::string path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("Failed to open binary file.");
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t)info.st_size < HEADER_BYTES) {
+		close(fd);
+		throw std::runtime_error("Failed to read from binary file (incorrect format?).");
+	}
+	size_t size = info.st_size;
+
+	//private and writable, so the grid can be stepped in place without touching the file
+	void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		throw std::runtime_error("Failed to map binary file.");
+	}
+	std::shared_ptr<void> mapping(base, [size](void *pointer) { munmap(pointer, size); });
+
+	const unsigned char *bytes = (const unsigned char*)base;
+	int width, height;
+	read_header(bytes, width, height);
+	size_t numBytes = ((uint64_t)width * height + 7) / 8;
+	if (width < 0 || height < 0 || size < HEADER_BYTES + numBytes) {
+		throw std::runtime_error("Failed to read from binary file (incorrect format?).");
+	}
+
+	if (stream_matches_words(width)) {
+		//the header is 8 bytes, so the payload of a page aligned mapping is word aligned
+		return BitGrid(width, height, (uint64_t*)(bytes + HEADER_BYTES), mapping);
+	}
+
+	BitGrid loadGrid(width, height);
+	for (int y = 0; y < height; y++) {
+		uint64_t *target = loadGrid.row(y);
+		for (int w = 0; w < loadGrid.get_words_per_row(); w++) {
+			int n = std::min(64, width - w * 64);
+			target[w] = read_stream_bits(bytes + HEADER_BYTES, numBytes, (uint64_t)y * width + w * 64, n);
+		}
+	}
+	return loadGrid;
+}
+
+
+/**
+ * Zoo::save_binary_mapped(path, grid)
+ *
+ * Save a bit-packed grid as a binary .bgol file by mapping the output file into memory and writing
+ * straight into it. When the width is a multiple of 64 each row is a single block copy.
+ *
+ * @example
+ *
+ *      // Snapshot a large packed grid
+ *      Zoo::save_binary_mapped("path/to/snapshot.bgol", grid);
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The bit-packed grid to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be created, sized or mapped.
+ */
+void Zoo::save_binary_mapped(std::string path, const BitGrid &grid) {
+	int width = grid.get_width();
+	int height = grid.get_height();
+	size_t numBytes = ((uint64_t)width * height + 7) / 8;
+	size_t size = HEADER_BYTES + numBytes;
+
+	int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		throw std::runtime_error("Failed to open output file.");
+	}
+	if (ftruncate(fd, size) != 0) {
+		close(fd);
+		throw std::runtime_error("Failed to size output file.");
+	}
+
+	void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		throw std::runtime_error("Failed to map output file.");
+	}
+
+	unsigned char *bytes = (unsigned char*)base;
+	write_header(bytes, width, height);
+	if (stream_matches_words(width)) {
+		size_t rowBytes = (size_t)grid.get_words_per_row() * sizeof(uint64_t);
+		//a grid 0 cells wide has no rows to copy, and row(y) is null
+		for (int y = 0; rowBytes > 0 && y < height; y++) {
+			std::memcpy(bytes + HEADER_BYTES + y * rowBytes, grid.row(y), rowBytes);
+		}
+	} else {
+		pack_stream(grid, bytes + HEADER_BYTES);
+	}
+
+	munmap(base, size);
+}
+
+
+//snapshot container constants, see the file format description at the top of this file
+static const char SNAPSHOT_MAGIC[4] = {'G', 'O', 'L', 'S'};
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const int SNAPSHOT_TILE = 64;
+static const size_t SNAPSHOT_HEADER_BYTES = 24;
+static const size_t SNAPSHOT_ENTRY_BYTES = 20;
+static const size_t SNAPSHOT_TILE_BYTES = SNAPSHOT_TILE * sizeof(uint64_t);
+
+//tile payload codecs
+enum TileCodec {
+	TILE_RAW = 0,
+	TILE_PACKBITS = 1
+};
+
+/**
+ * One entry of the snapshot tile index, tiles are stored in row-major order of (ty, tx).
+ */
+struct TileEntry {
+	uint32_t tx, ty;
+	uint64_t offset;
+	uint32_t size;
+};
+
+//helper function serialising a tile of 64 rows into 512 little-endian bytes
+static void tile_to_bytes(const BitGrid &grid, int tx, int ty, unsigned char *out) {
+	for (int r = 0; r < SNAPSHOT_TILE; r++) {
+		int y = ty * SNAPSHOT_TILE + r;
+		uint64_t value = (y < grid.get_height()) ? grid.row(y)[tx] : 0;
+		put_le(out + r * sizeof(uint64_t), value, sizeof(uint64_t));
+	}
+}
+
+//helper function PackBits encoding bytes, returning the encoded length
+//a control byte c < 128 is followed by c + 1 literal bytes, c > 128 repeats the next byte 257 - c times
+static size_t packbits_encode(const unsigned char *in, size_t length, unsigned char *out) {
+	size_t written = 0;
+	size_t i = 0;
+	while (i < length) {
+		size_t run = 1;
+		while (i + run < length && run < 128 && in[i + run] == in[i]) {
+			run++;
+		}
+		if (run >= 2) {
+			out[written++] = (unsigned char)(257 - run);
+			out[written++] = in[i];
+			i += run;
+			continue;
+		}
+		//gather literals up to the next run of at least 2
+		size_t start = i;
+		while (i < length && i - start < 128 && !(i + 1 < length && in[i + 1] == in[i])) {
+			i++;
+		}
+		out[written++] = (unsigned char)(i - start - 1);
+		std::memcpy(out + written, in + start, i - start);
+		written += i - start;
+	}
+	return written;
+}
+
+//helper function PackBits decoding exactly length bytes, returning false on a malformed payload
+static bool packbits_decode(const unsigned char *in, size_t size, unsigned char *out, size_t length) {
+	size_t read = 0;
+	size_t written = 0;
+	while (read < size) {
+		unsigned char control = in[read++];
+		if (control < 128) {
+			size_t count = control + 1;
+			if (read + count > size || written + count > length) {
+				return false;
+			}
+			std::memcpy(out + written, in + read, count);
+			read += count;
+			written += count;
+		} else if (control > 128) {
+			size_t count = 257 - control;
+			if (read >= size || written + count > length) {
+				return false;
+			}
+			std::memset(out + written, in[read++], count);
+			written += count;
+		}
+	}
+	return written == length;
+}
+
+//helper function reading a snapshot header and tile index
+static void read_snapshot_index(std::ifstream &inputFile, int &width, int &height, std::vector<TileEntry> &entries) {
+	unsigned char headBytes[SNAPSHOT_HEADER_BYTES];
+	if (!inputFile.read((char*)headBytes, sizeof(headBytes)) || std::memcmp(headBytes, SNAPSHOT_MAGIC, 4) != 0) {
+		throw std::runtime_error("Failed to read from snapshot file (incorrect format?).");
+	}
+	if (get_le(headBytes + 4, 4) != SNAPSHOT_VERSION || get_le(headBytes + 16, 4) != (uint64_t)SNAPSHOT_TILE) {
+		throw std::runtime_error("Unsupported snapshot version.");
+	}
+	width = (int)(uint32_t)get_le(headBytes + 8, 4);
+	height = (int)(uint32_t)get_le(headBytes + 12, 4);
+	uint64_t count = get_le(headBytes + 20, 4);
+	uint64_t tilesX = ((uint64_t)width + SNAPSHOT_TILE - 1) / SNAPSHOT_TILE;
+	uint64_t tilesY = ((uint64_t)height + SNAPSHOT_TILE - 1) / SNAPSHOT_TILE;
+	if (width < 0 || height < 0 || count > tilesX * tilesY) {
+		throw std::runtime_error("Failed to read from snapshot file (incorrect format?).");
+	}
+
+	std::vector<unsigned char> indexBytes(count * SNAPSHOT_ENTRY_BYTES);
+	if (!inputFile.read((char*)indexBytes.data(), indexBytes.size())) {
+		throw std::runtime_error("Failed to read from snapshot file (incorrect format?).");
+	}
+	entries.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		const unsigned char *entry = indexBytes.data() + i * SNAPSHOT_ENTRY_BYTES;
+		entries[i].tx = (uint32_t)get_le(entry, 4);
+		entries[i].ty = (uint32_t)get_le(entry + 4, 4);
+		entries[i].offset = get_le(entry + 8, 8);
+		entries[i].size = (uint32_t)get_le(entry + 16, 4);
+		if (entries[i].tx >= tilesX || entries[i].ty >= tilesY || entries[i].size == 0) {
+			throw std::runtime_error("Failed to read from snapshot file (incorrect format?).");
+		}
+	}
+}
+
+//helper function reading and decoding one tile into 64 rows
+static void read_snapshot_tile(std::ifstream &inputFile, const TileEntry &entry, uint64_t rows[SNAPSHOT_TILE]) {
+	std::vector<unsigned char> payload(entry.size);
+	inputFile.seekg(entry.offset);
+	if (!inputFile.read((char*)payload.data(), payload.size())) {
+		throw std::runtime_error("Failed to read from snapshot file (incorrect format?).");
+	}
+
+	unsigned char tileBytes[SNAPSHOT_TILE_BYTES];
+	bool valid = false;
+	if (payload[0] == TILE_RAW) {
+		valid = payload.size() == SNAPSHOT_TILE_BYTES + 1;
+		if (valid) {
+			std::memcpy(tileBytes, payload.data() + 1, SNAPSHOT_TILE_BYTES);
+		}
+	} else if (payload[0] == TILE_PACKBITS) {
+		valid = packbits_decode(payload.data() + 1, payload.size() - 1, tileBytes, SNAPSHOT_TILE_BYTES);
+	}
+	if (!valid) {
+		throw std::runtime_error("Failed to read from snapshot file (corrupt tile).");
+	}
+
+	for (int r = 0; r < SNAPSHOT_TILE; r++) {
+		rows[r] = get_le(tileBytes + r * sizeof(uint64_t), sizeof(uint64_t));
+	}
+}
+
+/**
+ * Zoo::save_snapshot(path, grid)
+ *
+ * Save a bit-packed grid as a compressed .gols snapshot.
+ * The grid is cut into 64x64 tiles, tiles with no alive cells are left out of the file entirely,
+ * and each remaining tile is PackBits compressed (or stored raw if that is smaller).
+ *
+ * @example
+ *
+ *      // Snapshot a mostly empty world, only the tiles holding cells take up space
+ *      BitGrid grid(100000, 100000);
+ *      grid.merge(BitGrid(Zoo::glider()), 50000, 50000);
+ *      Zoo::save_snapshot("path/to/world.gols", grid);
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The bit-packed grid to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_snapshot(std::string path, const BitGrid &grid) {
+	std::ofstream outputFile (path, std::ios::out | std::ios::binary);
+	if (!outputFile.is_open()) {
+		throw std::runtime_error("Failed to open output file.");
+	}
+
+	int tilesX = grid.get_words_per_row();
+	int tilesY = (grid.get_height() + SNAPSHOT_TILE - 1) / SNAPSHOT_TILE;
+
+	//first pass finds the non-empty tiles so the index can be written ahead of the payloads
+	std::vector<TileEntry> entries;
+	for (int ty = 0; ty < tilesY; ty++) {
+		int rows = std::min(SNAPSHOT_TILE, grid.get_height() - ty * SNAPSHOT_TILE);
+		for (int tx = 0; tx < tilesX; tx++) {
+			for (int r = 0; r < rows; r++) {
+				if (grid.row(ty * SNAPSHOT_TILE + r)[tx] != 0) {
+					entries.push_back({(uint32_t)tx, (uint32_t)ty, 0, 0});
+					break;
+				}
+			}
+		}
+	}
+
+	unsigned char headBytes[SNAPSHOT_HEADER_BYTES];
+	std::memcpy(headBytes, SNAPSHOT_MAGIC, 4);
+	put_le(headBytes + 4, SNAPSHOT_VERSION, 4);
+	put_le(headBytes + 8, (uint32_t)grid.get_width(), 4);
+	put_le(headBytes + 12, (uint32_t)grid.get_height(), 4);
+	put_le(headBytes + 16, SNAPSHOT_TILE, 4);
+	put_le(headBytes + 20, entries.size(), 4);
+	outputFile.write((char*)headBytes, sizeof(headBytes));
+
+	//the index is rewritten with real offsets once every payload has been placed
+	std::vector<unsigned char> indexBytes(entries.size() * SNAPSHOT_ENTRY_BYTES, 0);
+	outputFile.write((char*)indexBytes.data(), indexBytes.size());
+
+	uint64_t offset = SNAPSHOT_HEADER_BYTES + indexBytes.size();
+	unsigned char tileBytes[SNAPSHOT_TILE_BYTES];
+	//packbits never spends more than 2 bytes on an input byte
+	unsigned char payload[1 + 2 * SNAPSHOT_TILE_BYTES];
+	for (TileEntry &entry : entries) {
+		tile_to_bytes(grid, entry.tx, entry.ty, tileBytes);
+		size_t size = packbits_encode(tileBytes, SNAPSHOT_TILE_BYTES, payload + 1);
+		if (size < SNAPSHOT_TILE_BYTES) {
+			payload[0] = TILE_PACKBITS;
+		} else {
+			payload[0] = TILE_RAW;
+			std::memcpy(payload + 1, tileBytes, SNAPSHOT_TILE_BYTES);
+			size = SNAPSHOT_TILE_BYTES;
+		}
+		entry.offset = offset;
+		entry.size = (uint32_t)(size + 1);
+		outputFile.write((char*)payload, entry.size);
+		offset += entry.size;
+	}
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		unsigned char *bytes = indexBytes.data() + i * SNAPSHOT_ENTRY_BYTES;
+		put_le(bytes, entries[i].tx, 4);
+		put_le(bytes + 4, entries[i].ty, 4);
+		put_le(bytes + 8, entries[i].offset, 8);
+		put_le(bytes + 16, entries[i].size, 4);
+	}
+	outputFile.seekp(SNAPSHOT_HEADER_BYTES);
+	outputFile.write((char*)indexBytes.data(), indexBytes.size());
+	if (!outputFile) {
+		throw std::runtime_error("Failed to write snapshot file.");
+	}
+}
+
+/**
+ * Zoo::load_snapshot(path)
+ *
+ * Load a whole .gols snapshot into a bit-packed grid. Tiles missing from the file are dead.
+ *
+ * @example
+ *
+ *      // Load a snapshot and carry on simulating it
+ *      World world(Zoo::load_snapshot("path/to/world.gols").to_grid());
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed bit-packed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The file is not a snapshot or is a version this build does not understand.
+ *          - The file ends unexpectedly or a tile fails to decode.
+ */
+BitGrid Zoo::load_snapshot(std::string path) {
+	std::ifstream inputFile(path.c_str(), std::ios::in | std::ios::binary);
+	if (!inputFile) {
+		throw std::runtime_error("Failed to open snapshot file.");
+	}
+
+	int width, height;
+	std::vector<TileEntry> entries;
+	read_snapshot_index(inputFile, width, height, entries);
+
+	BitGrid loadGrid(width, height);
+	uint64_t rows[SNAPSHOT_TILE];
+	for (const TileEntry &entry : entries) {
+		read_snapshot_tile(inputFile, entry, rows);
+		int count = std::min(SNAPSHOT_TILE, height - (int)entry.ty * SNAPSHOT_TILE);
+		for (int r = 0; r < count; r++) {
+			loadGrid.row(entry.ty * SNAPSHOT_TILE + r)[entry.tx] = rows[r];
+		}
+	}
+
+	//keep the BitGrid invariant that the padding bits past the width are always 0
+	int spare = width % 64;
+	if (spare != 0) {
+		uint64_t mask = (((uint64_t)1) << spare) - 1;
+		for (int y = 0; y < height; y++) {
+			loadGrid.row(y)[loadGrid.get_words_per_row() - 1] &= mask;
+		}
+	}
+	return loadGrid;
+}
+
+/**
+ * Zoo::load_snapshot_region(path, x0, y0, width, height)
+ *
+ * Load a rectangular region of a .gols snapshot, only reading and decoding the tiles that overlap it.
+ * Parts of the region outside of the snapshot are dead.
+ *
+ * @example
+ *
+ *      // Pull a 256x256 window out of the middle of a huge snapshot
+ *      BitGrid window = Zoo::load_snapshot_region("path/to/world.gols", 50000, 50000, 256, 256);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param x0
+ *      The x coordinate in the snapshot of the left edge of the region.
+ *
+ * @param y0
+ *      The y coordinate in the snapshot of the top edge of the region.
+ *
+ * @param width
+ *      The width of the region.
+ *
+ * @param height
+ *      The height of the region.
+ *
+ * @return
+ *      Returns a width x height bit-packed grid holding the region.
+ *
+ * @throws
+ *      Throws std::invalid_argument or sub-class if the region has a negative origin or size.
+ *      Throws std::runtime_error or sub-class if the file cannot be read, as with Zoo::load_snapshot.
+ */
+BitGrid Zoo::load_snapshot_region(std::string path, int x0, int y0, int width, int height) {
+	if (x0 < 0 || y0 < 0 || width < 0 || height < 0) {
+		throw std::invalid_argument("Invalid snapshot region.\n");
+	}
+
+	std::ifstream inputFile(path.c_str(), std::ios::in | std::ios::binary);
+	if (!inputFile) {
+		throw std::runtime_error("Failed to open snapshot file.");
+	}
+
+	int fileWidth, fileHeight;
+	std::vector<TileEntry> entries;
+	read_snapshot_index(inputFile, fileWidth, fileHeight, entries);
+
+	BitGrid region(width, height);
+	int64_t x1 = std::min<int64_t>((int64_t)x0 + width, fileWidth);
+	int64_t y1 = std::min<int64_t>((int64_t)y0 + height, fileHeight);
+	if (x1 <= x0 || y1 <= y0) {
+		return region;
+	}
+
+	//the index is sorted by (ty, tx), so each overlapping tile row is one binary search away
+	uint64_t rows[SNAPSHOT_TILE];
+	for (int64_t ty = y0 / SNAPSHOT_TILE; ty * SNAPSHOT_TILE < y1; ty++) {
+		auto first = std::lower_bound(entries.begin(), entries.end(), std::make_pair((uint32_t)ty, (uint32_t)(x0 / SNAPSHOT_TILE)),
+			[](const TileEntry &entry, const std::pair<uint32_t, uint32_t> &key) {
+				return std::make_pair(entry.ty, entry.tx) < key;
+			});
+		for (auto it = first; it != entries.end() && it->ty == ty && (int64_t)it->tx * SNAPSHOT_TILE < x1; ++it) {
+			read_snapshot_tile(inputFile, *it, rows);
+			int64_t top = std::max<int64_t>(y0, ty * SNAPSHOT_TILE);
+			int64_t bottom = std::min<int64_t>(y1, (ty + 1) * SNAPSHOT_TILE);
+			int64_t left = std::max<int64_t>(x0, (int64_t)it->tx * SNAPSHOT_TILE);
+			int64_t right = std::min<int64_t>(x1, ((int64_t)it->tx + 1) * SNAPSHOT_TILE);
+			for (int64_t y = top; y < bottom; y++) {
+				uint64_t bits = rows[y - ty * SNAPSHOT_TILE];
+				if (bits == 0) {
+					continue;
+				}
+				for (int64_t x = left; x < right; x++) {
+					if ((bits >> (x - (int64_t)it->tx * SNAPSHOT_TILE)) & 1) {
+						region.set((int)(x - x0), (int)(y - y0), ALIVE);
+					}
+				}
+			}
+		}
+	}
+	return region;
+}
+
+
+//helper function parsing one "key = value" item of an rle header line, returning false if there are none left
+static bool rle_header_item(const char *&at, const char *end, std::string &key, std::string &value) {
+	auto skip_spaces = [&]() {
+		while (at < end && (*at == ' ' || *at == '\t' || *at == '\r')) {
+			at++;
+		}
+	};
+	skip_spaces();
+	if (at >= end) {
+		return false;
+	}
+	const char *keyStart = at;
+	while (at < end && *at != '=' && *at != ' ' && *at != '\t') {
+		at++;
+	}
+	key.assign(keyStart, at);
+	skip_spaces();
+	if (at >= end || *at != '=') {
+		throw std::runtime_error("invalid rle header line");
+	}
+	at++;
+	skip_spaces();
+	const char *valueStart = at;
+	while (at < end && *at != ',') {
+		at++;
+	}
+	const char *valueEnd = at;
+	while (valueEnd > valueStart && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t' || valueEnd[-1] == '\r')) {
+		valueEnd--;
+	}
+	value.assign(valueStart, valueEnd);
+	if (at < end) {
+		at++;
+	}
+	return true;
+}
+
+/**
+ * Stream an rle file, reporting its size to (header) and then every horizontal run of alive cells to (alive).
+ * Nothing the size of the pattern is ever allocated, so the caller decides where the cells go.
+ * The header's rule, Conway's if it names none, is stored in (rule) unless it is null.
+ */
+static void decode_rle(const std::string &path, const std::function<void(int, int)> &header,
+		const std::function<void(int, int, int)> &alive, Rule *rule) {
+	std::ifstream inputFile(path, std::ios::in | std::ios::binary);
+	if (!inputFile) {
+		throw std::runtime_error("Failed to open rle file.");
+	}
+	AsciiReader reader(inputFile);
+
+	//skip # comment lines, the first other line is the header
+	const char *line;
+	while ((line = reader.line()) != nullptr && line[0] == '#') {
+		reader.consume((const char*)std::memchr(line, '\n', reader.available()) - line + 1);
+	}
+	if (line == nullptr) {
+		throw std::runtime_error("missing rle header line");
+	}
+	const char *lineEnd = (const char*)std::memchr(line, '\n', reader.available());
+
+	int width = -1, height = -1;
+	Rule parsedRule = ConwayRule();
+	std::string key, value;
+	const char *at = line;
+	while (rle_header_item(at, lineEnd, key, value)) {
+		if (key == "x" || key == "y") {
+			int parsed;
+			auto result = std::from_chars(value.data(), value.data() + value.size(), parsed);
+			if (result.ec != std::errc() || result.ptr != value.data() + value.size() || parsed < 0) {
+				throw std::runtime_error("invalid width or height");
+			}
+			(key == "x" ? width : height) = parsed;
+		} else if (key == "rule") {
+			//Golly appends the topology as :T or :P, the grid's edges are chosen when stepping instead
+			try {
+				parsedRule = Rule::parse(value.substr(0, value.find(':')));
+			}
+			catch (const std::invalid_argument &) {
+				throw std::runtime_error("unsupported rle rule " + value);
+			}
+		}
+	}
+	if (width < 0 || height < 0) {
+		throw std::runtime_error("rle header is missing x or y");
+	}
+	if (rule != nullptr) {
+		*rule = parsedRule;
+	}
+	reader.consume(lineEnd - line + 1);
+	header(width, height);
+
+	//the pattern body, <count><tag> items where b is dead, o (or any other letter) is alive, $ ends a row
+	int x = 0, y = 0;
+	long long count = 0;
+	const char *bytes;
+	size_t size;
+	while ((size = reader.block(bytes)) != 0) {
+		for (size_t i = 0; i < size; i++) {
+			char c = bytes[i];
+			if (c >= '0' && c <= '9') {
+				count = count * 10 + (c - '0');
+				if (count > std::numeric_limits<int>::max()) {
+					throw std::runtime_error("rle run length too long");
+				}
+				continue;
+			}
+			if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+				continue;
+			}
+			int run = (count == 0) ? 1 : (int)count;
+			count = 0;
+			if (c == '!') {
+				return;
+			} else if (c == '$') {
+				y += run;
+				x = 0;
+			} else if (c == 'b' || c == '.') {
+				x = (int)std::min<long long>((long long)x + run, std::numeric_limits<int>::max());
+			} else if (std::isalpha((unsigned char)c)) {
+				if ((long long)x + run > width || y >= height) {
+					throw std::runtime_error("rle pattern does not fit its header size");
+				}
+				alive(x, y, run);
+				x += run;
+			} else {
+				throw std::runtime_error("invalid rle character");
+			}
+		}
+		reader.consume(size);
+	}
+	//no terminating ! is tolerated, many hand written files leave it off
+}
+
+/**
+ * Zoo::load_rle(path)
+ *
+ * Load a run length encoded (.rle) pattern, the format used by Golly and the LifeWiki pattern collection.
+ * http://www.conwaylife.com/wiki/Run_Length_Encoded
+ *
+ * Comment lines starting with # are skipped, the header line gives the size of the grid as "x = width, y = height"
+ * and optionally the rule, e.g. "rule = B36/S23", then the body is read straight into the grid run by run.
+ *
+ * @example
+ *
+ *      // Load a pattern from the LifeWiki
+ *      Grid grid = Zoo::load_rle("path/to/gosperglidergun.rle");
+ *
+ *      // Load a pattern and step it under the rule it was saved with
+ *      Rule rule;
+ *      World world(Zoo::load_rle("path/to/replicator.rle", &rule));
+ *      world.set_rule(rule);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param rule
+ *      Optional parameter. If not null, set to the rule named by the header, or Conway's if it names none.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The header line is missing or malformed, or names a rule that is not in B/S or S/B notation.
+ *          - An alive cell lies outside of the size given in the header.
+ *          - The body holds a character that is not part of the format.
+ */
+Grid Zoo::load_rle(std::string path, Rule *rule) {
+	Grid grid;
+	decode_rle(path,
+		[&](int width, int height) { grid = Grid(width, height); },
+		[&](int x, int y, int run) { std::fill(grid.row(y) + x, grid.row(y) + x + run, ALIVE); }, rule);
+	return grid;
+}
+
+/**
+ * Zoo::load_rle_packed(path)
+ *
+ * Load a run length encoded (.rle) pattern straight into a bit-packed grid. See Zoo::load_rle.
+ *
+ * @example
+ *
+ *      // Load a large pattern for the packed backend
+ *      BitGrid grid = Zoo::load_rle_packed("path/to/pattern.rle");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param rule
+ *      Optional parameter. If not null, set to the rule named by the header, or Conway's if it names none.
+ *
+ * @return
+ *      Returns the parsed bit-packed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class as with Zoo::load_rle.
+ */
+BitGrid Zoo::load_rle_packed(std::string path, Rule *rule) {
+	BitGrid grid;
+	decode_rle(path,
+		[&](int width, int height) { grid = BitGrid(width, height); },
+		[&](int x, int y, int run) {
+			uint64_t *row = grid.row(y);
+			//set whole words at a time across the run
+			while (run > 0) {
+				int offset = x % 64;
+				int bits = std::min(run, 64 - offset);
+				uint64_t mask = (bits == 64) ? ~(uint64_t)0 : (((((uint64_t)1) << bits) - 1) << offset);
+				row[x / 64] |= mask;
+				x += bits;
+				run -= bits;
+			}
+		}, rule);
+	return grid;
+}
+
+/**
+ * Zoo::load_rle_sparse(path, x0, y0)
+ *
+ * Load a run length encoded (.rle) pattern into an unbounded sparse world, placing its top left corner at (x0, y0).
+ * Only the alive cells are stored, so huge but sparse patterns cost memory in proportion to their population.
+ * See Zoo::load_rle.
+ *
+ * @example
+ *
+ *      // Load a breeder and let it grow without edges
+ *      InfiniteWorld world = Zoo::load_rle_sparse("path/to/breeder.rle");
+ *      world.advance(10000);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param x0
+ *      The x coordinate to place the left edge of the pattern at. Defaults to 0.
+ *
+ * @param y0
+ *      The y coordinate to place the top edge of the pattern at. Defaults to 0.
+ *
+ * @param rule
+ *      Optional parameter. If not null, set to the rule named by the header, or Conway's if it names none.
+ *
+ * @return
+ *      Returns a sparse world holding the pattern.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class as with Zoo::load_rle.
+ */
+InfiniteWorld Zoo::load_rle_sparse(std::string path, int64_t x0, int64_t y0, Rule *rule) {
+	InfiniteWorld world;
+	decode_rle(path,
+		[](int, int) {},
+		[&](int x, int y, int run) {
+			for (int i = 0; i < run; i++) {
+				world.set(x0 + x + i, y0 + y, ALIVE);
+			}
+		}, rule);
+	return world;
+}
+
+/**
+ * Buffers the tokens of an rle body and wraps lines at 70 characters, as the format recommends.
+ */
+class RleWriter {
+public:
+	explicit RleWriter(std::ostream &output) : output(output), lineLength(0), pendingRows(0) {}
+
+	//a run of (run) cells of the given tag on the current row
+	void cells(int run, char tag) {
+		flush_rows();
+		token(run, tag);
+	}
+
+	//finish the current row, consecutive row ends are merged into one token
+	void end_row() {
+		pendingRows++;
+	}
+
+	//finish the pattern, trailing empty rows are dropped
+	void end() {
+		token(1, '!');
+		buffer += '\n';
+		output.write(buffer.data(), buffer.size());
+	}
+
+private:
+	static const size_t LINE_LENGTH = 70;
+	static const size_t FLUSH_BYTES = 1 << 16;
+
+	std::ostream &output;
+	std::string buffer;
+	size_t lineLength;
+	int pendingRows;
+
+	void flush_rows() {
+		if (pendingRows > 0) {
+			token(pendingRows, '$');
+			pendingRows = 0;
+		}
+	}
+
+	void token(int run, char tag) {
+		char text[16];
+		size_t length = 0;
+		if (run > 1) {
+			length = std::to_chars(text, text + sizeof(text), run).ptr - text;
+		}
+		text[length++] = tag;
+		if (lineLength + length > LINE_LENGTH) {
+			buffer += '\n';
+			lineLength = 0;
+		}
+		buffer.append(text, length);
+		lineLength += length;
+		if (buffer.size() >= FLUSH_BYTES) {
+			output.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+	}
+};
+
+//helper function writing an rle file from a grid with get(x, y), labelled with the rule it is stepped under
+template<typename GridType>
+static void encode_rle(const std::string &path, const GridType &grid, const Rule &rule) {
+	std::ofstream outputFile(path, std::ios::out | std::ios::binary);
+	if (!outputFile.is_open()) {
+		throw std::runtime_error("Failed to open output file.");
+	}
+
+	outputFile << "x = " << grid.get_width() << ", y = " << grid.get_height() << ", rule = " << rule.to_string() << "\n";
+	RleWriter writer(outputFile);
+	for (int y = 0; y < grid.get_height(); y++) {
+		int x = 0;
+		while (x < grid.get_width()) {
+			Cell value = grid.get(x, y);
+			int start = x;
+			while (x < grid.get_width() && grid.get(x, y) == value) {
+				x++;
+			}
+			//trailing dead cells are implied by the end of the row
+			if (value == ALIVE) {
+				writer.cells(x - start, 'o');
+			} else if (x < grid.get_width()) {
+				writer.cells(x - start, 'b');
+			}
+		}
+		writer.end_row();
+	}
+	writer.end();
+
+	if (!outputFile) {
+		throw std::runtime_error("Failed to write rle file.");
+	}
+}
+
+/**
+ * Zoo::save_rle(path, grid)
+ *
+ * Save a grid as a run length encoded (.rle) pattern, readable by Golly and Zoo::load_rle.
+ *
+ * @example
+ *
+ *      // Save a glider as an rle file
+ *      Zoo::save_rle("path/to/glider.rle", Zoo::glider());
+ *
+ *      x = 3, y = 3, rule = B3/S23
+ *      bo$2bo$3o!
+ *
+ *      // Save a HighLife pattern, labelled so Golly steps it under HighLife
+ *      Zoo::save_rle("path/to/replicator.rle", world.get_state(), world.get_rule());
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule the pattern is stepped under, written to the header. Defaults to Conway's.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_rle(std::string path, const Grid &grid, const Rule &rule) {
+	encode_rle(path, grid, rule);
+}
+
+/**
+ * Zoo::save_rle(path, grid)
+ *
+ * Save a bit-packed grid as a run length encoded (.rle) pattern. See Zoo::save_rle.
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The bit-packed grid to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule the pattern is stepped under, written to the header. Defaults to Conway's.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_rle(std::string path, const BitGrid &grid, const Rule &rule) {
+	encode_rle(path, grid, rule);
+}
+
+/**
+ * Zoo::save_rle(path, grid)
+ *
+ * Save a view of a grid as a run length encoded (.rle) pattern. See Zoo::save_rle.
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The view to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule the pattern is stepped under, written to the header. Defaults to Conway's.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save_rle(std::string path, const GridView &grid, const Rule &rule) {
+	encode_rle(path, grid, rule);
+}
+
+
+//helper function testing whether a path ends with an extension
+static bool has_extension(const std::string &path, const std::string &extension) {
+	return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+/**
+ * Zoo::load(path)
+ *
+ * Load a grid from any of the supported formats, chosen by the extension of the path:
+ * .rle (run length encoded), .bgol (binary), .gols (snapshot) and anything else as ascii .gol.
+ *
+ * @example
+ *
+ *      // Load whatever the user pointed us at
+ *      Grid grid = Zoo::load(path);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param rule
+ *      Optional parameter. If not null and the file is .rle, set to the rule named by its header.
+ *      Left as it is for the formats that hold no rule.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class as the loader for the format does.
+ */
+Grid Zoo::load(std::string path, Rule *rule) {
+	Stats::Timer timer(Stats::LOAD);
+	if (has_extension(path, ".rle")) {
+		return Zoo::load_rle(path, rule);
+	} else if (has_extension(path, ".bgol")) {
+		return Zoo::load_binary(path);
+	} else if (has_extension(path, ".gols")) {
+		return Zoo::load_snapshot(path).to_grid();
+	}
+	return Zoo::load_ascii(path);
+}
+
+/**
+ * Zoo::save(path, grid)
+ *
+ * Save a grid in the format chosen by the extension of the path, as with Zoo::load.
+ *
+ * @example
+ *
+ *      // Save in a compact format for a large world
+ *      Zoo::save("path/to/world.gols", world.get_state());
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule the grid is stepped under, kept by the formats that hold one (.rle). Defaults to Conway's.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save(std::string path, const Grid &grid, const Rule &rule) {
+	Zoo::save(path, GridView(grid), rule);
+}
+
+/**
+ * Zoo::save(path, grid)
+ *
+ * Save a view of a grid in the format chosen by the extension of the path, as with saving a grid.
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The view to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule the grid is stepped under, kept by the formats that hold one (.rle). Defaults to Conway's.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ */
+void Zoo::save(std::string path, const GridView &grid, const Rule &rule) {
+	Stats::Timer timer(Stats::SAVE);
+	if (has_extension(path, ".rle")) {
+		Zoo::save_rle(path, grid, rule);
+	} else if (has_extension(path, ".bgol")) {
+		Zoo::save_binary(path, BitGrid(grid));
+	} else if (has_extension(path, ".gols")) {
+		Zoo::save_snapshot(path, BitGrid(grid));
+	} else {
+		Zoo::save_ascii(path, grid);
+	}
+}
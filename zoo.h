@@ -15,6 +15,11 @@
 #include <fstream>
 
 #include "grid.h"
+#include "grid_view.h"
+#include "bitgrid.h"
+#include "execution_policy.h"
+#include "infinite_world.h"
+#include "rule.h"
 /**
  * Declare the interface of the Zoo namespace for constructing lifeforms and saving and loading them from file.
  */
@@ -25,10 +30,36 @@ namespace Zoo {
 	Grid r_pentomino();
 
 	Grid load_ascii(std::string path);
-	void save_ascii(std::string path,Grid grid);
+	void save_ascii(std::string path, const Grid &grid);
+	void save_ascii(std::string path, const GridView &grid);
 
 	Grid load_binary(std::string path);
-	void save_binary(std::string path,Grid grid) ;
+	Grid load_binary(std::string path, const ExecutionPolicy &policy);
+	void save_binary(std::string path, const Grid &grid);
+	void save_binary(std::string path, const Grid &grid, const ExecutionPolicy &policy);
+	void save_binary(std::string path, const GridView &grid);
+	void save_binary(std::string path, const GridView &grid, const ExecutionPolicy &policy);
+
+	BitGrid load_binary_packed(std::string path);
+	void save_binary(std::string path, const BitGrid &grid);
+
+	BitGrid load_binary_mapped(std::string path);
+	void save_binary_mapped(std::string path, const BitGrid &grid);
+
+	void save_snapshot(std::string path, const BitGrid &grid);
+	BitGrid load_snapshot(std::string path);
+	BitGrid load_snapshot_region(std::string path, int x0, int y0, int width, int height);
+
+	Grid load_rle(std::string path, Rule *rule = nullptr);
+	BitGrid load_rle_packed(std::string path, Rule *rule = nullptr);
+	InfiniteWorld load_rle_sparse(std::string path, int64_t x0 = 0, int64_t y0 = 0, Rule *rule = nullptr);
+	void save_rle(std::string path, const Grid &grid, const Rule &rule = ConwayRule());
+	void save_rle(std::string path, const BitGrid &grid, const Rule &rule = ConwayRule());
+	void save_rle(std::string path, const GridView &grid, const Rule &rule = ConwayRule());
+
+	Grid load(std::string path, Rule *rule = nullptr);
+	void save(std::string path, const Grid &grid, const Rule &rule = ConwayRule());
+	void save(std::string path, const GridView &grid, const Rule &rule = ConwayRule());
 
 
 };